@@ -0,0 +1,1343 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "btree.h"
+#include "buffer.h"
+#include "checkpointer.h"
+#include "compressed_tier.h"
+#include "crc32c.h"
+#include "file.h"
+#include "file_iterator.h"
+#include "file_tier.h"
+#include "hash_index.h"
+#include "heap_file.h"
+#include "log_manager.h"
+#include "page.h"
+#include "page_iterator.h"
+#include "parallel_scan.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Seconds elapsed since <start>.
+ */
+double secondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Removes <filename> if a previous run left it behind.
+ */
+void removeIfExists(const std::string& filename)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+}
+
+/**
+ * Creates <filename> holding pages 1..numPages, each with one small record.
+ */
+File createBenchFile(const std::string& filename, const std::uint32_t numPages)
+{
+	removeIfExists(filename);
+	File file = File::create(filename);
+	for (std::uint32_t i = 0; i < numPages; i++)
+	{
+		Page page = file.allocatePage();
+		page.insertRecord("bench record");
+		file.writePage(page);
+	}
+	return file;
+}
+
+/**
+ * Returns argv[index] as a number, or <fallback> if it was not given.
+ */
+std::uint32_t argOr(int argc, char* argv[], int index, std::uint32_t fallback)
+{
+	return index < argc ? (std::uint32_t) std::strtoul(argv[index], NULL, 10) : fallback;
+}
+
+/**
+ * Random buffer hits against a fully resident pool, touching a random byte of
+ * each frame so that every access needs a TLB entry for its frame.
+ */
+double randomHitRate(BufMgr& bufMgr, File& file, std::uint32_t numPages, std::uint32_t ops)
+{
+	Page* page;
+	for (PageId p = 1; p <= numPages; p++)
+	{
+		bufMgr.readPage(&file, p, page);
+		bufMgr.unPinPage(&file, p, false);
+	}
+
+	unsigned int seed = 42;
+	volatile std::uint32_t sink = 0;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t op = 0; op < ops; op++)
+	{
+		const PageId p = 1 + rand_r(&seed) % numPages;
+		bufMgr.readPage(&file, p, page);
+		sink += reinterpret_cast<const unsigned char*>(page)[rand_r(&seed) % Page::SIZE];
+		bufMgr.unPinPage(&file, p, false);
+	}
+	return ops / secondsSince(start);
+}
+
+const char* backingName(HugePageBacking backing)
+{
+	switch (backing)
+	{
+		case HUGE_PAGES_HUGETLB: return "MAP_HUGETLB";
+		case HUGE_PAGES_TRANSPARENT: return "MADV_HUGEPAGE";
+		default: return "4KB pages";
+	}
+}
+
+/**
+ * hugepages [pages] [ops]: random-hit throughput with and without a huge page
+ * backed frame arena.
+ */
+int benchHugePages(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 2048);
+	const std::uint32_t ops = argOr(argc, argv, 3, 4000000);
+	{
+		File file = createBenchFile("bench.hugepages", numPages);
+		for (int huge = 0; huge <= 1; huge++)
+		{
+			BufMgrOptions options;
+			options.hugePages = (huge == 1);
+			BufMgr bufMgr(numPages, options);
+			const double rate = randomHitRate(bufMgr, file, numPages, ops);
+			std::cout << "frames=" << numPages << " backing=" << backingName(bufMgr.hugePageBacking())
+				<< " random hits/s=" << (long) rate << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.hugepages");
+	return 0;
+}
+
+/**
+ * numa [threadsPerNode] [pagesPerThread] [ops]: threads pinned to every node
+ * hit their own pages, once in a plain pool and once in a NUMA-aware pool
+ * with first-touch placement so that each thread's pages live on its node.
+ */
+int benchNuma(int argc, char* argv[])
+{
+	const std::uint32_t threadsPerNode = argOr(argc, argv, 2, 2);
+	const std::uint32_t pagesPerThread = argOr(argc, argv, 3, 256);
+	const std::uint32_t ops = argOr(argc, argv, 4, 1000000);
+	const NumaTopology topology = NumaTopology::detect();
+	const std::uint32_t numThreads = topology.numNodes() * threadsPerNode;
+	const std::uint32_t numPages = numThreads * pagesPerThread;
+	std::cout << "nodes=" << topology.numNodes() << " threads=" << numThreads << std::endl;
+	{
+		File file = createBenchFile("bench.numa", numPages);
+		for (int aware = 0; aware <= 1; aware++)
+		{
+			BufMgrOptions options;
+			options.numaAware = (aware == 1);
+			options.numaPlacement = PLACE_BY_FIRST_TOUCH;
+			BufMgr bufMgr(numPages, options);
+
+			std::vector<std::thread> threads;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t t = 0; t < numThreads; t++)
+			{
+				threads.push_back(std::thread([&, t]() {
+					topology.bindThread(t % topology.numNodes());
+					const PageId first = 1 + t * pagesPerThread;
+					Page* page;
+					for (PageId p = first; p < first + pagesPerThread; p++)
+					{
+						bufMgr.readPage(&file, p, page);
+						bufMgr.unPinPage(&file, p, false);
+					}
+					unsigned int seed = t;
+					volatile std::uint32_t sink = 0;
+					for (std::uint32_t op = 0; op < ops; op++)
+					{
+						const PageId p = first + rand_r(&seed) % pagesPerThread;
+						bufMgr.readPage(&file, p, page);
+						sink += reinterpret_cast<const unsigned char*>(page)[rand_r(&seed) % Page::SIZE];
+						bufMgr.unPinPage(&file, p, false);
+					}
+				}));
+			}
+			for (std::size_t t = 0; t < threads.size(); t++)
+				threads[t].join();
+			const double seconds = secondsSince(start);
+			std::cout << "numaAware=" << aware << " partitions=" << bufMgr.getNumPartitions()
+				<< " hits/s=" << (long) (numThreads * (double) ops / seconds) << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.numa");
+	return 0;
+}
+
+/**
+ * batch [pages] [rounds]: pinning and unpinning every page of a file one call
+ * at a time against readPages/unPinPages, cold (pool just created) and hot.
+ */
+int benchBatch(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 1024);
+	const std::uint32_t rounds = argOr(argc, argv, 3, 200);
+	{
+		File file = createBenchFile("bench.batch", numPages);
+		std::vector<PageId> pageNos;
+		for (PageId p = 1; p <= numPages; p++)
+			pageNos.push_back(p);
+
+		for (int batched = 0; batched <= 1; batched++)
+		{
+			BufMgr bufMgr(numPages);
+			std::vector<Page*> pages;
+			double seconds[2] = {0, 0};
+			for (std::uint32_t r = 0; r <= rounds; r++)
+			{
+				Clock::time_point start = Clock::now();
+				if (batched)
+				{
+					bufMgr.readPages(&file, pageNos, pages);
+					bufMgr.unPinPages(&file, pageNos, false);
+				}
+				else
+				{
+					Page* page;
+					for (std::size_t p = 0; p < pageNos.size(); p++)
+					{
+						bufMgr.readPage(&file, pageNos[p], page);
+						bufMgr.unPinPage(&file, pageNos[p], false);
+					}
+				}
+				seconds[r == 0 ? 0 : 1] += secondsSince(start);
+			}
+			std::cout << (batched ? "readPages " : "readPage  ")
+				<< "cold pages/s=" << (long) (numPages / seconds[0])
+				<< " hot pages/s=" << (long) ((double) numPages * rounds / seconds[1]) << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.batch");
+	return 0;
+}
+
+/**
+ * optimistic [threads] [hotPages] [ops]: threads reading a few hot pages
+ * through pinned reads against optimistic reads.
+ */
+int benchOptimistic(int argc, char* argv[])
+{
+	const std::uint32_t numThreads = argOr(argc, argv, 2, 4);
+	const std::uint32_t hotPages = argOr(argc, argv, 3, 4);
+	const std::uint32_t ops = argOr(argc, argv, 4, 1000000);
+	{
+		File file = createBenchFile("bench.optimistic", hotPages);
+		for (int optimistic = 0; optimistic <= 1; optimistic++)
+		{
+			BufMgr bufMgr(hotPages);
+			std::vector<std::thread> threads;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t t = 0; t < numThreads; t++)
+			{
+				threads.push_back(std::thread([&, t]() {
+					unsigned int seed = t;
+					volatile std::uint32_t sink = 0;
+					for (std::uint32_t op = 0; op < ops; op++)
+					{
+						const PageId p = 1 + rand_r(&seed) % hotPages;
+						if (optimistic)
+						{
+							bufMgr.readOptimistic(&file, p, [&sink](const Page& page) {
+								sink += page.getFreeSpace();
+							});
+						}
+						else
+						{
+							Page* page;
+							bufMgr.readPage(&file, p, page);
+							sink += page->getFreeSpace();
+							bufMgr.unPinPage(&file, p, false);
+						}
+					}
+				}));
+			}
+			for (std::size_t t = 0; t < threads.size(); t++)
+				threads[t].join();
+			std::cout << (optimistic ? "optimistic" : "pinned    ") << " reads/s="
+				<< (long) (numThreads * (double) ops / secondsSince(start)) << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.optimistic");
+	return 0;
+}
+
+/**
+ * swizzle [pages] [rounds]: walking a resident file page by page through
+ * (file, page) lookups against walking it through swizzled PageRefs.
+ */
+int benchSwizzle(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 2048);
+	const std::uint32_t rounds = argOr(argc, argv, 3, 2000);
+	{
+		File file = createBenchFile("bench.swizzle", numPages);
+		BufMgr bufMgr(numPages);
+		std::vector<PageRef> refs;
+		for (PageId p = 1; p <= numPages; p++)
+			refs.push_back(PageRef(&file, p));
+
+		for (int swizzled = 0; swizzled <= 1; swizzled++)
+		{
+			volatile std::uint32_t sink = 0;
+			Page* page;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t r = 0; r < rounds; r++)
+			{
+				for (std::size_t p = 0; p < refs.size(); p++)
+				{
+					if (swizzled)
+					{
+						bufMgr.readPage(refs[p], page);
+						sink += page->getFreeSpace();
+						bufMgr.unPinPage(refs[p], false);
+					}
+					else
+					{
+						bufMgr.readPage(&file, refs[p].getPageNo(), page);
+						sink += page->getFreeSpace();
+						bufMgr.unPinPage(&file, refs[p].getPageNo(), false);
+					}
+				}
+			}
+			std::cout << (swizzled ? "swizzled " : "hash     ") << " pages/s="
+				<< (long) ((double) numPages * rounds / secondsSince(start)) << std::endl;
+		}
+		bufMgr.flushFile(&file);
+	}
+	File::remove("bench.swizzle");
+	return 0;
+}
+
+/**
+ * guard [pages] [ops]: random hits through readPage/unPinPage pairs against
+ * hits through ReadPageGuard.
+ */
+int benchGuard(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 1024);
+	const std::uint32_t ops = argOr(argc, argv, 3, 4000000);
+	{
+		File file = createBenchFile("bench.guard", numPages);
+		BufMgr bufMgr(numPages);
+		for (int guarded = 0; guarded <= 1; guarded++)
+		{
+			unsigned int seed = 42;
+			volatile std::uint32_t sink = 0;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t op = 0; op < ops; op++)
+			{
+				const PageId p = 1 + rand_r(&seed) % numPages;
+				if (guarded)
+				{
+					ReadPageGuard page = bufMgr.readPageGuard(&file, p);
+					sink += page->getFreeSpace();
+				}
+				else
+				{
+					Page* page;
+					bufMgr.readPage(&file, p, page);
+					sink += page->getFreeSpace();
+					bufMgr.unPinPage(&file, p, false);
+				}
+			}
+			std::cout << (guarded ? "guard          " : "readPage/unPin ") << " hits/s="
+				<< (long) (ops / secondsSince(start)) << std::endl;
+		}
+		bufMgr.flushFile(&file);
+	}
+	File::remove("bench.guard");
+	return 0;
+}
+
+/**
+ * warmup [pages] [target%]: after a restart, time until a window of random
+ * hits on the working set of the previous run reaches the target hit ratio,
+ * starting cold and starting with warmUp() from a dumped resident set.
+ */
+int benchWarmUp(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 2048);
+	const std::uint32_t target = argOr(argc, argv, 3, 95);
+	const std::uint32_t frames = numPages / 2;
+	const std::uint32_t window = 1000;
+	{
+		File file = createBenchFile("bench.warmup", numPages);
+		{
+			//the previous run: its working set is the upper half of the file
+			BufMgr bufMgr(frames);
+			Page* page;
+			for (PageId p = numPages - frames + 1; p <= numPages; p++)
+			{
+				bufMgr.readPage(&file, p, page);
+				bufMgr.unPinPage(&file, p, false);
+			}
+			bufMgr.dumpResidentSet("bench.resident");
+			bufMgr.flushFile(&file);
+		}
+
+		for (int warm = 0; warm <= 1; warm++)
+		{
+			BufMgr bufMgr(frames);
+			unsigned int seed = 42;
+			Page* page;
+			std::uint32_t ops = 0;
+			Clock::time_point start = Clock::now();
+			if (warm)
+			{
+				std::vector<File*> files(1, &file);
+				bufMgr.warmUp("bench.resident", files);
+			}
+			double hitRatio = 0;
+			while (hitRatio * 100 < target)
+			{
+				bufMgr.clearBufStats();
+				for (std::uint32_t op = 0; op < window; op++)
+				{
+					const PageId p = numPages - frames + 1 + rand_r(&seed) % frames;
+					bufMgr.readPage(&file, p, page);
+					bufMgr.unPinPage(&file, p, false);
+				}
+				ops += window;
+				hitRatio = 1.0 - (double) bufMgr.getBufStats().diskreads / window;
+			}
+			std::cout << (warm ? "warmUp" : "cold  ") << " ms to " << target << "% hits="
+				<< secondsSince(start) * 1000 << " ops=" << ops << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.warmup");
+	std::remove("bench.resident");
+	return 0;
+}
+
+/**
+ * Dirties the first <numPages> pages of <file> in <bufMgr>.
+ */
+void dirtyPages(BufMgr& bufMgr, File& file, std::uint32_t numPages)
+{
+	Page* page;
+	for (PageId p = 1; p <= numPages; p++)
+	{
+		bufMgr.readPage(&file, p, page);
+		page->insertRecord("dirty");
+		bufMgr.unPinPage(&file, p, true);
+	}
+}
+
+/**
+ * asyncflush [pages]: how long flushFile stalls its caller against how long
+ * flushFileAsync does, and how many page hits other work gets in meanwhile.
+ */
+int benchAsyncFlush(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 8192);
+	{
+		File file = createBenchFile("bench.asyncflush", numPages);
+		BufMgr bufMgr(numPages);
+
+		dirtyPages(bufMgr, file, numPages);
+		Clock::time_point start = Clock::now();
+		bufMgr.flushFile(&file);
+		std::cout << "flushFile       caller ms=" << secondsSince(start) * 1000 << std::endl;
+
+		dirtyPages(bufMgr, file, numPages);
+		start = Clock::now();
+		FlushHandle flush = bufMgr.flushFileAsync(&file);
+		const double returned = secondsSince(start);
+		unsigned int seed = 42;
+		std::uint32_t hits = 0;
+		Page* page;
+		while (!flush.done())
+		{
+			const PageId p = 1 + rand_r(&seed) % numPages;
+			bufMgr.readPage(&file, p, page);
+			bufMgr.unPinPage(&file, p, false);
+			hits++;
+		}
+		flush.wait();
+		std::cout << "flushFileAsync  caller ms=" << returned * 1000 << " done ms="
+			<< secondsSince(start) * 1000 << " MB=" << flush.bytesWritten() / (1024 * 1024)
+			<< " hits meanwhile=" << hits << std::endl;
+		bufMgr.flushFile(&file);
+	}
+	File::remove("bench.asyncflush");
+	return 0;
+}
+
+/**
+ * wal [commits] [threads]: durable single-record commits per second, forcing
+ * each changed page in place against logging the change and committing
+ * through the write-ahead log, where concurrent commits share a sync.
+ */
+int benchWal(int argc, char* argv[])
+{
+	const std::uint32_t commits = argOr(argc, argv, 2, 2000);
+	const std::uint32_t threads = argOr(argc, argv, 3, 4);
+	const std::uint32_t numPages = 256;
+	{
+		File file = createBenchFile("bench.wal", numPages);
+		const int fd = ::open("bench.wal", O_RDWR);
+		{
+			BufMgr bufMgr(numPages);
+			Page* page;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t c = 0; c < commits; c++)
+			{
+				const PageId p = 1 + c % numPages;
+				char value[16];
+				std::snprintf(value, sizeof(value), "commit %05u", c % 100000);
+				bufMgr.readPage(&file, p, page);
+				page->updateRecord(RecordId{p, 1}, value);
+				file.writePage(*page);
+				fdatasync(fd);
+				bufMgr.unPinPage(&file, p, false);
+			}
+			std::cout << "in place        commits/s=" << commits / secondsSince(start)
+				<< " bytes/commit=" << Page::SIZE << std::endl;
+		}
+		::close(fd);
+
+		for (std::uint32_t t = 1; t <= threads; t = t == threads ? t + 1 : std::min(threads, t * 2))
+		{
+			std::remove("bench.wal.log");
+			LogManager log("bench.wal.log");
+			BufMgrOptions options;
+			options.log = &log;
+			BufMgr bufMgr(numPages, options);
+			std::vector<std::thread> workers;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t w = 0; w < t; w++)
+			{
+				workers.push_back(std::thread([&, w]() {
+					Page* page;
+					for (std::uint32_t c = w; c < commits; c += t)
+					{
+						const PageId p = 1 + c % numPages;
+						char value[16];
+						std::snprintf(value, sizeof(value), "commit %05u", c % 100000);
+						bufMgr.readPage(&file, p, page);
+						const Page before = *page;
+						page->updateRecord(RecordId{p, 1}, value);
+						log.logPageDiff(file, before, *page);
+						bufMgr.unPinPage(&file, p, true);
+						log.commit();
+					}
+				}));
+			}
+			for (std::size_t w = 0; w < workers.size(); w++)
+				workers[w].join();
+			const double seconds = secondsSince(start);
+			const LogStats stats = log.stats();
+			std::cout << "wal threads=" << t << "   commits/s=" << commits / seconds
+				<< " bytes/commit=" << stats.bytes / commits
+				<< " commits/sync=" << (double) stats.commits / stats.flushes << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.wal");
+	std::remove("bench.wal.log");
+	return 0;
+}
+
+/**
+ * checkpoint [seconds] [MB/s]: foreground update latency and recovery work
+ * with no checkpoints, with flushFile every second in the foreground, and
+ * with a rate-limited background Checkpointer.
+ */
+int benchCheckpoint(int argc, char* argv[])
+{
+	const std::uint32_t seconds = argOr(argc, argv, 2, 2);
+	const std::uint32_t megabytes = argOr(argc, argv, 3, 16);
+	const std::uint32_t numPages = 2048;
+	const char* modes[] = {"none", "flushFile", "checkpointer"};
+	{
+		File file = createBenchFile("bench.ckpt", numPages);
+		for (int mode = 0; mode < 3; mode++)
+		{
+			std::remove("bench.ckpt.log");
+			std::vector<double> latencies;
+			{
+				LogManager log("bench.ckpt.log");
+				BufMgrOptions options;
+				options.log = &log;
+				BufMgr bufMgr(numPages, options);
+				CheckpointOptions checkpointOptions;
+				checkpointOptions.bytesPerSecond = (std::uint64_t) megabytes * 1024 * 1024;
+				Checkpointer* checkpointer = mode == 2 ? new Checkpointer(bufMgr, checkpointOptions) : NULL;
+
+				unsigned int seed = 42;
+				Page* page;
+				Clock::time_point start = Clock::now();
+				Clock::time_point lastFlush = start;
+				for (std::uint32_t op = 0; secondsSince(start) < seconds; op++)
+				{
+					Clock::time_point opStart = Clock::now();
+					if (mode == 1 && std::chrono::duration<double>(opStart - lastFlush).count() >= 1.0)
+					{
+						bufMgr.flushFile(&file);
+						lastFlush = opStart;
+					}
+					const PageId p = 1 + rand_r(&seed) % numPages;
+					char value[16];
+					std::snprintf(value, sizeof(value), "commit %05u", op % 100000);
+					bufMgr.readPage(&file, p, page);
+					const Page before = *page;
+					page->updateRecord(RecordId{p, 1}, value);
+					log.logPageDiff(file, before, *page);
+					bufMgr.unPinPage(&file, p, true);
+					log.commit();
+					latencies.push_back(secondsSince(opStart) * 1e6);
+				}
+				if (checkpointer != NULL)
+				{
+					checkpointer->stop();
+					delete checkpointer;
+				}
+				//crash: whatever is dirty now is lost
+				bufMgr.dropFile(&file);
+			}
+			LogManager log("bench.ckpt.log");
+			std::vector<File*> files(1, &file);
+			const Lsn end = log.endLsn();
+			Clock::time_point start = Clock::now();
+			const RedoStats redo = log.recover(files);
+			const double recovery = secondsSince(start);
+
+			std::sort(latencies.begin(), latencies.end());
+			std::cout << modes[mode] << " commits=" << latencies.size()
+				<< " p50us=" << latencies[latencies.size() / 2]
+				<< " p99us=" << latencies[latencies.size() * 99 / 100]
+				<< " maxus=" << latencies.back()
+				<< " redoKB=" << (end - redo.redoLsn) / 1024
+				<< " pagesRedone=" << redo.pagesWritten
+				<< " recoveryms=" << recovery * 1000 << std::endl;
+		}
+	}
+	File::remove("bench.ckpt");
+	std::remove("bench.ckpt.log");
+	return 0;
+}
+
+struct Benchmark
+{
+	const char* name;
+	int (*run)(int argc, char* argv[]);
+};
+
+/**
+ * checksum [pages]: CRC-32C throughput with and without the CRC32
+ * instruction, and what verifying on the miss path and stamping on write-back
+ * cost per page, with checksums on against off.
+ */
+int benchChecksum(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 4096);
+	const std::uint32_t rounds = 3;
+	{
+		std::vector<char> buffer(Page::SIZE, 'x');
+		const std::uint32_t passes = 100000;
+		for (int hardware = 0; hardware <= 1; hardware++)
+		{
+			if (hardware && !crc32cHardware())
+				continue;
+			std::uint32_t crc = 0;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t pass = 0; pass < passes; pass++)
+				crc = hardware ? crc32c(&buffer[0], buffer.size(), crc) : crc32cPortable(&buffer[0], buffer.size(), crc);
+			const double seconds = secondsSince(start);
+			std::cout << (hardware ? "crc32 instruction" : "table (portable) ") << " GB/s="
+				<< (double) passes * Page::SIZE / seconds / 1e9 << " ns/page=" << seconds * 1e9 / passes
+				<< " (crc " << crc << ")" << std::endl;
+		}
+	}
+	{
+		File file = createBenchFile("bench.checksum", numPages);
+		for (int enabled = 0; enabled <= 1; enabled++)
+		{
+			file.setChecksums(enabled != 0);
+			double missBest = 1e9;
+			double writeBest = 1e9;
+			for (std::uint32_t round = 0; round < rounds; round++)
+			{
+				//a pool far smaller than the file, read in order: every access misses
+				BufMgr bufMgr(64);
+				Page* page;
+				Clock::time_point start = Clock::now();
+				for (PageId p = 1; p <= numPages; p++)
+				{
+					bufMgr.readPage(&file, p, page);
+					bufMgr.unPinPage(&file, p, false);
+				}
+				missBest = std::min(missBest, secondsSince(start));
+
+				BufMgr dirtyMgr(numPages);
+				dirtyPages(dirtyMgr, file, numPages);
+				start = Clock::now();
+				dirtyMgr.flushFile(&file);
+				writeBest = std::min(writeBest, secondsSince(start));
+			}
+			std::cout << "checksums " << (enabled ? "on " : "off") << " miss us/page=" << missBest * 1e6 / numPages
+				<< " write-back us/page=" << writeBest * 1e6 / numPages << std::endl;
+		}
+	}
+	File::remove("bench.checksum");
+	return 0;
+}
+
+/**
+ * Creates <filename> holding pages 1..numPages, each filled with records to
+ * <fillPercent> percent, compressed or not.
+ */
+File createFilledFile(const std::string& filename, const std::uint32_t numPages,
+	const std::uint32_t fillPercent, const bool compressed)
+{
+	removeIfExists(filename);
+	File file = compressed ? File::createCompressed(filename) : File::create(filename);
+	char record[128];
+	for (std::uint32_t i = 0; i < numPages; i++)
+	{
+		Page page = file.allocatePage();
+		std::uint32_t r = 0;
+		while (page.getFreeSpace() > Page::DATA_SIZE * (100 - fillPercent) / 100)
+		{
+			std::snprintf(record, sizeof(record), "customer %u order %u status shipped amount %u.%02u",
+				i * 131 + r, r * 7919 % 100000, r * 37 % 1000, r % 100);
+			page.insertRecord(record);
+			r++;
+		}
+		file.writePage(page);
+	}
+	return file;
+}
+
+/**
+ * compression [pages]: disk footprint, bytes read per page and CPU cost of
+ * compressed files against plain ones, for nearly empty and half full pages.
+ */
+int benchCompression(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 4096);
+	const std::uint32_t fills[] = {1, 50};
+	for (std::size_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++)
+	{
+		for (int compressed = 0; compressed <= 1; compressed++)
+		{
+			const std::string filename = compressed ? "bench.lz4" : "bench.plain";
+			{
+				File file = createFilledFile(filename, numPages, fills[f], compressed != 0);
+				std::ifstream sized(filename.c_str(), std::ios::binary | std::ios::ate);
+				const double bytesPerPage = (double) sized.tellg() / numPages;
+
+				//a pool far smaller than the file, read in order: every access misses
+				const CompressionStats before = file.compressionStats();
+				BufMgr bufMgr(64);
+				Page* page;
+				Clock::time_point start = Clock::now();
+				for (PageId p = 1; p <= numPages; p++)
+				{
+					bufMgr.readPage(&file, p, page);
+					bufMgr.unPinPage(&file, p, false);
+				}
+				const double missSeconds = secondsSince(start);
+				const CompressionStats after = file.compressionStats();
+				const double readPerPage = compressed
+					? (double) (after.bytesRead - before.bytesRead) / (after.pagesRead - before.pagesRead)
+					: (double) Page::SIZE;
+
+				BufMgr dirtyMgr(numPages);
+				dirtyPages(dirtyMgr, file, numPages);
+				start = Clock::now();
+				dirtyMgr.flushFile(&file);
+				const double writeSeconds = secondsSince(start);
+
+				std::cout << "fill " << fills[f] << "% " << (compressed ? "lz4  " : "plain")
+					<< " disk bytes/page=" << bytesPerPage
+					<< " read bytes/page=" << readPerPage
+					<< " miss us/page=" << missSeconds * 1e6 / numPages
+					<< " write-back us/page=" << writeSeconds * 1e6 / numPages;
+				if (compressed)
+					std::cout << " relocations=" << file.compressionStats().relocations;
+				std::cout << std::endl;
+			}
+			File::remove(filename);
+		}
+	}
+	return 0;
+}
+
+/**
+ * tier [pages] [frames] [tierMB]: random reads over a file several times the
+ * pool, without a second-level cache and with a compressed or plain one of
+ * the same memory budget; tier hit ratio, file reads and time per page.
+ */
+int benchTier(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 4096);
+	const std::uint32_t frames = argOr(argc, argv, 3, 256);
+	const std::uint64_t tierBytes = (std::uint64_t) argOr(argc, argv, 4, 8) * 1024 * 1024;
+	const std::uint32_t ops = 4 * numPages;
+	{
+		File file = createFilledFile("bench.tier", numPages, 50, false);
+		for (int mode = 0; mode <= 2; mode++)
+		{
+			CompressedTier tier(tierBytes, mode == 1);
+			BufMgrOptions options;
+			options.tier = mode == 0 ? NULL : &tier;
+			BufMgr bufMgr(frames, options);
+			unsigned int seed = 42;
+			Page* page;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t op = 0; op < ops; op++)
+			{
+				const PageId p = 1 + rand_r(&seed) % numPages;
+				bufMgr.readPage(&file, p, page);
+				bufMgr.unPinPage(&file, p, false);
+			}
+			const double seconds = secondsSince(start);
+			const TierStats stats = tier.getStats();
+			std::cout << (mode == 0 ? "no tier   " : mode == 1 ? "lz4 tier  " : "plain tier")
+				<< " file reads=" << bufMgr.getBufStats().diskreads
+				<< " tier pages=" << stats.pages
+				<< " tier hit ratio=" << stats.hitRatio()
+				<< " us/op=" << seconds * 1e6 / ops;
+			if (mode != 0)
+				std::cout << " store ns/page=" << (stats.inserts ? stats.storeNanos / stats.inserts : 0)
+					<< " load ns/hit=" << (stats.hits ? stats.loadNanos / stats.hits : 0);
+			std::cout << std::endl;
+			bufMgr.flushFile(&file);
+		}
+	}
+	File::remove("bench.tier");
+	return 0;
+}
+
+/**
+ * ssdtier [pages] [frames] [tierPages] [cachePath]: random reads over a file
+ * several times the pool, with evicted pages spilled to a cache file (put it
+ * on a fast device or tmpfs) against no tier and an LZ4 tier of as many
+ * pages; file reads saved, time per page and the tier's own costs.
+ */
+int benchSsdTier(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 4096);
+	const std::uint32_t frames = argOr(argc, argv, 3, 256);
+	const std::uint32_t tierPages = argOr(argc, argv, 4, 2048);
+	const std::string cachePath = argc > 5 ? argv[5] : "bench.ssdtier.cache";
+	const std::uint32_t ops = 4 * numPages;
+	{
+		File file = createFilledFile("bench.ssdtier", numPages, 50, false);
+		for (int mode = 0; mode <= 2; mode++)
+		{
+			CacheTier* tier = NULL;
+			if (mode == 1)
+				tier = new FileTier(cachePath, tierPages);
+			else if (mode == 2)
+				tier = new CompressedTier((std::uint64_t) tierPages * Page::SIZE, true);
+			BufMgrOptions options;
+			options.tier = tier;
+			BufMgr bufMgr(frames, options);
+			unsigned int seed = 42;
+			Page* page;
+			Clock::time_point start = Clock::now();
+			for (std::uint32_t op = 0; op < ops; op++)
+			{
+				const PageId p = 1 + rand_r(&seed) % numPages;
+				bufMgr.readPage(&file, p, page);
+				bufMgr.unPinPage(&file, p, false);
+			}
+			const double seconds = secondsSince(start);
+			std::cout << (mode == 0 ? "no tier  " : mode == 1 ? "file tier" : "lz4 tier ")
+				<< " file reads=" << bufMgr.getBufStats().diskreads
+				<< " us/op=" << seconds * 1e6 / ops;
+			if (tier != NULL)
+			{
+				const TierStats stats = tier->getStats();
+				std::cout << " tier pages=" << stats.pages
+					<< " tier hit ratio=" << stats.hitRatio()
+					<< " store ns/page=" << (stats.inserts ? stats.storeNanos / stats.inserts : 0)
+					<< " load ns/hit=" << (stats.hits ? stats.loadNanos / stats.hits : 0);
+			}
+			std::cout << std::endl;
+			bufMgr.flushFile(&file);
+			delete tier;
+		}
+	}
+	File::remove("bench.ssdtier");
+	return 0;
+}
+
+/**
+ * Record of 20 to 79 bytes of filler for heap benches, numbered <n>.
+ */
+std::string heapRecord(const std::uint32_t n)
+{
+	char record[128];
+	std::snprintf(record, sizeof(record), "record %u %0*u", n, (int) (20 + n % 60), n);
+	return record;
+}
+
+/**
+ * heap [records] [scanRecords] [frames]: inserts through the free-space map
+ * of a HeapFile against finding room by reading every page in turn, then
+ * deleting every other record and inserting as many again; us/insert and
+ * pages used.
+ */
+int benchHeap(int argc, char* argv[])
+{
+	const std::uint32_t numRecords = argOr(argc, argv, 2, 1000000);
+	const std::uint32_t scanRecords = argOr(argc, argv, 3, 20000);
+	const std::uint32_t frames = argOr(argc, argv, 4, 1024);
+	{
+		//baseline: look for room on every page from the first, as without a map
+		File file = File::create("bench.heap");
+		BufMgr bufMgr(frames);
+		PageId numPages = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t n = 0; n < scanRecords; n++)
+		{
+			const std::string record = heapRecord(n);
+			PageId pageNo = 1;
+			Page* page = NULL;
+			for (; pageNo <= numPages; pageNo++)
+			{
+				bufMgr.readPage(&file, pageNo, page);
+				if (page->hasSpaceForRecord(record))
+					break;
+				bufMgr.unPinPage(&file, pageNo, false);
+			}
+			if (pageNo > numPages)
+			{
+				bufMgr.allocPage(&file, pageNo, page);
+				numPages = pageNo;
+			}
+			page->insertRecord(record);
+			bufMgr.unPinPage(&file, pageNo, true);
+		}
+		const double seconds = secondsSince(start);
+		std::cout << "page scan records=" << scanRecords << " pages=" << numPages
+			<< " us/insert=" << seconds * 1e6 / scanRecords << std::endl;
+		bufMgr.flushFile(&file);
+	}
+	File::remove("bench.heap");
+	{
+		File file = File::create("bench.heap");
+		BufMgr bufMgr(frames);
+		HeapFile heap(bufMgr, file);
+		std::vector<RecordId> rids;
+		rids.reserve(numRecords);
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t n = 0; n < numRecords; n++)
+			rids.push_back(heap.insertRecord(heapRecord(n)));
+		double seconds = secondsSince(start);
+		const std::uint32_t pages = heap.getNumDataPages();
+		std::cout << "heap file records=" << numRecords << " pages=" << pages
+			<< " us/insert=" << seconds * 1e6 / numRecords << std::endl;
+
+		start = Clock::now();
+		for (std::uint32_t n = 0; n < numRecords; n += 2)
+			heap.deleteRecord(rids[n]);
+		const double deleteSeconds = secondsSince(start);
+		start = Clock::now();
+		for (std::uint32_t n = 0; n < numRecords; n += 2)
+			rids[n] = heap.insertRecord(heapRecord(n));
+		seconds = secondsSince(start);
+		std::cout << "heap file delete half, insert again: pages=" << heap.getNumDataPages()
+			<< " (+" << heap.getNumDataPages() - pages << ")"
+			<< " us/delete=" << deleteSeconds * 1e6 / (numRecords / 2)
+			<< " us/insert=" << seconds * 1e6 / (numRecords / 2) << std::endl;
+
+		for (std::uint32_t n = 0; n < numRecords; n += 997)
+		{
+			if (heap.getRecord(rids[n]) != heapRecord(n))
+			{
+				std::cerr << "record " << n << " read back wrong" << std::endl;
+				return 1;
+			}
+		}
+		bufMgr.flushFile(&file);
+	}
+	File::remove("bench.heap");
+	return 0;
+}
+
+/**
+ * Number of pages of <file>.
+ */
+std::uint32_t countPages(File& file)
+{
+	std::uint32_t pages = 0;
+	for (FileIterator it = file.begin(); it != file.end(); ++it)
+		pages++;
+	return pages;
+}
+
+/**
+ * Random lookups of keys 0..numKeys-1 in <tree> from <numThreads> threads at
+ * once; lookups per second over all of them.
+ */
+double treeLookupRate(BTreeIndex& tree, std::uint32_t numKeys, std::uint32_t lookups,
+                      std::uint32_t numThreads)
+{
+	std::atomic<std::uint32_t> misses(0);
+	std::vector<std::thread> threads;
+	Clock::time_point start = Clock::now();
+	for (std::uint32_t t = 0; t < numThreads; t++)
+	{
+		threads.push_back(std::thread([&, t]() {
+			unsigned int seed = 42 + t;
+			RecordId rid;
+			for (std::uint32_t op = 0; op < lookups; op++)
+			{
+				if (!tree.lookup((std::int64_t) (rand_r(&seed) % numKeys), rid))
+					misses++;
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	const double seconds = secondsSince(start);
+	if (misses > 0)
+		std::cerr << misses << " keys not found" << std::endl;
+	return numThreads * (double) lookups / seconds;
+}
+
+/**
+ * Baseline for the index benches: with no index, finds each of <lookups>
+ * random keys 0..numKeys-1 of a heap file by reading its pages through
+ * FileIterator until the record with the key turns up.
+ */
+void fileScanLookups(std::uint32_t numKeys, std::uint32_t frames, std::uint32_t lookups)
+{
+	removeIfExists("bench.scan");
+	{
+		File file = File::create("bench.scan");
+		{
+			BufMgr bufMgr(frames);
+			HeapFile heap(bufMgr, file);
+			for (std::uint32_t n = 0; n < numKeys; n++)
+				heap.insertRecord(BTreeIndex::encodeKey(n) + heapRecord(n));
+			bufMgr.flushFile(&file);
+		}
+		unsigned int seed = 11;
+		std::uint64_t pagesRead = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t op = 0; op < lookups; op++)
+		{
+			const std::string key = BTreeIndex::encodeKey(rand_r(&seed) % numKeys);
+			bool found = false;
+			for (FileIterator it = file.begin(); it != file.end() && !found; ++it)
+			{
+				Page page = *it;
+				pagesRead++;
+				if (HeapFile::isFsmPage(page.page_number()))
+					continue;
+				for (PageIterator record = page.begin(); record != page.end(); ++record)
+				{
+					if ((*record).compare(0, key.size(), key) == 0)
+					{
+						found = true;
+						break;
+					}
+				}
+			}
+		}
+		const double seconds = secondsSince(start);
+		std::cout << "file scan lookups=" << lookups << " pages/lookup=" << pagesRead / lookups
+			<< " us/lookup=" << seconds * 1e6 / lookups << std::endl;
+	}
+	File::remove("bench.scan");
+}
+
+/**
+ * btree [keys] [frames] [lookups] [threads] [scanLookups]: builds a B+tree of
+ * integer keys by random inserts and by a bulk load, then times random point
+ * lookups (from several threads at once) and 100-key range scans, against
+ * finding a key by reading every page of a heap file through FileIterator.
+ */
+int benchBTree(int argc, char* argv[])
+{
+	const std::uint32_t numKeys = argOr(argc, argv, 2, 1000000);
+	const std::uint32_t frames = argOr(argc, argv, 3, 4096);
+	const std::uint32_t lookups = argOr(argc, argv, 4, 1000000);
+	const std::uint32_t numThreads = argOr(argc, argv, 5, 1);
+	const std::uint32_t scanLookups = argOr(argc, argv, 6, 10);
+
+	std::vector<std::int64_t> keys(numKeys);
+	for (std::uint32_t n = 0; n < numKeys; n++)
+		keys[n] = n;
+	unsigned int seed = 7;
+	for (std::uint32_t n = numKeys - 1; n > 0; n--)
+		std::swap(keys[n], keys[rand_r(&seed) % (n + 1)]);
+
+	for (int bulk = 0; bulk <= 1; bulk++)
+	{
+		removeIfExists("bench.btree");
+		File file = File::create("bench.btree");
+		BufMgr bufMgr(frames);
+		BTreeIndex tree(bufMgr, file, BTreeIndex::INTEGER_KEYS);
+		Clock::time_point start = Clock::now();
+		if (bulk == 1)
+		{
+			std::vector<std::pair<std::int64_t, RecordId> > entries;
+			entries.reserve(numKeys);
+			for (std::uint32_t n = 0; n < numKeys; n++)
+				entries.push_back(std::make_pair((std::int64_t) n, RecordId{n / 100 + 1, (SlotId) (n % 100 + 1)}));
+			start = Clock::now();
+			tree.bulkLoad(entries);
+		}
+		else
+		{
+			for (std::uint32_t n = 0; n < numKeys; n++)
+				tree.insert(keys[n], RecordId{(PageId) (keys[n] / 100 + 1), (SlotId) (keys[n] % 100 + 1)});
+		}
+		const double buildSeconds = secondsSince(start);
+		bufMgr.flushFile(&file);
+		std::cout << (bulk ? "bulk load" : "random inserts") << " keys=" << numKeys
+			<< " height=" << tree.getHeight() << " pages=" << countPages(file)
+			<< " us/key=" << buildSeconds * 1e6 / numKeys << std::endl;
+
+		const double rate = treeLookupRate(tree, numKeys, lookups, numThreads);
+		std::cout << "  lookups threads=" << numThreads << " lookups/s=" << (long) rate
+			<< " us/lookup=" << numThreads * 1e6 / rate << std::endl;
+
+		const std::uint32_t scans = lookups / 10;
+		std::vector<RecordId> rids;
+		std::uint64_t found = 0;
+		start = Clock::now();
+		for (std::uint32_t op = 0; op < scans; op++)
+		{
+			const std::int64_t low = rand_r(&seed) % numKeys;
+			rids.clear();
+			found += tree.scan(low, low + 99, rids);
+		}
+		const double seconds = secondsSince(start);
+		std::cout << "  range scans of 100 keys: us/scan=" << seconds * 1e6 / scans
+			<< " entries/scan=" << (double) found / scans << std::endl;
+	}
+	File::remove("bench.btree");
+
+	fileScanLookups(numKeys, frames, scanLookups);
+	return 0;
+}
+
+/**
+ * hash [keys] [frames] [lookups] [scanLookups]: builds an extendible hash
+ * index of integer keys inserted in random order, then times random point
+ * lookups against finding a key by reading every page of a heap file
+ * through FileIterator.
+ */
+int benchHash(int argc, char* argv[])
+{
+	const std::uint32_t numKeys = argOr(argc, argv, 2, 1000000);
+	const std::uint32_t frames = argOr(argc, argv, 3, 4096);
+	const std::uint32_t lookups = argOr(argc, argv, 4, 1000000);
+	const std::uint32_t scanLookups = argOr(argc, argv, 5, 10);
+
+	std::vector<std::int64_t> keys(numKeys);
+	for (std::uint32_t n = 0; n < numKeys; n++)
+		keys[n] = n;
+	unsigned int seed = 7;
+	for (std::uint32_t n = numKeys - 1; n > 0; n--)
+		std::swap(keys[n], keys[rand_r(&seed) % (n + 1)]);
+	{
+		removeIfExists("bench.hash");
+		File file = File::create("bench.hash");
+		BufMgr bufMgr(frames);
+		HashIndex hash(bufMgr, file, HashIndex::INTEGER_KEYS);
+		//the slowest insert is the one that doubles the biggest directory
+		double slowest = 0;
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t n = 0; n < numKeys; n++)
+		{
+			Clock::time_point insertStart = Clock::now();
+			hash.insert(keys[n], RecordId{(PageId) (keys[n] / 100 + 1), (SlotId) (keys[n] % 100 + 1)});
+			slowest = std::max(slowest, secondsSince(insertStart));
+		}
+		const double buildSeconds = secondsSince(start);
+		bufMgr.flushFile(&file);
+		std::cout << "hash inserts keys=" << numKeys << " buckets=" << hash.getNumBuckets()
+			<< " globalDepth=" << hash.getGlobalDepth() << " pages=" << countPages(file)
+			<< " us/key=" << buildSeconds * 1e6 / numKeys << " slowest us=" << slowest * 1e6 << std::endl;
+
+		std::uint32_t misses = 0;
+		RecordId rid;
+		start = Clock::now();
+		for (std::uint32_t op = 0; op < lookups; op++)
+		{
+			if (!hash.lookup((std::int64_t) (rand_r(&seed) % numKeys), rid))
+				misses++;
+		}
+		const double seconds = secondsSince(start);
+		if (misses > 0)
+			std::cerr << misses << " keys not found" << std::endl;
+		std::cout << "  lookups us/lookup=" << seconds * 1e6 / lookups << std::endl;
+	}
+	File::remove("bench.hash");
+	fileScanLookups(numKeys, frames, scanLookups);
+	return 0;
+}
+
+/**
+ * parallelscan [pages] [maxThreads] [morselPages]: counts the records of a
+ * file matching a predicate by FileIterator, then by ParallelScan with 1 to
+ * maxThreads workers from a pool holding the whole file, then with morsels of
+ * 1 to 4 * morselPages pages from a pool a quarter of its size, so that most
+ * pages are read from the file; pages/s.
+ */
+int benchParallelScan(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argOr(argc, argv, 2, 20000);
+	const std::uint32_t maxThreads = argOr(argc, argv, 3, std::max<std::uint32_t>(1, std::thread::hardware_concurrency()));
+	const std::uint32_t morselPages = argOr(argc, argv, 4, 32);
+	const std::uint32_t recordsPerPage = 40;
+	removeIfExists("bench.pscan");
+	{
+		File file = File::create("bench.pscan");
+		for (std::uint32_t p = 0; p < numPages; p++)
+		{
+			Page page = file.allocatePage();
+			for (std::uint32_t r = 0; r < recordsPerPage; r++)
+				page.insertRecord(heapRecord(p * recordsPerPage + r) + std::string(120, 'x'));
+			file.writePage(page);
+		}
+		//records whose number ends in 7
+		const ParallelScan::RecordPredicate predicate = [](const RecordId&, const std::string& record) {
+			return record[record.find(' ', 7) - 1] == '7';
+		};
+		const std::uint64_t expected = (std::uint64_t) numPages * recordsPerPage / 10;
+
+		std::uint64_t matches = 0;
+		Clock::time_point start = Clock::now();
+		for (FileIterator it = file.begin(); it != file.end(); ++it)
+		{
+			Page page = *it;
+			for (PageIterator record = page.begin(); record != page.end(); ++record)
+			{
+				if (predicate(record.record_id(), *record))
+					matches++;
+			}
+		}
+		double seconds = secondsSince(start);
+		std::cout << "FileIterator pages/s=" << (long) (numPages / seconds) << " matches=" << matches << std::endl;
+
+		{
+			BufMgr bufMgr(numPages + 64);
+			for (std::uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+			{
+				ParallelScan scan(bufMgr, threads, morselPages);
+				//the first scan reads the file into the pool
+				scan.count(file, predicate);
+				start = Clock::now();
+				matches = scan.count(file, predicate);
+				seconds = secondsSince(start);
+				std::cout << "in memory threads=" << threads << " morselPages=" << morselPages
+					<< " pages/s=" << (long) (numPages / seconds) << std::endl;
+				if (matches != expected)
+					std::cerr << "wrong count " << matches << std::endl;
+			}
+		}
+		{
+			BufMgr bufMgr(numPages / 4);
+			for (std::uint32_t morsel = 1; morsel <= 4 * morselPages; morsel *= 4)
+			{
+				ParallelScan scan(bufMgr, maxThreads, morsel);
+				start = Clock::now();
+				matches = scan.count(file, predicate);
+				seconds = secondsSince(start);
+				std::cout << "from file threads=" << maxThreads << " morselPages=" << morsel
+					<< " pages/s=" << (long) (numPages / seconds) << std::endl;
+				if (matches != expected)
+					std::cerr << "wrong count " << matches << std::endl;
+			}
+		}
+	}
+	File::remove("bench.pscan");
+	return 0;
+}
+
+const Benchmark benchmarks[] = {
+	{"hugepages", benchHugePages},
+	{"numa", benchNuma},
+	{"batch", benchBatch},
+	{"optimistic", benchOptimistic},
+	{"swizzle", benchSwizzle},
+	{"guard", benchGuard},
+	{"warmup", benchWarmUp},
+	{"asyncflush", benchAsyncFlush},
+	{"wal", benchWal},
+	{"checkpoint", benchCheckpoint},
+	{"checksum", benchChecksum},
+	{"compression", benchCompression},
+	{"tier", benchTier},
+	{"ssdtier", benchSsdTier},
+	{"heap", benchHeap},
+	{"btree", benchBTree},
+	{"hash", benchHash},
+	{"parallelscan", benchParallelScan},
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+	if (argc >= 2)
+	{
+		for (std::size_t b = 0; b < count; b++)
+		{
+			if (std::strcmp(argv[1], benchmarks[b].name) == 0)
+				return benchmarks[b].run(argc, argv);
+		}
+	}
+
+	std::cerr << "usage: " << argv[0] << " <benchmark> [args]\nbenchmarks:";
+	for (std::size_t b = 0; b < count; b++)
+		std::cerr << " " << benchmarks[b].name;
+	std::cerr << "\n";
+	return 1;
+}
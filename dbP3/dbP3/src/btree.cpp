@@ -0,0 +1,842 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "btree.h"
+#include "file_iterator.h"
+#include "exceptions/index_exception.h"
+
+namespace badgerdb {
+
+    namespace {
+
+        const PageId META_PAGE = 1;
+
+        const std::uint32_t META_MAGIC = 0x54424442; // "BDBT"
+
+        /**
+         * Contents of page 1
+         */
+        struct IndexMeta
+        {
+            std::uint32_t magic;
+            std::uint32_t keyType;
+            PageId root;
+            std::uint32_t height;
+        };
+
+        /**
+         * Start of every node, followed by the array of entry offsets
+         */
+        struct NodeHeader
+        {
+            /**
+             * 0 for a leaf, one more than its children for an internal node
+             */
+            std::uint16_t level;
+
+            /**
+             * Number of entries
+             */
+            std::uint16_t count;
+
+            /**
+             * Offset of the lowest entry; entries are packed from the end of the node down to it
+             */
+            std::uint16_t dataStart;
+
+            std::uint16_t unused;
+
+            /**
+             * Right sibling of a leaf
+             */
+            PageId next;
+
+            /**
+             * Child of an internal node with the keys below its first entry's
+             */
+            PageId leftmost;
+        };
+
+        const std::size_t OFFSET_BYTES = sizeof(std::uint16_t);
+        const std::size_t RID_BYTES = sizeof(PageId) + sizeof(SlotId);
+        const std::size_t CHILD_BYTES = sizeof(PageId);
+
+        /**
+         * Room an internal node must have so that any split of a child fits in it
+         */
+        const std::size_t MAX_INTERNAL_ENTRY = OFFSET_BYTES + BTreeIndex::MAX_KEY_LENGTH + CHILD_BYTES + OFFSET_BYTES;
+
+        NodeHeader& headerOf(char* node)
+        {
+            return *reinterpret_cast<NodeHeader*>(node);
+        }
+
+        std::uint16_t* offsetsOf(char* node)
+        {
+            return reinterpret_cast<std::uint16_t*>(node + sizeof(NodeHeader));
+        }
+
+        std::uint16_t keyLength(const char* entry)
+        {
+            std::uint16_t length;
+            std::memcpy(&length, entry, sizeof(length));
+            return length;
+        }
+
+        const char* entryAt(char* node, const std::uint32_t index)
+        {
+            return node + offsetsOf(node)[index];
+        }
+
+        std::size_t entrySize(const char* entry, const bool leaf)
+        {
+            return OFFSET_BYTES + keyLength(entry) + (leaf ? RID_BYTES : CHILD_BYTES);
+        }
+
+        std::string keyOf(const char* entry)
+        {
+            return std::string(entry + OFFSET_BYTES, keyLength(entry));
+        }
+
+        /**
+         * Compare the key of an entry with a key, memcmp order with the shorter first on a tie
+         */
+        int compareKey(const char* entry, const std::string& key)
+        {
+            const std::size_t length = keyLength(entry);
+            const int order = std::memcmp(entry + OFFSET_BYTES, key.data(), std::min(length, key.size()));
+            if (order != 0)
+            {
+                return order;
+            }
+            return length < key.size() ? -1 : length > key.size() ? 1 : 0;
+        }
+
+        /**
+         * Position of the first entry with a key not below the given one
+         */
+        std::uint32_t lowerBound(char* node, const std::string& key)
+        {
+            std::uint32_t low = 0;
+            std::uint32_t high = headerOf(node).count;
+            while (low < high)
+            {
+                const std::uint32_t middle = (low + high) / 2;
+                if (compareKey(entryAt(node, middle), key) < 0)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low;
+        }
+
+        /**
+         * Position of the first entry with a key above the given one
+         */
+        std::uint32_t upperBound(char* node, const std::string& key)
+        {
+            std::uint32_t low = 0;
+            std::uint32_t high = headerOf(node).count;
+            while (low < high)
+            {
+                const std::uint32_t middle = (low + high) / 2;
+                if (compareKey(entryAt(node, middle), key) <= 0)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low;
+        }
+
+        /**
+         * Child of an internal node: the leftmost one for 0, else that of entry index - 1
+         */
+        PageId childAt(char* node, const std::uint32_t index)
+        {
+            if (index == 0)
+            {
+                return headerOf(node).leftmost;
+            }
+            const char* entry = entryAt(node, index - 1);
+            PageId child;
+            std::memcpy(&child, entry + OFFSET_BYTES + keyLength(entry), sizeof(child));
+            return child;
+        }
+
+        RecordId ridOf(const char* entry)
+        {
+            const char* value = entry + OFFSET_BYTES + keyLength(entry);
+            RecordId rid;
+            std::memcpy(&rid.page_number, value, sizeof(rid.page_number));
+            std::memcpy(&rid.slot_number, value + sizeof(rid.page_number), sizeof(rid.slot_number));
+            return rid;
+        }
+
+        std::string leafEntry(const std::string& key, const RecordId& rid)
+        {
+            std::string entry(OFFSET_BYTES + key.size() + RID_BYTES, '\0');
+            const std::uint16_t length = key.size();
+            std::memcpy(&entry[0], &length, sizeof(length));
+            std::memcpy(&entry[OFFSET_BYTES], key.data(), key.size());
+            std::memcpy(&entry[OFFSET_BYTES + key.size()], &rid.page_number, sizeof(rid.page_number));
+            std::memcpy(&entry[OFFSET_BYTES + key.size() + sizeof(rid.page_number)], &rid.slot_number,
+                        sizeof(rid.slot_number));
+            return entry;
+        }
+
+        std::string internalEntry(const std::string& key, const PageId child)
+        {
+            std::string entry(OFFSET_BYTES + key.size() + CHILD_BYTES, '\0');
+            const std::uint16_t length = key.size();
+            std::memcpy(&entry[0], &length, sizeof(length));
+            std::memcpy(&entry[OFFSET_BYTES], key.data(), key.size());
+            std::memcpy(&entry[OFFSET_BYTES + key.size()], &child, sizeof(child));
+            return entry;
+        }
+
+        /**
+         * Bytes left for entries and their offsets
+         */
+        std::size_t freeBytes(char* node)
+        {
+            const NodeHeader& header = headerOf(node);
+            return header.dataStart - sizeof(NodeHeader) - header.count * OFFSET_BYTES;
+        }
+
+        void initNode(char* node, const std::uint16_t level)
+        {
+            NodeHeader& header = headerOf(node);
+            header.level = level;
+            header.count = 0;
+            header.dataStart = Page::DATA_SIZE;
+            header.unused = 0;
+            header.next = Page::INVALID_NUMBER;
+            header.leftmost = Page::INVALID_NUMBER;
+        }
+
+        /**
+         * Insert an entry at a position; the node must have room for it
+         */
+        void insertEntry(char* node, const std::uint32_t position, const char* entry, const std::size_t size)
+        {
+            NodeHeader& header = headerOf(node);
+            assert(freeBytes(node) >= size + OFFSET_BYTES);
+            header.dataStart -= size;
+            std::memcpy(node + header.dataStart, entry, size);
+            std::uint16_t* offsets = offsetsOf(node);
+            std::memmove(offsets + position + 1, offsets + position, (header.count - position) * OFFSET_BYTES);
+            offsets[position] = header.dataStart;
+            header.count++;
+        }
+
+    }
+
+    const std::uint32_t BTreeIndex::MAX_KEY_LENGTH;
+    const std::uint32_t BTreeIndex::LATCH_CHUNK;
+    const std::uint32_t BTreeIndex::LATCH_CHUNKS;
+
+    /**
+     * Constructor of BTreeIndex class; opens the index in the file, or creates an empty one
+     */
+    BTreeIndex::BTreeIndex(BufMgr& bufMgr, File& file, const KeyType keyType)
+    : bufMgr(bufMgr), file(file), keyType(keyType), root(Page::INVALID_NUMBER), height(0), latchChunks(NULL)
+    {
+        if (file.begin() == file.end())
+        {
+            PageId metaNo;
+            Page* meta;
+            bufMgr.allocPage(&file, metaNo, meta);
+            bufMgr.unPinPage(&file, metaNo, true);
+            assert(metaNo == META_PAGE);
+            Page* rootPage;
+            root = allocNode(0, rootPage);
+            bufMgr.unPinPage(&file, root, true);
+            height = 1;
+            writeMeta();
+        }
+        else
+        {
+            Page* meta;
+            bufMgr.readPage(&file, META_PAGE, meta);
+            IndexMeta contents;
+            std::memcpy(&contents, meta->data(), sizeof(contents));
+            bufMgr.unPinPage(&file, META_PAGE, false);
+            if (contents.magic != META_MAGIC)
+            {
+                throw IndexException(file.filename(), "not a B+tree index");
+            }
+            if (contents.keyType != (std::uint32_t) keyType)
+            {
+                throw IndexException(file.filename(), "index has another kind of key");
+            }
+            root = contents.root;
+            height = contents.height;
+        }
+        latchChunks = new std::atomic<NodeLatch*>[LATCH_CHUNKS];
+        for (std::uint32_t chunk = 0; chunk < LATCH_CHUNKS; chunk++)
+        {
+            latchChunks[chunk].store(NULL, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Destructor of BTreeIndex class
+     */
+    BTreeIndex::~BTreeIndex()
+    {
+        for (std::uint32_t chunk = 0; chunk < LATCH_CHUNKS; chunk++)
+        {
+            delete[] latchChunks[chunk].load(std::memory_order_relaxed);
+        }
+        delete[] latchChunks;
+    }
+
+    void BTreeIndex::insert(const std::int64_t key, const RecordId& rid)
+    {
+        const std::string encoded = encodeKey(key);
+        checkKey(encoded, INTEGER_KEYS);
+        insertKey(encoded, rid);
+    }
+
+    void BTreeIndex::insert(const std::string& key, const RecordId& rid)
+    {
+        checkKey(key, BYTE_KEYS);
+        insertKey(key, rid);
+    }
+
+    bool BTreeIndex::lookup(const std::int64_t key, RecordId& rid)
+    {
+        return lookup(encodeKey(key), rid);
+    }
+
+    bool BTreeIndex::lookup(const std::string& key, RecordId& rid)
+    {
+        Page* page;
+        PageId pageNo = findLeaf(key, page);
+        std::uint32_t index = lowerBound(page->data(), key);
+        //entries with the key may start in the next leaf
+        while (index == headerOf(page->data()).count && headerOf(page->data()).next != Page::INVALID_NUMBER)
+        {
+            const PageId next = headerOf(page->data()).next;
+            Page* nextPage;
+            try
+            {
+                bufMgr.readPage(&file, next, nextPage);
+            }
+            catch (...)
+            {
+                releaseShared(pageNo);
+                throw;
+            }
+            latchOf(next).lockShared();
+            releaseShared(pageNo);
+            pageNo = next;
+            page = nextPage;
+            index = 0;
+        }
+        const bool found = index < headerOf(page->data()).count && compareKey(entryAt(page->data(), index), key) == 0;
+        if (found)
+        {
+            rid = ridOf(entryAt(page->data(), index));
+        }
+        releaseShared(pageNo);
+        return found;
+    }
+
+    std::uint32_t BTreeIndex::scan(const std::int64_t low, const std::int64_t high, std::vector<RecordId>& rids)
+    {
+        return scan(encodeKey(low), encodeKey(high), rids);
+    }
+
+    std::uint32_t BTreeIndex::scan(const std::string& low, const std::string& high, std::vector<RecordId>& rids)
+    {
+        Page* page;
+        PageId pageNo = findLeaf(low, page);
+        std::uint32_t found = 0;
+        std::uint32_t index = lowerBound(page->data(), low);
+        for (;;)
+        {
+            char* node = page->data();
+            const std::uint32_t count = headerOf(node).count;
+            for (; index < count; index++)
+            {
+                const char* entry = entryAt(node, index);
+                if (compareKey(entry, high) > 0)
+                {
+                    releaseShared(pageNo);
+                    return found;
+                }
+                rids.push_back(ridOf(entry));
+                found++;
+            }
+            const PageId next = headerOf(node).next;
+            if (next == Page::INVALID_NUMBER)
+            {
+                break;
+            }
+            //hold on to this leaf until the next one is latched, so no split can slip in between
+            Page* nextPage;
+            try
+            {
+                bufMgr.readPage(&file, next, nextPage);
+            }
+            catch (...)
+            {
+                releaseShared(pageNo);
+                throw;
+            }
+            latchOf(next).lockShared();
+            releaseShared(pageNo);
+            pageNo = next;
+            page = nextPage;
+            index = 0;
+        }
+        releaseShared(pageNo);
+        return found;
+    }
+
+    void BTreeIndex::bulkLoad(const std::vector<std::pair<std::int64_t, RecordId> >& entries, const double fill)
+    {
+        if (keyType != INTEGER_KEYS)
+        {
+            throw IndexException(file.filename(), "integer key for an index of byte keys");
+        }
+        std::vector<std::pair<std::string, RecordId> > encoded;
+        encoded.reserve(entries.size());
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            encoded.push_back(std::make_pair(encodeKey(entries[i].first), entries[i].second));
+        }
+        bulkLoad(encoded, fill);
+    }
+
+    void BTreeIndex::bulkLoad(const std::vector<std::pair<std::string, RecordId> >& entries, const double fill)
+    {
+        {
+            Page* rootPage;
+            bufMgr.readPage(&file, root, rootPage);
+            const bool empty = headerOf(rootPage->data()).count == 0;
+            bufMgr.unPinPage(&file, root, false);
+            if (!empty || height != 1)
+            {
+                throw IndexException(file.filename(), "bulk load into an index that is not empty");
+            }
+        }
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            if (keyType == BYTE_KEYS)
+            {
+                checkKey(entries[i].first, BYTE_KEYS);
+            }
+            if (i > 0 && entries[i].first < entries[i - 1].first)
+            {
+                throw IndexException(file.filename(), "bulk load input is not sorted");
+            }
+        }
+        const std::size_t budget = std::max(0.0, std::min(1.0, fill)) * (Page::DATA_SIZE - sizeof(NodeHeader));
+
+        //leaves, starting with the empty root; each level is described to the next by the
+        //first key and page of each of its nodes
+        std::vector<std::pair<std::string, PageId> > level;
+        PageId pageNo = root;
+        Page* page;
+        bufMgr.readPage(&file, pageNo, page);
+        std::size_t used = 0;
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            const std::string entry = leafEntry(entries[i].first, entries[i].second);
+            char* node = page->data();
+            if (headerOf(node).count > 0 &&
+                (used + entry.size() + OFFSET_BYTES > budget || freeBytes(node) < entry.size() + OFFSET_BYTES))
+            {
+                Page* nextPage;
+                const PageId next = allocNode(0, nextPage);
+                headerOf(node).next = next;
+                bufMgr.unPinPage(&file, pageNo, true);
+                pageNo = next;
+                page = nextPage;
+                node = page->data();
+                used = 0;
+            }
+            if (headerOf(node).count == 0)
+            {
+                level.push_back(std::make_pair(entries[i].first, pageNo));
+            }
+            insertEntry(node, headerOf(node).count, entry.data(), entry.size());
+            used += entry.size() + OFFSET_BYTES;
+        }
+        bufMgr.unPinPage(&file, pageNo, true);
+        std::uint32_t levels = 1;
+
+        while (level.size() > 1)
+        {
+            std::vector<std::pair<std::string, PageId> > upper;
+            pageNo = allocNode(levels, page);
+            //the first child of a node goes in its leftmost pointer, without an entry
+            headerOf(page->data()).leftmost = level[0].second;
+            upper.push_back(std::make_pair(level[0].first, pageNo));
+            used = 0;
+            for (std::size_t i = 1; i < level.size(); i++)
+            {
+                const std::string entry = internalEntry(level[i].first, level[i].second);
+                char* node = page->data();
+                if (headerOf(node).count > 0 &&
+                    (used + entry.size() + OFFSET_BYTES > budget || freeBytes(node) < entry.size() + OFFSET_BYTES))
+                {
+                    bufMgr.unPinPage(&file, pageNo, true);
+                    pageNo = allocNode(levels, page);
+                    headerOf(page->data()).leftmost = level[i].second;
+                    upper.push_back(std::make_pair(level[i].first, pageNo));
+                    used = 0;
+                    continue;
+                }
+                insertEntry(node, headerOf(node).count, entry.data(), entry.size());
+                used += entry.size() + OFFSET_BYTES;
+            }
+            bufMgr.unPinPage(&file, pageNo, true);
+            level.swap(upper);
+            levels++;
+        }
+        if (!level.empty())
+        {
+            root = level[0].second;
+            height = levels;
+            writeMeta();
+        }
+    }
+
+    std::uint32_t BTreeIndex::getHeight()
+    {
+        rootLatch.lockShared();
+        const std::uint32_t levels = height;
+        rootLatch.unlockShared();
+        return levels;
+    }
+
+    std::string BTreeIndex::encodeKey(const std::int64_t key)
+    {
+        const std::uint64_t bits = (std::uint64_t) key ^ (1ULL << 63);
+        char bytes[sizeof(bits)];
+        for (std::size_t i = 0; i < sizeof(bits); i++)
+        {
+            bytes[i] = (char) (bits >> (8 * (sizeof(bits) - 1 - i)));
+        }
+        return std::string(bytes, sizeof(bytes));
+    }
+
+    /**
+     * Latch of a node, allocating its chunk if need be
+     */
+    NodeLatch& BTreeIndex::latchOf(const PageId pageNo)
+    {
+        const std::uint32_t chunk = pageNo / LATCH_CHUNK;
+        if (chunk >= LATCH_CHUNKS)
+        {
+            throw IndexException(file.filename(), "index has too many pages");
+        }
+        NodeLatch* latches = latchChunks[chunk].load(std::memory_order_acquire);
+        if (latches == NULL)
+        {
+            std::lock_guard<std::mutex> guard(chunkLatch);
+            latches = latchChunks[chunk].load(std::memory_order_relaxed);
+            if (latches == NULL)
+            {
+                latches = new NodeLatch[LATCH_CHUNK];
+                latchChunks[chunk].store(latches, std::memory_order_release);
+            }
+        }
+        return latches[pageNo % LATCH_CHUNK];
+    }
+
+    /**
+     * Throw IndexException unless a key is of the index's kind and not too long
+     */
+    void BTreeIndex::checkKey(const std::string& key, const KeyType expected) const
+    {
+        if (keyType != expected)
+        {
+            throw IndexException(file.filename(), keyType == INTEGER_KEYS ? "byte key for an index of integer keys"
+                                                                          : "integer key for an index of byte keys");
+        }
+        if (key.size() > MAX_KEY_LENGTH)
+        {
+            throw IndexException(file.filename(), "key longer than MAX_KEY_LENGTH");
+        }
+    }
+
+    /**
+     * Pin and latch the leaf where entries with a key start, shared
+     */
+    PageId BTreeIndex::findLeaf(const std::string& key, Page*& page)
+    {
+        rootLatch.lockShared();
+        PageId pageNo = root;
+        try
+        {
+            bufMgr.readPage(&file, pageNo, page);
+        }
+        catch (...)
+        {
+            rootLatch.unlockShared();
+            throw;
+        }
+        latchOf(pageNo).lockShared();
+        rootLatch.unlockShared();
+        //go left of a separator equal to the key: entries with it may also end the child before
+        while (headerOf(page->data()).level > 0)
+        {
+            const PageId child = childAt(page->data(), lowerBound(page->data(), key));
+            Page* childPage;
+            try
+            {
+                bufMgr.readPage(&file, child, childPage);
+            }
+            catch (...)
+            {
+                releaseShared(pageNo);
+                throw;
+            }
+            latchOf(child).lockShared();
+            releaseShared(pageNo);
+            pageNo = child;
+            page = childPage;
+        }
+        return pageNo;
+    }
+
+    /**
+     * Unlatch and unpin a node
+     */
+    void BTreeIndex::releaseShared(const PageId pageNo)
+    {
+        latchOf(pageNo).unlockShared();
+        bufMgr.unPinPage(&file, pageNo, false);
+    }
+
+    /**
+     * Unlatch and unpin the nodes of a writer's path
+     */
+    void BTreeIndex::releasePath(std::vector<PathNode>& path, const std::size_t dirtyFrom)
+    {
+        for (std::size_t i = 0; i < path.size(); i++)
+        {
+            latchOf(path[i].pageNo).unlockExclusive();
+            bufMgr.unPinPage(&file, path[i].pageNo, i >= dirtyFrom);
+        }
+        path.clear();
+    }
+
+    /**
+     * Insert an encoded key
+     */
+    void BTreeIndex::insertKey(const std::string& key, const RecordId& rid)
+    {
+        const std::string entry = leafEntry(key, rid);
+        std::vector<PathNode> path;
+        rootLatch.lockExclusive();
+        bool rootHeld = true;
+        try
+        {
+            PathNode top;
+            top.pageNo = root;
+            top.childIndex = 0;
+            bufMgr.readPage(&file, top.pageNo, top.page);
+            latchOf(top.pageNo).lockExclusive();
+            path.push_back(top);
+            for (;;)
+            {
+                char* node = path.back().page->data();
+                const bool leaf = headerOf(node).level == 0;
+                //a node that can take any entry a split below it would push up ends the changes;
+                //let go of everything above it
+                if (freeBytes(node) >= (leaf ? entry.size() + OFFSET_BYTES : MAX_INTERNAL_ENTRY))
+                {
+                    for (std::size_t i = 0; i + 1 < path.size(); i++)
+                    {
+                        latchOf(path[i].pageNo).unlockExclusive();
+                        bufMgr.unPinPage(&file, path[i].pageNo, false);
+                    }
+                    path.erase(path.begin(), path.end() - 1);
+                    if (rootHeld)
+                    {
+                        rootLatch.unlockExclusive();
+                        rootHeld = false;
+                    }
+                }
+                if (leaf)
+                {
+                    break;
+                }
+                //go right of a separator equal to the key, after the entries already there
+                path.back().childIndex = upperBound(node, key);
+                PathNode child;
+                child.pageNo = childAt(node, path.back().childIndex);
+                child.childIndex = 0;
+                bufMgr.readPage(&file, child.pageNo, child.page);
+                latchOf(child.pageNo).lockExclusive();
+                path.push_back(child);
+            }
+
+            std::size_t changed = path.size() - 1;
+            char* leafNode = path[changed].page->data();
+            const std::uint32_t position = upperBound(leafNode, key);
+            if (freeBytes(leafNode) >= entry.size() + OFFSET_BYTES)
+            {
+                insertEntry(leafNode, position, entry.data(), entry.size());
+            }
+            else
+            {
+                std::string separator;
+                PageId sibling;
+                splitNode(path[changed].page, position, entry, separator, sibling);
+                for (;;)
+                {
+                    if (changed == 0)
+                    {
+                        //only the root may be left unsafe at the top of the path
+                        assert(rootHeld && path[0].pageNo == root);
+                        Page* rootPage;
+                        const PageId newRoot = allocNode(headerOf(path[0].page->data()).level + 1, rootPage);
+                        headerOf(rootPage->data()).leftmost = root;
+                        const std::string rootEntry = internalEntry(separator, sibling);
+                        insertEntry(rootPage->data(), 0, rootEntry.data(), rootEntry.size());
+                        bufMgr.unPinPage(&file, newRoot, true);
+                        root = newRoot;
+                        height++;
+                        writeMeta();
+                        break;
+                    }
+                    changed--;
+                    //the new node goes right after the child that split
+                    const std::string parentEntry = internalEntry(separator, sibling);
+                    char* parent = path[changed].page->data();
+                    if (freeBytes(parent) >= parentEntry.size() + OFFSET_BYTES)
+                    {
+                        insertEntry(parent, path[changed].childIndex, parentEntry.data(), parentEntry.size());
+                        break;
+                    }
+                    splitNode(path[changed].page, path[changed].childIndex, parentEntry, separator, sibling);
+                }
+            }
+            releasePath(path, changed);
+        }
+        catch (...)
+        {
+            releasePath(path, 0);
+            if (rootHeld)
+            {
+                rootLatch.unlockExclusive();
+            }
+            throw;
+        }
+        if (rootHeld)
+        {
+            rootLatch.unlockExclusive();
+        }
+    }
+
+    /**
+     * Insert an entry into a full node, moving its upper half to a new right sibling
+     */
+    void BTreeIndex::splitNode(Page* page, const std::uint32_t position, const std::string& entry,
+                               std::string& separator, PageId& sibling)
+    {
+        char* node = page->data();
+        const NodeHeader header = headerOf(node);
+        const bool leaf = header.level == 0;
+        const std::vector<char> copy(node, node + Page::DATA_SIZE);
+        char* old = const_cast<char*>(&copy[0]);
+
+        //the entries in order with the new one among them, split half and half by bytes
+        std::vector<const char*> entries;
+        entries.reserve(header.count + 1);
+        std::size_t total = 0;
+        for (std::uint32_t i = 0; i <= header.count; i++)
+        {
+            if (i == position)
+            {
+                entries.push_back(entry.data());
+            }
+            if (i < header.count)
+            {
+                entries.push_back(entryAt(old, i));
+            }
+        }
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            total += entrySize(entries[i], leaf) + OFFSET_BYTES;
+        }
+        std::size_t middle = 0;
+        for (std::size_t bytes = 0; middle < entries.size() && bytes < total / 2; middle++)
+        {
+            bytes += entrySize(entries[middle], leaf) + OFFSET_BYTES;
+        }
+        //a leaf keeps at least one entry on each side; an internal node passes its middle
+        //entry up, and keeps one on each side of it
+        middle = std::max<std::size_t>(1, std::min(middle, entries.size() - (leaf ? 1 : 2)));
+
+        Page* siblingPage;
+        sibling = allocNode(header.level, siblingPage);
+        char* right = siblingPage->data();
+        initNode(node, header.level);
+        headerOf(node).leftmost = header.leftmost;
+        for (std::size_t i = 0; i < middle; i++)
+        {
+            insertEntry(node, i, entries[i], entrySize(entries[i], leaf));
+        }
+        separator = keyOf(entries[middle]);
+        std::size_t first = middle;
+        if (leaf)
+        {
+            headerOf(right).next = header.next;
+            headerOf(node).next = sibling;
+        }
+        else
+        {
+            PageId child;
+            std::memcpy(&child, entries[middle] + OFFSET_BYTES + keyLength(entries[middle]), sizeof(child));
+            headerOf(right).leftmost = child;
+            first = middle + 1;
+        }
+        for (std::size_t i = first; i < entries.size(); i++)
+        {
+            insertEntry(right, i - first, entries[i], entrySize(entries[i], leaf));
+        }
+        bufMgr.unPinPage(&file, sibling, true);
+    }
+
+    /**
+     * Pin a new, empty node of a level
+     */
+    PageId BTreeIndex::allocNode(const std::uint16_t level, Page*& page)
+    {
+        PageId pageNo;
+        bufMgr.allocPage(&file, pageNo, page);
+        initNode(page->data(), level);
+        return pageNo;
+    }
+
+    /**
+     * Write the root and height to page 1
+     */
+    void BTreeIndex::writeMeta()
+    {
+        IndexMeta contents;
+        contents.magic = META_MAGIC;
+        contents.keyType = keyType;
+        contents.root = root;
+        contents.height = height;
+        Page* meta;
+        bufMgr.readPage(&file, META_PAGE, meta);
+        std::memcpy(meta->data(), &contents, sizeof(contents));
+        bufMgr.unPinPage(&file, META_PAGE, true);
+    }
+
+}
@@ -0,0 +1,304 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "buffer.h"
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief Reader-writer latch of a B+tree node
+     */
+    class NodeLatch
+    {
+    public:
+        NodeLatch()
+        {
+            pthread_rwlock_init(&lock, NULL);
+        }
+
+        ~NodeLatch()
+        {
+            pthread_rwlock_destroy(&lock);
+        }
+
+        void lockShared()
+        {
+            pthread_rwlock_rdlock(&lock);
+        }
+
+        void unlockShared()
+        {
+            pthread_rwlock_unlock(&lock);
+        }
+
+        void lockExclusive()
+        {
+            pthread_rwlock_wrlock(&lock);
+        }
+
+        void unlockExclusive()
+        {
+            pthread_rwlock_unlock(&lock);
+        }
+
+    private:
+        NodeLatch(const NodeLatch&);
+        NodeLatch& operator=(const NodeLatch&);
+
+        pthread_rwlock_t lock;
+    };
+
+
+    /**
+     * @brief B+tree mapping keys to RecordIds, its nodes stored in the pages of a file and
+     * read and written through a buffer pool
+     *
+     * Keys are either 64-bit integers or byte strings of up to MAX_KEY_LENGTH bytes, fixed
+     * when the index is created.  Both are kept as byte strings compared with memcmp (shorter
+     * first on a tie); integers are stored big-endian with the sign bit flipped, so that
+     * their bytes sort as the numbers do.  A key may be inserted more than once.
+     *
+     * Page 1 of the file holds the root and height of the tree; every other page is a node.
+     * A node keeps an array of entry offsets, in key order, growing from its start, and the
+     * entries themselves packed from its end.  An entry of a leaf holds a key and a RecordId;
+     * one of an internal node holds a key and the child with the keys from it on, the keys
+     * below the first one being in the node's leftmost child.  Leaves are linked to their
+     * right siblings, which range scans follow.
+     *
+     * Any number of threads may look up, scan and insert at once.  Each node has a latch,
+     * and threads couple latches on the way down: readers take the child's latch shared
+     * before letting go of the parent's, and writers take theirs exclusive and keep the
+     * parents until they reach a node with room for whatever a split below could push up.
+     * Readers moving to a sibling leaf hold on to the one they leave until they have the
+     * next; writers never move left, so the two cannot deadlock.  The pool needs a few
+     * frames per thread for the pinned path.  bulkLoad() must not run alongside anything.
+     */
+    class BTreeIndex
+    {
+    public:
+        /**
+         * Kind of key of an index
+         */
+        enum KeyType
+        {
+            INTEGER_KEYS = 1,
+            BYTE_KEYS = 2
+        };
+
+        /**
+         * Longest byte key
+         */
+        static const std::uint32_t MAX_KEY_LENGTH = 1024;
+
+        /**
+         * Constructor of BTreeIndex class; opens the index in the file, or creates an empty
+         * one if the file is empty
+         *
+         * @param bufMgr		Pool the nodes are read and written through; must outlive the index
+         * @param file		File of the index; must outlive the index
+         * @param keyType		Kind of key of the index
+         * @throws  IndexException if the file holds something other than an index of this kind
+         */
+        BTreeIndex(BufMgr& bufMgr, File& file, const KeyType keyType);
+
+        /**
+         * Destructor of BTreeIndex class.  Changed nodes stay in the pool; flush the file to
+         * write them.
+         */
+        ~BTreeIndex();
+
+        /**
+         * Add an entry
+         *
+         * @param key		Key of the entry
+         * @param rid		Record the entry points at
+         * @throws  IndexException if the key is not of the index's kind, or too long
+         */
+        void insert(const std::int64_t key, const RecordId& rid);
+        void insert(const std::string& key, const RecordId& rid);
+
+        /**
+         * Find the first entry with a key
+         *
+         * @param key		Key to look up
+         * @param rid		Receives the record of the entry, if there is one
+         * @return 		True if there is an entry with the key
+         */
+        bool lookup(const std::int64_t key, RecordId& rid);
+        bool lookup(const std::string& key, RecordId& rid);
+
+        /**
+         * Collect the records of the entries with keys in a range, in key order
+         *
+         * @param low		Lowest key of the range
+         * @param high		Highest key of the range
+         * @param rids		The records are appended to this
+         * @return 		Number of entries found
+         */
+        std::uint32_t scan(const std::int64_t low, const std::int64_t high, std::vector<RecordId>& rids);
+        std::uint32_t scan(const std::string& low, const std::string& high, std::vector<RecordId>& rids);
+
+        /**
+         * Build the tree bottom-up from entries sorted by key, filling each node in turn
+         * rather than splitting.  Leaves end up next to each other in the file.
+         *
+         * @param entries		Entries in key order
+         * @param fill		Fraction of each node to fill, leaving the rest for later inserts
+         * @throws  IndexException if the index is not empty, or the entries are not sorted
+         */
+        void bulkLoad(const std::vector<std::pair<std::int64_t, RecordId> >& entries, const double fill = 1.0);
+        void bulkLoad(const std::vector<std::pair<std::string, RecordId> >& entries, const double fill = 1.0);
+
+        /**
+         * Kind of key of the index
+         */
+        KeyType getKeyType() const
+        {
+            return keyType;
+        }
+
+        /**
+         * Number of levels of the tree; 1 while the root is a leaf
+         */
+        std::uint32_t getHeight();
+
+        /**
+         * Bytes an integer key is stored as
+         */
+        static std::string encodeKey(const std::int64_t key);
+
+    private:
+        BTreeIndex(const BTreeIndex&);
+        BTreeIndex& operator=(const BTreeIndex&);
+
+        /**
+         * Node pinned and latched by a writer on its way down, with the position of the child
+         * it went on to
+         */
+        struct PathNode
+        {
+            PageId pageNo;
+            Page* page;
+            std::uint32_t childIndex;
+        };
+
+        /**
+         * Number of latches allocated at a time
+         */
+        static const std::uint32_t LATCH_CHUNK = 4096;
+
+        /**
+         * Most chunks of latches, which bounds the number of pages of an index
+         */
+        static const std::uint32_t LATCH_CHUNKS = 4096;
+
+        /**
+         * Latch of a node, allocating its chunk if need be
+         */
+        NodeLatch& latchOf(const PageId pageNo);
+
+        /**
+         * Throw IndexException unless a key is of the index's kind and not too long
+         */
+        void checkKey(const std::string& key, const KeyType expected) const;
+
+        /**
+         * Pin and latch the leaf where entries with a key start, shared
+         */
+        PageId findLeaf(const std::string& key, Page*& page);
+
+        /**
+         * Unlatch and unpin a node
+         */
+        void releaseShared(const PageId pageNo);
+
+        /**
+         * Unlatch and unpin the nodes of a writer's path, marking those from a position on dirty
+         */
+        void releasePath(std::vector<PathNode>& path, const std::size_t dirtyFrom);
+
+        /**
+         * Insert an encoded key
+         */
+        void insertKey(const std::string& key, const RecordId& rid);
+
+        /**
+         * Insert an entry into a full node, moving its upper half to a new right sibling
+         *
+         * @param node		Node to split, pinned and latched exclusive
+         * @param position		Position of the new entry among the node's
+         * @param entry		The new entry, key and value
+         * @param separator		Receives the key to add to the parent for the new node
+         * @param sibling		Receives the new node
+         */
+        void splitNode(Page* node, const std::uint32_t position, const std::string& entry,
+                       std::string& separator, PageId& sibling);
+
+        /**
+         * Pin a new, empty node of a level
+         */
+        PageId allocNode(const std::uint16_t level, Page*& page);
+
+        /**
+         * Write the root and height to page 1
+         */
+        void writeMeta();
+
+        /**
+         * Pool the nodes go through
+         */
+        BufMgr& bufMgr;
+
+        /**
+         * File of the index
+         */
+        File& file;
+
+        /**
+         * Kind of key of the index
+         */
+        const KeyType keyType;
+
+        /**
+         * Root node, guarded by rootLatch
+         */
+        PageId root;
+
+        /**
+         * Number of levels, guarded by rootLatch
+         */
+        std::uint32_t height;
+
+        /**
+         * Latch guarding root and height; held exclusive by a writer that may split the root
+         */
+        NodeLatch rootLatch;
+
+        /**
+         * Latches of the nodes, LATCH_CHUNK to a chunk, indexed by page number
+         */
+        std::atomic<NodeLatch*>* latchChunks;
+
+        /**
+         * Serializes allocating chunks of latches
+         */
+        std::mutex chunkLatch;
+    };
+
+}
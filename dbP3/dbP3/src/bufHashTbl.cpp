@@ -15,12 +15,9 @@
 
 namespace badgerdb {
 
-int BufHashTbl::hash(const File* file, const PageId pageNo)
+int BufHashTbl::hash(const PageKey key)
 {
-  int tmp, value;
-  tmp = (long)file;  // cast of pointer to the file object to an integer
-  value = (tmp + pageNo) % HTSIZE;
-  return value;
+  return (int) (hashPageKey(key) % HTSIZE);
 }
 
 BufHashTbl::BufHashTbl(int htSize)
@@ -47,12 +44,13 @@ BufHashTbl::~BufHashTbl()
 
 void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId frameNo)
 {
-  int index = hash(file, pageNo);
+  const PageKey key = makePageKey(file->id(), pageNo);
+  int index = hash(key);
 
   hashBucket* tmpBuc = ht[index];
   while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
-  		throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
+    if (tmpBuc->key == key)
+  		throw HashAlreadyPresentException(file->filename(), pageNo, tmpBuc->frameNo);
     tmpBuc = tmpBuc->next;
   }
 
@@ -60,8 +58,7 @@ void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId fra
   if (!tmpBuc)
   	throw HashTableException();
 
-  tmpBuc->file = (File*) file;
-  tmpBuc->pageNo = pageNo;
+  tmpBuc->key = key;
   tmpBuc->frameNo = frameNo;
   tmpBuc->next = ht[index];
   ht[index] = tmpBuc;
@@ -69,10 +66,11 @@ void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId fra
 
 void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo) 
 {
-  int index = hash(file, pageNo);
+  const PageKey key = makePageKey(file->id(), pageNo);
+  int index = hash(key);
   hashBucket* tmpBuc = ht[index];
   while (tmpBuc) {
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
+    if (tmpBuc->key == key)
     {
       frameNo = tmpBuc->frameNo; // return frameNo by reference
       return;
@@ -83,15 +81,37 @@ void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo)
   throw HashNotFoundException(file->filename(), pageNo);
 }
 
+bool BufHashTbl::probe(const File* file, const PageId pageNo, FrameId &frameNo)
+{
+  const PageKey key = makePageKey(file->id(), pageNo);
+  int index = hash(key);
+  hashBucket* tmpBuc = ht[index];
+  while (tmpBuc) {
+    if (tmpBuc->key == key)
+    {
+      frameNo = tmpBuc->frameNo;
+      return true;
+    }
+    tmpBuc = tmpBuc->next;
+  }
+  return false;
+}
+
+void BufHashTbl::prefetch(const File* file, const PageId pageNo)
+{
+  __builtin_prefetch(&ht[hash(makePageKey(file->id(), pageNo))]);
+}
+
 void BufHashTbl::remove(const File* file, const PageId pageNo) {
 
-  int index = hash(file, pageNo);
+  const PageKey key = makePageKey(file->id(), pageNo);
+  int index = hash(key);
   hashBucket* tmpBuc = ht[index];
   hashBucket* prevBuc = NULL;
 
   while (tmpBuc)
 	{
-    if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
+    if (tmpBuc->key == key)
 		{
       if(prevBuc) 
 				prevBuc->next = tmpBuc->next;
@@ -16,14 +16,9 @@ namespace badgerdb {
 */
 struct hashBucket {
 	/**
-	 * pointer a file object (more on this below)
+	 * file id and page number within the file, packed
 	 */
-	File *file;
-
-	/**
-	 * page number within a file
-	 */
-	PageId pageNo;
+	PageKey key;
 
 	/**
 	 * frame number of page in the buffer pool
@@ -40,6 +35,10 @@ struct hashBucket {
 /**
 * @brief Hash table class to keep track of pages in the buffer pool
 *
+* Pages are keyed by the id of their file rather than by the File object, so
+* every File object for the same file finds the same buffered pages, and each
+* key is compared as a single word.
+*
 * @warning This class is not threadsafe.
 */
 class BufHashTbl
@@ -55,13 +54,12 @@ class BufHashTbl
   hashBucket**  ht;
 
 	/**
-	 * returns hash value between 0 and HTSIZE-1 computed using file and pageNo
+	 * returns hash value between 0 and HTSIZE-1 computed using the packed file id and pageNo
 	 *
-	 * @param file   	File object
-	 * @param pageNo  Page number in the file
+	 * @param key   	File id and page number
 	 * @return  			Hash value.
 	 */
-  int	 hash(const File* file, const PageId pageNo);
+  int	 hash(const PageKey key);
 
  public:
 	/**
@@ -96,6 +94,26 @@ class BufHashTbl
 	 */
   void lookup(const File* file, const PageId pageNo, FrameId &frameNo);
 
+	/**
+   * Check if (file, pageNo) is currently in the buffer pool without throwing
+   * when it is not.
+	 *
+	 * @param file  	File object
+	 * @param pageNo	Page number in the file
+	 * @param frameNo Frame number reference, set only if the page is found
+   * @return  			True if the page entry is in the hash table
+	 */
+  bool probe(const File* file, const PageId pageNo, FrameId &frameNo);
+
+	/**
+   * Start pulling the slot (file, pageNo) hashes to into the cache, ahead of a
+   * later lookup or probe.
+	 *
+	 * @param file  	File object
+	 * @param pageNo	Page number in the file
+	 */
+  void prefetch(const File* file, const PageId pageNo);
+
 	/**
    * Delete entry (file,pageNo) from hash table.
 	 *
@@ -6,279 +6,1535 @@
  * edited by Brett Meyer 9067702986(bmeyer) and Alex Instefjord 906-376-7918 (instefjo)
  */
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
 #include <memory>
 #include <iostream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include "buffer.h"
+#include "log_manager.h"
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
 #include "exceptions/bad_buffer_exception.h"
+#include "exceptions/checksum_mismatch_exception.h"
+#include "exceptions/file_not_found_exception.h"
+#include "exceptions/invalid_page_exception.h"
 #include "exceptions/hash_not_found_exception.h"
 
 namespace badgerdb {
+    
+    thread_local const char* BufMgr::pinSite = NULL;
+    const FrameId BufMgr::NO_FRAME;
+    
     /**
      * Constructor of BufMgr class
      */
-    BufMgr::BufMgr(std::uint32_t bufs) : numBufs(bufs) {
-        bufDescTable = new BufDesc[bufs];
+    BufMgr::BufMgr(std::uint32_t bufs, const BufMgrOptions& options)
+    : numaPlacement(options.numaPlacement), replacement(options.replacement), log(options.log), tier(options.tier), evictionWait(options.evictionWaitMillis), evictionWaiters(0),
+      numBufs(bufs), maxBufs(options.maxFrames > bufs ? options.maxFrames : bufs), pinDiagnostics(false) {
+        if (options.numaAware)
+        {
+            numaTopology = NumaTopology::detect();
+        }
+        numPartitions = numaTopology.numNodes();
+        if (numPartitions > bufs && bufs > 0)
+        {
+            numPartitions = bufs;
+        }
         
-        for (FrameId i = 0; i < bufs; i++)
+        //per-frame bookkeeping is small next to the frames, so it covers the maximum size
+        bufDescTable = new BufDesc[maxBufs];
+        bufState = new std::uint32_t[maxBufs];
+        frameVersion = new std::atomic<std::uint64_t>[maxBufs];
+        frameEpoch = new std::atomic<std::uint32_t>[maxBufs];
+        
+        for (FrameId i = 0; i < maxBufs; i++)
         {
             bufDescTable[i].frameNo = i;
-            bufDescTable[i].valid = false;
+            bufState[i] = 0;
+            frameVersion[i].store(0);
+            frameEpoch[i].store(0);
         }
         
-        bufPool = new Page[bufs];
+        frameArena = new FrameArena(bufs, options.hugePages, maxBufs);
+        bufPool = frameArena->frames();
         
-        int htsize = ((((int) (bufs * 1.2))*2)/2)+1;
-        hashTable = new BufHashTbl (htsize);  // allocate the buffer hash table
+        //split frames and descriptors evenly over the nodes, each range bound to its node
+        partitions = new BufPartition[numPartitions];
+        FrameId first = 0;
+        for (std::uint32_t p = 0; p < numPartitions; p++)
+        {
+            const std::uint32_t count = bufs / numPartitions + (p < bufs % numPartitions ? 1 : 0);
+            partitions[p].firstFrame = first;
+            partitions[p].numFrames = count;
+            partitions[p].clockHand = first + count - 1;
+            numaTopology.bindMemory(&bufPool[first], count * sizeof(Page), p);
+            numaTopology.bindMemory(&bufDescTable[first], count * sizeof(BufDesc), p);
+            numaTopology.bindMemory(&bufState[first], count * sizeof(std::uint32_t), p);
+            first += count;
+        }
         
-        clockHand = bufs - 1;
+        hashTable = new BufHashTbl (hashTableSize(bufs));  // allocate the buffer hash table
     }
     /**
      * Destructor of BufMgr class
      */
     BufMgr::~BufMgr()
-    {   //clear, write, and remove from bufDescTable and hashTable
-        for (int i = 0; i < numBufs; i++)
+    {   //background flushes need the pool, so stop them first
+        for (std::size_t f = 0; f < asyncFlushes.size(); f++)
+        {
+            asyncFlushes[f]->cancelled = true;
+            asyncFlushes[f]->worker.join();
+        }
+        //clear, write, and remove from bufDescTable and hashTable
+        for (FrameId i = 0; i < numBufs; i++)
         {
-            if (!bufDescTable[clockHand].valid) {
-                bufDescTable[clockHand].Clear();
+            if (!BufState::valid(bufState[i])) {
+                clearFrame(i);
                 continue;
             }
-            if (bufDescTable[clockHand].dirty) {
-                bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
+            if (BufState::dirty(bufState[i])) {
+                writeBack(i);
             }
-            hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
-            bufDescTable[clockHand].Clear();
+            hashTable->remove(bufDescTable[i].file, bufDescTable[i].pageNo());
+            clearFrame(i);
         }
         //delete vars
-        delete[] bufPool;
+        delete frameArena;
         delete[] bufDescTable;
+        delete[] bufState;
+        delete[] frameVersion;
+        delete[] frameEpoch;
+        delete[] partitions;
         delete hashTable;
     }
     /**
-     * Advance clock to next frame in the buffer pool
+     * Advance the partition's clock to its next frame
      */
-    void BufMgr::advanceClock()
+    void BufMgr::advanceClock(BufPartition & partition)
     {
-        clockHand = (clockHand + 1) % numBufs;
+        partition.clockHand = partition.firstFrame
+            + (partition.clockHand - partition.firstFrame + 1) % partition.numFrames;
     }
     /**
-     * Allocate a free frame.
+     * Allocate a free frame, sweeping the given partition first and the others only if it is fully pinned.
      *
      * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+     * @param home    	Partition the frame should preferably come from
      * @throws BufferExceededException If no such buffer is found which can be allocated
      */
-    void BufMgr::allocBuf(FrameId & frame)
+    bool BufMgr::allocBuf(FrameId & frame, std::uint32_t home)
+    {
+        if (sweepPartitions(frame, home))
+        {
+            return false;
+        }
+        if (evictionWait.count() > 0)
+        {
+            //give up the latch until a frame is unpinned, then sweep again
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            const std::chrono::steady_clock::time_point deadline = start + evictionWait;
+            bool found = false;
+            evictionWaiters++;
+            while (!found)
+            {
+                const bool timedOut = frameFreed.wait_until(bufLatch, deadline) == std::cv_status::timeout;
+                found = sweepPartitions(frame, home);
+                if (timedOut)
+                {
+                    break;
+                }
+            }
+            evictionWaiters--;
+            
+            const std::uint64_t waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            waitStats.waits++;
+            waitStats.totalWaitMicros += waited;
+            if (waited > waitStats.maxWaitMicros)
+            {
+                waitStats.maxWaitMicros = waited;
+            }
+            if (found)
+            {
+                return true;
+            }
+            waitStats.timeouts++;
+        }
+        //if all pages are pinned throw excepton
+        if (pinDiagnostics)
+            pinStats.exceeded++;
+        throw BufferExceededException();
+    }
+    /**
+     * Sweep the given partition, then the others, for a frame to reuse.
+     *
+     * @param frame   	Frame ID of the freed frame returned via this variable
+     * @param home    	Partition to sweep first
+     * @return 		True if a frame was freed, false if every frame is pinned
+     */
+    bool BufMgr::sweepPartitions(FrameId & frame, std::uint32_t home)
+    {
+        for (std::uint32_t i = 0; i < numPartitions; i++)
+        {
+            if (sweepPartition(partitions[(home + i) % numPartitions], frame))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+    /**
+     * Run the clock over one partition looking for a frame to reuse.
+     *
+     * @param partition	Partition to sweep
+     * @param frame   	Frame ID of the freed frame returned via this variable
+     * @return 		True if a frame was freed, false if every frame of the partition is pinned
+     */
+    bool BufMgr::sweepPartition(BufPartition & partition, FrameId & frame)
     {
-        //variables
-        bool frameFreed = false;
-        int countPinned = 0;
-        // the frame hasn't been set and not all frames are pinned
-        while(frameFreed == false && countPinned < numBufs)
+        //two full turns of the clock: the first may only clear reference bits
+        const std::uint32_t limit = 2 * partition.numFrames;
+        std::uint32_t visited = 0;
+        if (pinDiagnostics)
+            pinStats.sweeps++;
+        while(visited < limit)
         {
-            BufMgr::advanceClock();
+            if (skipUnevictable(partition, visited, limit))
+            {
+                continue;
+            }
+            advanceClock(partition);
+            visited++;
+            const FrameId hand = partition.clockHand;
+            const std::uint32_t state = bufState[hand];
             //Valid bit
-            if (bufDescTable[clockHand].valid)
+            if (BufState::valid(state))
             {
-                //Ref bit
-                if (bufDescTable[clockHand].refbit == true)
+                //Ref bit, which FIFO replacement ignores
+                if (BufState::refbit(state) && replacement == REPLACE_CLOCK)
                 {
-                    bufDescTable[clockHand].refbit = false;
+                    bufState[hand] = state & ~BufState::REF;
                 }
                 else
                 {
-                    //pinned
-                    if (bufDescTable[clockHand].pinCnt != 0)
+                    //pinned frames are passed over
+                    if (BufState::pinCnt(state) != 0)
                     {
-                        countPinned++;
+                        if (pinDiagnostics)
+                            pinStats.pinnedSkips++;
                     }
                     else
                     {
                         //dirty bit
-                        if (bufDescTable[clockHand].dirty == true)
+                        if (BufState::dirty(state))
                         {
                             //flush page to disk
-                            bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
-                            bufDescTable[clockHand].dirty = false;
+                            writeBack(hand);
+                        }
+                        //the page is clean now; keep a copy in the second-level cache
+                        if (tier != NULL)
+                        {
+                            tier->put(bufDescTable[hand].key, bufPool[hand]);
                         }
                         //dealloc
-                        hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
-                        bufDescTable[clockHand].Clear();
-                        frameFreed = true;
-                        frame = clockHand;
-                        return;
+                        hashTable->remove(bufDescTable[hand].file, bufDescTable[hand].pageNo());
+                        clearFrame(hand);
+                        frame = hand;
+                        return true;
                     }
                 }
             }
             else
             {
                 //dealloc
-                bufDescTable[clockHand].Clear();
-                frameFreed = true;
-                frame = clockHand;
-                return;
+                clearFrame(hand);
+                frame = hand;
+                return true;
             }
         }
-        //if all pages are pinned throw excepton
-        if(countPinned >= numBufs && frameFreed == false)
+        return false;
+    }
+    /**
+     * Let the clock pass over four consecutive frames at once when none of them can be
+     * evicted, clearing their reference bits.
+     *
+     * @param partition	Partition being swept; its clock hand is advanced past the skipped frames
+     * @param visited	Number of frames the sweep has passed so far, updated
+     * @param limit   	Number of frames after which the sweep gives up
+     * @return 		True if frames were skipped, false if the next frames must be examined one by one
+     */
+    bool BufMgr::skipUnevictable(BufPartition & partition, std::uint32_t & visited, std::uint32_t limit)
+    {
+#ifdef __SSE2__
+        const FrameId next = partition.clockHand + 1;
+        //only whole groups that neither wrap around nor run past the limit
+        if (next + 4 > partition.firstFrame + partition.numFrames || visited + 4 > limit)
         {
-            throw BufferExceededException();
+            return false;
+        }
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i states = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&bufState[next]));
+        const __m128i invalid = _mm_cmpeq_epi32(_mm_and_si128(states, _mm_set1_epi32(BufState::VALID)), zero);
+        const __m128i unreferenced = replacement == REPLACE_FIFO ? _mm_set1_epi32(-1) :
+            _mm_cmpeq_epi32(_mm_and_si128(states, _mm_set1_epi32(BufState::REF)), zero);
+        const __m128i unpinned = _mm_cmpeq_epi32(_mm_and_si128(states, _mm_set1_epi32(BufState::PIN_MASK)), zero);
+        const __m128i victims = _mm_or_si128(invalid, _mm_and_si128(unreferenced, unpinned));
+        if (_mm_movemask_ps(_mm_castsi128_ps(victims)) != 0)
+        {
+            return false;
         }
+        //every frame is valid and either referenced (loses its bit) or unreferenced and pinned
+        if (pinDiagnostics)
+            pinStats.pinnedSkips += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(unreferenced)));
+        visited += 4;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&bufState[next]),
+                         _mm_andnot_si128(_mm_set1_epi32(BufState::REF), states));
+        partition.clockHand = next + 3;
+        return true;
+#else
+        return false;
+#endif
     }
     /**
-     * Reads the given page from the file into a frame and returns the pointer to page.
-     * If the requested page is already present in the buffer pool pointer to that frame is returned
-     * otherwise a new frame is allocated from the buffer pool for reading the page.
+     * Write the (file name, page number) of every buffered page to a file.
      *
-     * @param file   	File object
-     * @param PageNo  Page number in the file to be read
-     * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+     * @param path		File to write the resident set to; replaced if it exists
+     * @return 		Number of pages written
+     * @throws  FileNotFoundException If the file cannot be created
      */
-    void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
+    std::uint32_t BufMgr::dumpResidentSet(const std::string& path)
     {
-        try {
-            hashTable->lookup(file, pageNo, clockHand);
-            //look up was successful
-            bufDescTable[clockHand].refbit = true;
-            bufDescTable[clockHand].pinCnt = bufDescTable[clockHand].pinCnt + 1;
-            page = &bufPool[clockHand];
-            
-        } catch (HashNotFoundException e) {
-            //look up was unsucessful
-            allocBuf(clockHand);
-            Page p = file->readPage(pageNo);
-            bufPool[clockHand] = p;
-            hashTable->insert(file,p.page_number(),clockHand);
-            bufDescTable[clockHand].Set(file, p.page_number());
-            page = &bufPool[clockHand];
+        std::vector<std::pair<std::string, PageId> > resident;
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            for (FrameId i = 0; i < numBufs; i++)
+            {
+                if (BufState::valid(bufState[i]))
+                {
+                    resident.push_back(std::make_pair(bufDescTable[i].file->filename(), bufDescTable[i].pageNo()));
+                }
+            }
+        }
+        std::sort(resident.begin(), resident.end());
+        
+        std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc);
+        if (!out)
+        {
+            throw FileNotFoundException(path);
+        }
+        //one "pageNo filename" line per page; the name runs to the end of the line
+        for (std::size_t r = 0; r < resident.size(); r++)
+        {
+            out << resident[r].second << ' ' << resident[r].first << '\n';
+        }
+        out.flush();
+        if (!out)
+        {
+            throw FileNotFoundException(path);
+        }
+        return (std::uint32_t) resident.size();
+    }
+    
+    /**
+     * Bring the pages listed by dumpResidentSet() back into the pool.
+     *
+     * @param path		File written by dumpResidentSet(); a missing file loads nothing
+     * @param files		Open files whose pages may be loaded, matched by file name
+     * @param batchPages	Number of pages read per batch
+     * @return 		Number of pages loaded
+     */
+    std::uint32_t BufMgr::warmUp(const std::string& path, const std::vector<File*>& files,
+                                 const std::uint32_t batchPages)
+    {
+        std::ifstream in(path.c_str());
+        std::map<std::string, std::vector<PageId> > pagesOf;
+        for (std::size_t f = 0; f < files.size(); f++)
+        {
+            pagesOf[files[f]->filename()];
+        }
+        PageId pageNo;
+        std::string filename;
+        while (in >> pageNo && in.get() == ' ' && std::getline(in, filename))
+        {
+            std::map<std::string, std::vector<PageId> >::iterator found = pagesOf.find(filename);
+            if (found != pagesOf.end())
+            {
+                found->second.push_back(pageNo);
+            }
+        }
+        
+        std::uint32_t loaded = 0;
+        for (std::size_t f = 0; f < files.size(); f++)
+        {
+            std::vector<PageId>& pageNos = pagesOf[files[f]->filename()];
+            std::sort(pageNos.begin(), pageNos.end());
+            pageNos.erase(std::unique(pageNos.begin(), pageNos.end()), pageNos.end());
             
+            for (std::size_t start = 0; start < pageNos.size(); start += batchPages)
+            {
+                std::lock_guard<std::mutex> guard(bufLatch);
+                if (loaded >= numBufs)
+                {
+                    return loaded;
+                }
+                //never evict pages this warm-up brought in
+                std::vector<PageId> batch;
+                for (std::size_t p = start; p < pageNos.size() && p < start + batchPages &&
+                     loaded + batch.size() < numBufs; p++)
+                {
+                    FrameId frameNo;
+                    if (!hashTable->probe(files[f], pageNos[p], frameNo))
+                    {
+                        batch.push_back(pageNos[p]);
+                    }
+                }
+                try
+                {
+                    loaded += loadUnpinned(files[f], batch);
+                }
+                catch (BufferExceededException&)
+                {
+                    //every frame is pinned; the pool is as warm as it gets
+                    return loaded;
+                }
+            }
         }
+        return loaded;
     }
     
     /**
-     * Unpin a page from memory since it is no longer required for it to remain in memory.
+     * Load one batch of warmUp() pages into unpinned frames.  The latch must be held.
      *
      * @param file   	File object
-     * @param PageNo  Page number
-     * @param dirty		True if the page to be unpinned needs to be marked dirty
-     * @throws  PageNotPinnedException If the page is not already pinned
+     * @param pageNos	Pages to load, in increasing order, none of them buffered
+     * @return 		Number of pages loaded
      */
-
-    void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty)
+    std::uint32_t BufMgr::loadUnpinned(File* file, const std::vector<PageId>& pageNos)
     {
+        std::vector<Page> pages;
+        std::vector<PageId> present;
         try
         {
-            hashTable->lookup(file,pageNo,clockHand);
-            if (bufDescTable[clockHand].pinCnt > 0)
+            file->readPages(pageNos, pages);
+            present = pageNos;
+        }
+        catch (InvalidPageException&)
+        {
+            //some pages were deleted since the dump; read the rest one by one
+            pages.clear();
+            for (std::size_t p = 0; p < pageNos.size(); p++)
             {
-                bufDescTable[clockHand].pinCnt = bufDescTable[clockHand].pinCnt - 1;
-                if (dirty == true)
+                try
+                {
+                    pages.push_back(file->readPage(pageNos[p]));
+                    present.push_back(pageNos[p]);
+                }
+                catch (InvalidPageException&)
                 {
-                    bufDescTable[clockHand].dirty = true;
                 }
             }
-            else
+        }
+        bufStats.diskreads += present.size();
+        
+        std::uint32_t count = 0;
+        for (std::size_t p = 0; p < present.size(); p++)
+        {
+            FrameId frameNo;
+            if (allocBuf(frameNo, partitionFor(file, present[p])))
+            {
+                //the latch was given up while waiting for a frame, so this page and the rest of the
+                //batch may have been changed on disk or brought in since they were read; warm-up is
+                //only a hint, so leave them for readers
+                break;
+            }
+            if (file->checksums() && !pages[p].verifyChecksum())
             {
-                throw PageNotPinnedException(bufDescTable[clockHand].file->filename(), pageNo, clockHand);
+                //warm-up is only a hint; a damaged page is left for a reader to report
+                continue;
             }
+            bufPool[frameNo] = pages[p];
+            hashTable->insert(file, present[p], frameNo);
+            setFrame(frameNo, file, present[p]);
+            unpinFrame(frameNo, false);
+            count++;
         }
-        catch (HashNotFoundException e)
+        return count;
+    }
+    
+    /**
+     * Grow or shrink the buffer pool while it is in use.
+     *
+     * @param newFrames	New number of frames
+     * @throws  BufferExceededException If newFrames is above the maximum the pool was created with
+     * @throws  PagePinnedException If a frame being removed is pinned; the pool is left unchanged
+     */
+    void BufMgr::resize(const std::uint32_t newFrames)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        if (newFrames > maxBufs)
         {
-            //DO NOTHING
-            //std::cout << "HashNotFoundException() in BufMgr::unPinPage()";
+            throw BufferExceededException();
+        }
+        //check every frame being removed before touching any of them
+        for (FrameId i = newFrames; i < numBufs; i++)
+        {
+            if (BufState::pinCnt(bufState[i]) > 0)
+            {
+                throw PagePinnedException(bufDescTable[i].file->filename(), bufDescTable[i].pageNo(), i);
+            }
+        }
+        for (FrameId i = newFrames; i < numBufs; i++)
+        {
+            if (!BufState::valid(bufState[i]))
+            {
+                continue;
+            }
+            if (BufState::dirty(bufState[i]))
+            {
+                writeBack(i);
+            }
+            hashTable->remove(bufDescTable[i].file, bufDescTable[i].pageNo());
+            clearFrame(i);
+        }
+        
+        const std::uint32_t oldFrames = numBufs;
+        frameArena->resize(newFrames);
+        numBufs = newFrames;
+        fitPartitions(oldFrames);
+        
+        //rehash what is still buffered into a table sized for the new pool
+        BufHashTbl* resized = new BufHashTbl(hashTableSize(newFrames));
+        for (FrameId i = 0; i < numBufs; i++)
+        {
+            if (BufState::valid(bufState[i]))
+            {
+                resized->insert(bufDescTable[i].file, bufDescTable[i].pageNo(), i);
+            }
         }
+        delete hashTable;
+        hashTable = resized;
+        notifyFrameFreed();
     }
+    
     /**
-     * Writes out all dirty pages of the file to disk.
-     * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-     * Otherwise Error returned.
+     * Fit the partitions to the current number of frames after a resize.
      *
-     * @param file   	File object
-     * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
-     * @throws BadBufferException If any frame allocated to the file is found to be invalid
+     * @param oldFrames	Number of frames before the resize
      */
-    void BufMgr::flushFile(const File* file)
+    void BufMgr::fitPartitions(std::uint32_t oldFrames)
     {
-        //interate through bufdesctable
-        for (int i = 0; i < numBufs; i++)
+        for (std::uint32_t p = 0; p < numPartitions; p++)
         {
-            //file was found in bufdesctable
-            if (bufDescTable[i].file->filename() == file->filename())
+            BufPartition& partition = partitions[p];
+            const FrameId end = p + 1 < numPartitions ?
+                std::min(partitions[p + 1].firstFrame, numBufs) : numBufs;
+            partition.numFrames = end > partition.firstFrame ? end - partition.firstFrame : 0;
+            if (partition.numFrames > 0 &&
+                partition.clockHand >= partition.firstFrame + partition.numFrames)
             {
-                //pinned
-                if (bufDescTable[i].pinCnt > 0)
-                {
-                    throw PagePinnedException(bufDescTable[i].file->filename(), bufDescTable[i].pageNo, bufDescTable[i].frameNo);
-                }
-                //invalid
-                else if (bufDescTable[i].valid == false)
-                {
-                    throw BadBufferException(bufDescTable[i].frameNo, bufDescTable[i].dirty, bufDescTable[i].valid, bufDescTable[i].refbit);
-                }
-                else
-                {
-                    //bit is dirty
-                    if (bufDescTable[i].dirty == true)
-                    {
-                        //flush page to disk
-                        bufDescTable[i].file->writePage(bufPool[i]);
-                        bufDescTable[i].dirty = false;
-                    }
-                    //remove frame from hashtable
-                    hashTable->remove(bufDescTable[i].file, bufDescTable[i].pageNo);
-                    bufDescTable[i].Clear();
-                }
+                partition.clockHand = partition.firstFrame + partition.numFrames - 1;
+            }
+            //frames added to the partition live on its node
+            const FrameId added = std::max(partition.firstFrame, oldFrames);
+            if (end > added)
+            {
+                numaTopology.bindMemory(&bufPool[added], (end - added) * sizeof(Page), p);
             }
         }
     }
+    
     /**
-     * Allocates a new, empty page in the file and returns the Page object.
-     * The newly allocated page is also assigned a frame in the buffer pool.
+     * Partition a page that is not yet buffered should be placed in
      *
      * @param file   	File object
-     * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
-     * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+     * @param pageNo  Page number in the file
      */
-    void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page)
+    std::uint32_t BufMgr::partitionFor(const File* file, const PageId pageNo) const
     {
-        Page p = file->allocatePage(); //returns the allocated page
-        pageNo = p.page_number();
-        BufMgr::allocBuf(clockHand); //returns frameId -> clockHand
-        bufPool[clockHand] = p;
-        hashTable->insert(file, pageNo, clockHand);
-        bufDescTable[clockHand].Set(file, pageNo);
-        page = &bufPool[clockHand];
+        if (numPartitions == 1)
+        {
+            return 0;
+        }
+        if (numaPlacement == PLACE_BY_HASH)
+        {
+            //the same key the hash table uses, so placement does not depend on where the File object lives
+            return hashPageKey(makePageKey(file->id(), pageNo)) % numPartitions;
+        }
+        return numaTopology.currentNode() % numPartitions;
+    }
+    /**
+     * Reads the given page from the file into a frame and returns the pointer to page.
+     * If the requested page is already present in the buffer pool pointer to that frame is returned
+     * otherwise a new frame is allocated from the buffer pool for reading the page.
+     *
+     * @param file   	File object
+     * @param PageNo  Page number in the file to be read
+     * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+     */
+    void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        page = &bufPool[fetchFrame(file, pageNo)];
     }
     
     /**
-     * Delete page from file and also from buffer pool if present.
-     * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+     * Reads the given page from the file into a frame and returns a guard holding the pin.
+     * The page is unpinned, clean, when the guard is destroyed.
      *
      * @param file   	File object
-     * @param PageNo  Page number
+     * @param pageNo  Page number in the file to be read
+     * @return 		Guard giving read-only access to the page
      */
-
-    void BufMgr::disposePage(File* file, const PageId PageNo)
+    ReadPageGuard BufMgr::readPageGuard(File* file, const PageId pageNo)
     {
-        try
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const FrameId frameNo = fetchFrame(file, pageNo);
+        return ReadPageGuard(this, frameNo, &bufPool[frameNo]);
+    }
+    
+    /**
+     * Reads the given page from the file into a frame and returns a guard holding the pin.
+     * The page is unpinned and marked dirty when the guard is destroyed.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number in the file to be read
+     * @return 		Guard giving writable access to the page
+     */
+    WritePageGuard BufMgr::writePageGuard(File* file, const PageId pageNo)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const FrameId frameNo = fetchFrame(file, pageNo);
+        return WritePageGuard(this, frameNo, &bufPool[frameNo]);
+    }
+    
+    /**
+     * Reads the page a PageRef refers to, going straight to the frame the reference remembers
+     * while the page is still in it and through the hash table (re-swizzling the reference)
+     * otherwise.
+     *
+     * @param ref   	Reference to the page; updated to the frame now holding it
+     * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+     */
+    void BufMgr::readPage(PageRef& ref, Page*& page)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        if (ref.frameNo != PageRef::UNSWIZZLED &&
+            frameEpoch[ref.frameNo].load(std::memory_order_relaxed) == ref.epoch)
+        {
+            pinFrame(ref.frameNo);
+            bufStats.accesses++;
+        }
+        else
+        {
+            ref.frameNo = fetchFrame(ref.file, ref.pageNo);
+            ref.epoch = frameEpoch[ref.frameNo].load(std::memory_order_relaxed);
+        }
+        page = &bufPool[ref.frameNo];
+    }
+    
+    /**
+     * Pin a page, reading it into a frame if it is not buffered.  The latch must be held.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number in the file
+     * @return 		Frame holding the page
+     */
+    FrameId BufMgr::fetchFrame(File* file, const PageId pageNo)
+    {
+        FrameId frameNo;
+        bufStats.accesses++;
+        try {
+            hashTable->lookup(file, pageNo, frameNo);
+            //look up was successful
+            pinFrame(frameNo);
+            
+        } catch (HashNotFoundException e) {
+            //look up was unsucessful
+            if (allocBuf(frameNo, partitionFor(file, pageNo)) && hashTable->probe(file, pageNo, frameNo))
+            {
+                //another thread brought the page in while this one waited for a frame
+                pinFrame(frameNo);
+                return frameNo;
+            }
+            if (tier == NULL || !tier->take(makePageKey(file->id(), pageNo), bufPool[frameNo]))
+            {
+                Page p = file->readPage(pageNo);
+                bufStats.diskreads++;
+                verifyPage(file, p);
+                bufPool[frameNo] = p;
+            }
+            hashTable->insert(file, pageNo, frameNo);
+            setFrame(frameNo, file, pageNo);
+            
+        }
+        return frameNo;
+    }
+    
+    /**
+     * Bring in pages not in the pool, from the second-level cache or else the file.  The
+     * latch must be held.
+     *
+     * @param file   	File object
+     * @param pageNos	Pages to bring in, in increasing order, none of them buffered
+     * @param pages  	Receives the pages, in the order of pageNos
+     */
+    void BufMgr::readMisses(File* file, const std::vector<PageId>& pageNos, std::vector<Page>& pages)
+    {
+        if (tier == NULL)
         {
-            hashTable->lookup(file,PageNo,clockHand);
-            if (!bufDescTable[clockHand].valid) {
-                bufDescTable[clockHand].Clear();
+            file->readPages(pageNos, pages);
+            bufStats.diskreads += pages.size();
+            for (std::size_t p = 0; p < pages.size(); p++)
+            {
+                verifyPage(file, pages[p]);
             }
-            if (bufDescTable[clockHand].dirty) {
-                bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
+            return;
+        }
+        pages.resize(pageNos.size());
+        std::vector<PageId> diskPageNos;
+        std::vector<std::size_t> diskSlots;
+        for (std::size_t p = 0; p < pageNos.size(); p++)
+        {
+            if (!tier->take(makePageKey(file->id(), pageNos[p]), pages[p]))
+            {
+                diskPageNos.push_back(pageNos[p]);
+                diskSlots.push_back(p);
             }
-            hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
-            bufDescTable[clockHand].Clear();
-            file->deletePage(PageNo);
         }
-        catch (HashNotFoundException e)
+        std::vector<Page> fromDisk;
+        file->readPages(diskPageNos, fromDisk);
+        bufStats.diskreads += fromDisk.size();
+        for (std::size_t d = 0; d < fromDisk.size(); d++)
         {
-            //do nothing
+            verifyPage(file, fromDisk[d]);
+            pages[diskSlots[d]] = fromDisk[d];
+        }
+    }
+    
+    /**
+     * Check a page just read from disk against its checksum, if its file checksums pages
+     *
+     * @param file   	File object the page was read from
+     * @param page		Page as read
+     * @throws  ChecksumMismatchException If the page does not match its checksum
+     */
+    void BufMgr::verifyPage(const File* file, const Page& page)
+    {
+        if (file->checksums() && !page.verifyChecksum())
+        {
+            throw ChecksumMismatchException(page.page_number(), file->filename());
+        }
+    }
+    
+    /**
+     * Reads several pages of one file into frames and returns pointers to them, as readPage would
+     * for each page in turn.
+     *
+     * @param file   	File object
+     * @param pageNos	Page numbers in the file to be read; a page may appear more than once
+     * @param pages  	Receives a pointer to the frame of each page, in the order of pageNos
+     * @throws InvalidPageException If any page doesn't exist in the file
+     * @throws BufferExceededException If there are not enough unpinned frames for the pages not yet buffered
+     */
+    void BufMgr::readPages(File* file, const std::vector<PageId>& pageNos, std::vector<Page*>& pages)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const std::size_t count = pageNos.size();
+        pages.assign(count, NULL);
+        bufStats.accesses += count;
+        
+        //issue every hash probe's memory access before the first probe needs it
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashTable->prefetch(file, pageNos[i]);
+        }
+        
+        //pin the pages that are already buffered, collect the rest
+        std::vector<std::size_t> misses;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            FrameId frameNo;
+            if (hashTable->probe(file, pageNos[i], frameNo))
+            {
+                pinFrame(frameNo);
+                pages[i] = &bufPool[frameNo];
+            }
+            else
+            {
+                misses.push_back(i);
+            }
+        }
+        if (misses.empty())
+        {
+            return;
+        }
+        
+        //read the missing pages in page order, each distinct page once
+        std::vector<PageId> missPageNos;
+        for (std::size_t m = 0; m < misses.size(); m++)
+        {
+            missPageNos.push_back(pageNos[misses[m]]);
+        }
+        std::sort(missPageNos.begin(), missPageNos.end());
+        missPageNos.erase(std::unique(missPageNos.begin(), missPageNos.end()), missPageNos.end());
+        
+        std::vector<Page> loaded;
+        std::vector<FrameId> loadedFrames;
+        std::vector<bool> loadedHere;
+        try
+        {
+            readMisses(file, missPageNos, loaded);
+            bool waited = false;
+            for (std::size_t l = 0; l < loaded.size(); l++)
+            {
+                FrameId frameNo;
+                if (allocBuf(frameNo, partitionFor(file, missPageNos[l])))
+                {
+                    waited = true;
+                }
+                if (waited)
+                {
+                    //the latch was given up while waiting for a frame, here or for an earlier page
+                    if (hashTable->probe(file, missPageNos[l], frameNo))
+                    {
+                        //another thread brought the page in meanwhile
+                        pinFrame(frameNo);
+                        loadedFrames.push_back(frameNo);
+                        loadedHere.push_back(false);
+                        continue;
+                    }
+                    //or changed it and wrote it back; the copy read before the wait may be stale
+                    std::vector<Page> fresh;
+                    readMisses(file, std::vector<PageId>(1, missPageNos[l]), fresh);
+                    loaded[l] = fresh[0];
+                }
+                bufPool[frameNo] = loaded[l];
+                hashTable->insert(file, missPageNos[l], frameNo);
+                setFrame(frameNo, file, missPageNos[l]);
+                loadedFrames.push_back(frameNo);
+                loadedHere.push_back(true);
+            }
+        }
+        catch (...)
+        {
+            //give back everything this batch pinned or brought in
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (pages[i] != NULL)
+                {
+                    unpinFrame(pages[i] - bufPool, false);
+                }
+            }
+            for (std::size_t l = 0; l < loadedFrames.size(); l++)
+            {
+                if (!loadedHere[l])
+                {
+                    unpinFrame(loadedFrames[l], false);
+                    continue;
+                }
+                hashTable->remove(file, missPageNos[l]);
+                clearFrame(loadedFrames[l]);
+            }
+            pages.assign(count, NULL);
+            throw;
+        }
+        
+        //hand out the loaded frames; the first request of a page owns the pin setFrame took
+        std::vector<bool> claimed(loadedFrames.size(), false);
+        for (std::size_t m = 0; m < misses.size(); m++)
+        {
+            const std::size_t l = std::lower_bound(missPageNos.begin(), missPageNos.end(), pageNos[misses[m]])
+                - missPageNos.begin();
+            if (claimed[l])
+            {
+                pinFrame(loadedFrames[l]);
+            }
+            claimed[l] = true;
+            pages[misses[m]] = &bufPool[loadedFrames[l]];
+        }
+    }
+    
+    /**
+     * Unpin several pages of one file, as unPinPage would for each page in turn, under a single
+     * acquisition of the latch.
+     *
+     * @param file   	File object
+     * @param pageNos	Page numbers to unpin
+     * @param dirty		True if the pages need to be marked dirty
+     * @throws  PageNotPinnedException If a page is not pinned; the pages before it have been unpinned
+     */
+    void BufMgr::unPinPages(File* file, const std::vector<PageId>& pageNos, const bool dirty)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const std::size_t count = pageNos.size();
+        for (std::size_t i = 0; i < count; i++)
+        {
+            hashTable->prefetch(file, pageNos[i]);
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            FrameId frameNo;
+            if (!hashTable->probe(file, pageNos[i], frameNo))
+            {
+                continue;
+            }
+            if (BufState::pinCnt(bufState[frameNo]) == 0)
+            {
+                throw PageNotPinnedException(file->filename(), pageNos[i], frameNo);
+            }
+            unpinFrame(frameNo, dirty);
+        }
+    }
+    
+    /**
+     * Start an optimistic read of a buffered page: the page is neither pinned nor brought in.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number in the file
+     * @param read   	Receives the frame, its version and the page when the read can go ahead
+     * @return 		False if the page is not buffered or is pinned; the caller should use readPage instead
+     */
+    bool BufMgr::tryReadOptimistic(File* file, const PageId pageNo, PageVersion& read)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        FrameId frameNo;
+        if (!hashTable->probe(file, pageNo, frameNo))
+        {
+            return false;
+        }
+        const std::uint64_t version = frameVersion[frameNo].load(std::memory_order_acquire);
+        if (version & 1)
+        {
+            return false;
+        }
+        read.frameNo = frameNo;
+        read.version = version;
+        read.page = &bufPool[frameNo];
+        return true;
+    }
+    
+    /**
+     * Unpin a page from memory since it is no longer required for it to remain in memory.
+     *
+     * @param file   	File object
+     * @param PageNo  Page number
+     * @param dirty		True if the page to be unpinned needs to be marked dirty
+     * @throws  PageNotPinnedException If the page is not already pinned
+     */
+
+    void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        releasePage(file, pageNo, dirty);
+    }
+    
+    /**
+     * Unpin the page a PageRef refers to, skipping the hash table while the reference is swizzled.
+     *
+     * @param ref   	Reference to the page
+     * @param dirty		True if the page to be unpinned needs to be marked dirty
+     * @throws  PageNotPinnedException If the page is not already pinned
+     */
+    void BufMgr::unPinPage(PageRef& ref, const bool dirty)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        if (ref.frameNo == PageRef::UNSWIZZLED ||
+            frameEpoch[ref.frameNo].load(std::memory_order_relaxed) != ref.epoch)
+        {
+            ref.frameNo = PageRef::UNSWIZZLED;
+            releasePage(ref.file, ref.pageNo, dirty);
+            return;
+        }
+        if (BufState::pinCnt(bufState[ref.frameNo]) == 0)
+        {
+            throw PageNotPinnedException(ref.file->filename(), ref.pageNo, ref.frameNo);
+        }
+        unpinFrame(ref.frameNo, dirty);
+    }
+    
+    /**
+     * Unpin a frame on behalf of a PageGuard, which is known to hold a pin on it
+     *
+     * @param frameNo	Frame to unpin
+     * @param dirty		True if the page in the frame needs to be marked dirty
+     */
+    void BufMgr::releaseFrame(FrameId frameNo, const bool dirty)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        unpinFrame(frameNo, dirty);
+    }
+    
+    void PageGuard::release()
+    {
+        if (page == NULL)
+            return;
+        page = NULL;
+        bufMgr->releaseFrame(frameNo, dirty);
+    }
+    
+    /**
+     * Unpin a page found through the hash table; pages that are not buffered are ignored.  The
+     * latch must be held.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number
+     * @param dirty		True if the page to be unpinned needs to be marked dirty
+     * @throws  PageNotPinnedException If the page is not already pinned
+     */
+    void BufMgr::releasePage(File* file, const PageId pageNo, const bool dirty)
+    {
+        FrameId frameNo;
+        try
+        {
+            hashTable->lookup(file,pageNo,frameNo);
+            if (BufState::pinCnt(bufState[frameNo]) > 0)
+            {
+                unpinFrame(frameNo, dirty);
+            }
+            else
+            {
+                throw PageNotPinnedException(bufDescTable[frameNo].file->filename(), pageNo, frameNo);
+            }
+        }
+        catch (HashNotFoundException e)
+        {
+            //DO NOTHING
+            //std::cout << "HashNotFoundException() in BufMgr::unPinPage()";
+        }
+    }
+    /**
+     * Writes out all dirty pages of the file to disk.
+     * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
+     * Otherwise Error returned.
+     *
+     * @param file   	File object
+     * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+     * @throws BadBufferException If any frame allocated to the file is found to be invalid
+     */
+    void BufMgr::flushFile(const File* file)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        //walk the frames of the file; clearing a frame unlinks it, so step ahead first
+        FrameId next;
+        for (FrameId i = firstFileFrame(file); i != NO_FRAME; i = next)
+        {
+            next = bufDescTable[i].fileNext;
+            //pinned
+            const std::uint32_t state = bufState[i];
+            if (BufState::pinCnt(state) > 0)
+            {
+                throw PagePinnedException(bufDescTable[i].file->filename(), bufDescTable[i].pageNo(), bufDescTable[i].frameNo);
+            }
+            //invalid
+            else if (!BufState::valid(state))
+            {
+                throw BadBufferException(bufDescTable[i].frameNo, BufState::dirty(state), BufState::valid(state), BufState::refbit(state));
+            }
+            else
+            {
+                //bit is dirty
+                if (BufState::dirty(state))
+                {
+                    //flush page to disk
+                    writeBack(i);
+                }
+                //remove frame from hashtable
+                hashTable->remove(bufDescTable[i].file, bufDescTable[i].pageNo());
+                clearFrame(i);
+            }
+        }
+        if (tier != NULL)
+        {
+            tier->eraseFile(file->id());
+        }
+        notifyFrameFreed();
+    }
+    /**
+     * Drops every page of the file from the buffer pool without writing it back.
+     *
+     * @param file   	File object
+     * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+     */
+    void BufMgr::dropFile(const File* file)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        //check every frame before dropping any
+        for (FrameId i = firstFileFrame(file); i != NO_FRAME; i = bufDescTable[i].fileNext)
+        {
+            if (BufState::pinCnt(bufState[i]) > 0)
+            {
+                throw PagePinnedException(bufDescTable[i].file->filename(), bufDescTable[i].pageNo(), i);
+            }
+        }
+        FrameId next;
+        for (FrameId i = firstFileFrame(file); i != NO_FRAME; i = next)
+        {
+            next = bufDescTable[i].fileNext;
+            hashTable->remove(bufDescTable[i].file, bufDescTable[i].pageNo());
+            clearFrame(i);
+        }
+        if (tier != NULL)
+        {
+            tier->eraseFile(file->id());
+        }
+        notifyFrameFreed();
+    }
+    
+    /**
+     * Start writing out the dirty pages of the file on a background thread and return at once.
+     *
+     * @param file   	File object
+     * @param batchPages	Number of pages examined while holding the latch
+     * @param retryRounds	Number of times pinned pages are retried before they are skipped
+     * @return 		Handle to poll, wait for or cancel the flush
+     */
+    FlushHandle BufMgr::flushFileAsync(const File* file, const std::uint32_t batchPages,
+                                       const std::uint32_t retryRounds)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        reapAsyncFlushes();
+        std::vector<PageId> pageNos;
+        for (FrameId i = firstFileFrame(file); i != NO_FRAME; i = bufDescTable[i].fileNext)
+        {
+            if (BufState::dirty(bufState[i]))
+                pageNos.push_back(bufDescTable[i].pageNo());
+        }
+        std::sort(pageNos.begin(), pageNos.end());
+        
+        std::shared_ptr<AsyncFlushState> state(new AsyncFlushState());
+        state->bytesTotal = (std::uint64_t) pageNos.size() * Page::SIZE;
+        //the thread cannot take the latch before this call gives it up
+        state->worker = std::thread(&BufMgr::runAsyncFlush, this, file, pageNos, state.get(),
+                                    batchPages > 0 ? batchPages : 1, retryRounds);
+        asyncFlushes.push_back(state);
+        return FlushHandle(state);
+    }
+    
+    /**
+     * Write a dirty frame back to its file, flushing the log up to the page's LSN first.
+     *
+     * @param frameNo	Frame to write
+     */
+    void BufMgr::writeBack(FrameId frameNo)
+    {
+        if (log != NULL)
+        {
+            //the log must hold every change the page on disk will have
+            log->flush(bufPool[frameNo].lsn());
+        }
+        bufDescTable[frameNo].file->writePage(bufPool[frameNo]);
+        bufStats.diskwrites++;
+    }
+    
+    /**
+     * Body of the thread started by flushFileAsync().
+     *
+     * @param file   	File object
+     * @param pageNos	Dirty pages found when the flush started, in increasing order
+     * @param state		State of the flush, updated as pages are written
+     * @param batchPages	Number of pages examined per batch
+     * @param retryRounds	Number of times pinned pages are retried before they are skipped
+     */
+    void BufMgr::runAsyncFlush(const File* file, std::vector<PageId> pageNos, AsyncFlushState* state,
+                               const std::uint32_t batchPages, const std::uint32_t retryRounds)
+    {
+        try
+        {
+            std::chrono::milliseconds pause(1);
+            for (std::uint32_t round = 0; !pageNos.empty() && !state->cancelled; round++)
+            {
+                if (round > 0)
+                {
+                    if (round > retryRounds)
+                        break;
+                    //give the holders of the pins time to let go
+                    std::this_thread::sleep_for(pause);
+                    pause = std::min(pause * 2, std::chrono::milliseconds(64));
+                }
+                std::vector<PageId> pinned;
+                for (std::size_t start = 0; start < pageNos.size() && !state->cancelled; start += batchPages)
+                {
+                    const std::size_t end = std::min(pageNos.size(), start + batchPages);
+                    const std::vector<PageId> batch(pageNos.begin() + start, pageNos.begin() + end);
+                    std::uint32_t written;
+                    {
+                        std::lock_guard<std::mutex> guard(bufLatch);
+                        written = flushBatch(file, batch, pinned);
+                    }
+                    state->bytesWritten += (std::uint64_t) written * Page::SIZE;
+                }
+                pageNos.swap(pinned);
+            }
+            if (!state->cancelled)
+                state->pagesSkipped = (std::uint32_t) pageNos.size();
+            state->finish(std::exception_ptr());
+        }
+        catch (...)
+        {
+            state->finish(std::current_exception());
+        }
+    }
+    
+    /**
+     * Write one batch of an asynchronous flush.  The latch must be held.
+     *
+     * @param file   	File object
+     * @param pageNos	Pages of the batch, in increasing order
+     * @param pinned	Receives the pages that were pinned
+     * @return 		Number of pages written
+     */
+    std::uint32_t BufMgr::flushBatch(const File* file, const std::vector<PageId>& pageNos,
+                                     std::vector<PageId>& pinned)
+    {
+        std::vector<FrameId> frames;
+        std::vector<const Page*> pages;
+        for (std::size_t p = 0; p < pageNos.size(); p++)
+        {
+            FrameId frameNo;
+            //written back or dropped by someone else since the flush started
+            if (!hashTable->probe(file, pageNos[p], frameNo) || !BufState::dirty(bufState[frameNo]))
+                continue;
+            if (BufState::pinCnt(bufState[frameNo]) > 0)
+            {
+                pinned.push_back(pageNos[p]);
+                continue;
+            }
+            frames.push_back(frameNo);
+            pages.push_back(&bufPool[frameNo]);
+        }
+        if (frames.empty())
+            return 0;
+        if (log != NULL)
+        {
+            Lsn newest = 0;
+            for (std::size_t p = 0; p < pages.size(); p++)
+            {
+                newest = std::max(newest, pages[p]->lsn());
+            }
+            log->flush(newest);
+        }
+        //every copy of the file shares its stream, so any of them can write the batch
+        bufDescTable[frames[0]].file->writePages(pages);
+        for (std::size_t f = 0; f < frames.size(); f++)
+        {
+            bufState[frames[f]] &= ~BufState::DIRTY;
+        }
+        bufStats.diskwrites += frames.size();
+        return (std::uint32_t) frames.size();
+    }
+    
+    /**
+     * Join the threads of finished asynchronous flushes.  The latch must be held.
+     */
+    void BufMgr::reapAsyncFlushes()
+    {
+        std::size_t kept = 0;
+        for (std::size_t f = 0; f < asyncFlushes.size(); f++)
+        {
+            if (FlushHandle(asyncFlushes[f]).done())
+                asyncFlushes[f]->worker.join();
+            else
+                asyncFlushes[kept++] = asyncFlushes[f];
+        }
+        asyncFlushes.resize(kept);
+    }
+    
+    /**
+     * Take a fuzzy checkpoint of the pool.
+     *
+     * @return 		Redo LSN of the checkpoint, or 0 if the pool has no log
+     */
+    Lsn BufMgr::checkpoint()
+    {
+        if (log == NULL)
+        {
+            return 0;
+        }
+        //every record appended from here on is at or after beginLsn, whatever the table says
+        const Lsn beginLsn = log->endLsn();
+        std::vector<DirtyPage> dirtyPages;
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            for (FrameId i = 0; i < numBufs; i++)
+            {
+                //a pinned clean page may be being changed; it becomes dirty when unpinned
+                if (BufState::dirty(bufState[i]) ||
+                    (BufState::valid(bufState[i]) && BufState::pinCnt(bufState[i]) > 0))
+                {
+                    DirtyPage entry;
+                    entry.file = bufDescTable[i].file;
+                    entry.pageNo = bufDescTable[i].pageNo();
+                    entry.recLsn = bufDescTable[i].recLsn;
+                    dirtyPages.push_back(entry);
+                }
+            }
+        }
+        return log->logCheckpoint(beginLsn, dirtyPages);
+    }
+    
+    /**
+     * Write back the unpinned dirty pages with the oldest recovery LSNs.
+     *
+     * @param maxPages	Most pages to write
+     * @return 		Number of pages written
+     */
+    std::uint32_t BufMgr::flushOldestDirty(const std::uint32_t maxPages)
+    {
+        DirtySnapshot snapshot;
+        snapshotOldestDirty(snapshot, maxPages);
+        return flushSnapshot(snapshot, maxPages);
+    }
+    
+    /**
+     * Pick the unpinned dirty pages with the oldest recovery LSNs.
+     *
+     * @param snapshot	Receives the pages
+     * @param maxPages	Most pages to pick
+     */
+    void BufMgr::snapshotOldestDirty(DirtySnapshot& snapshot, const std::uint32_t maxPages)
+    {
+        snapshot.pages.clear();
+        snapshot.next = 0;
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            for (FrameId i = 0; i < numBufs; i++)
+            {
+                if (BufState::dirty(bufState[i]) && BufState::pinCnt(bufState[i]) == 0)
+                    snapshot.pages.push_back(std::make_pair(bufDescTable[i].recLsn,
+                                                            std::make_pair(bufDescTable[i].key, i)));
+            }
+        }
+        //ordering the pages needs nothing of the pool
+        if (snapshot.pages.size() > maxPages)
+        {
+            std::nth_element(snapshot.pages.begin(), snapshot.pages.begin() + maxPages, snapshot.pages.end());
+            snapshot.pages.resize(maxPages);
+        }
+        std::sort(snapshot.pages.begin(), snapshot.pages.end());
+    }
+    
+    /**
+     * Write back the next pages of a snapshot.
+     *
+     * @param snapshot	Snapshot taken by snapshotOldestDirty()
+     * @param maxPages	Most pages to write
+     * @return 		Number of pages written
+     */
+    std::uint32_t BufMgr::flushSnapshot(DirtySnapshot& snapshot, const std::uint32_t maxPages)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        //group by file, then page order within the file
+        std::vector<std::pair<PageKey, FrameId> > order;
+        for (; snapshot.next < snapshot.pages.size() && order.size() < maxPages; snapshot.next++)
+        {
+            const PageKey key = snapshot.pages[snapshot.next].second.first;
+            const FrameId frameNo = snapshot.pages[snapshot.next].second.second;
+            //the frame may have been written back, or given to another page, since the snapshot
+            if (frameNo >= numBufs || !BufState::valid(bufState[frameNo]) || bufDescTable[frameNo].key != key ||
+                !BufState::dirty(bufState[frameNo]) || BufState::pinCnt(bufState[frameNo]) > 0)
+                continue;
+            order.push_back(std::make_pair(key, frameNo));
+        }
+        std::sort(order.begin(), order.end());
+        
+        for (std::size_t start = 0; start < order.size(); )
+        {
+            const FileId fileId = bufDescTable[order[start].second].fileId();
+            std::vector<const Page*> pages;
+            Lsn newest = 0;
+            std::size_t end = start;
+            for (; end < order.size() && bufDescTable[order[end].second].fileId() == fileId; end++)
+            {
+                pages.push_back(&bufPool[order[end].second]);
+                newest = std::max(newest, bufPool[order[end].second].lsn());
+            }
+            if (log != NULL)
+                log->flush(newest);
+            bufDescTable[order[start].second].file->writePages(pages);
+            for (std::size_t o = start; o < end; o++)
+            {
+                bufState[order[o].second] &= ~BufState::DIRTY;
+            }
+            bufStats.diskwrites += end - start;
+            start = end;
+        }
+        return (std::uint32_t) order.size();
+    }
+    
+    /**
+     * Counts the buffered, dirty and pinned pages of a file.
+     *
+     * @param file   	File object
+     */
+    FileStats BufMgr::getFileStats(const File* file)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        FileStats stats;
+        for (FrameId i = firstFileFrame(file); i != NO_FRAME; i = bufDescTable[i].fileNext)
+        {
+            stats.residentPages++;
+            if (BufState::dirty(bufState[i]))
+                stats.dirtyPages++;
+            if (BufState::pinCnt(bufState[i]) > 0)
+                stats.pinnedPages++;
+        }
+        return stats;
+    }
+    
+    /**
+     * Allocates a new, empty page in the file and returns the Page object.
+     * The newly allocated page is also assigned a frame in the buffer pool.
+     *
+     * @param file   	File object
+     * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+     * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+     */
+    void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        page = &bufPool[newFrame(file, pageNo)];
+    }
+    
+    /**
+     * Allocates a new, empty page in the file and returns a guard holding the pin on it.
+     * The page is unpinned and marked dirty when the guard is destroyed.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number. The number assigned to the page in the file is returned via this reference.
+     * @return 		Guard giving writable access to the new page
+     */
+    WritePageGuard BufMgr::allocPageGuard(File* file, PageId& pageNo)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const FrameId frameNo = newFrame(file, pageNo);
+        return WritePageGuard(this, frameNo, &bufPool[frameNo]);
+    }
+    
+    /**
+     * Allocates a new page in the file and pins it in a frame.  The latch must be held.
+     *
+     * @param file   	File object
+     * @param pageNo  Page number. The number assigned to the page in the file is returned via this reference.
+     * @return 		Frame holding the new page
+     */
+    FrameId BufMgr::newFrame(File* file, PageId& pageNo)
+    {
+        FrameId frameNo;
+        Page p = file->allocatePage(); //returns the allocated page
+        pageNo = p.page_number();
+        bufStats.accesses++;
+        bufStats.diskreads++;
+        BufMgr::allocBuf(frameNo, partitionFor(file, pageNo)); //returns frameId -> frameNo
+        bufPool[frameNo] = p;
+        hashTable->insert(file, pageNo, frameNo);
+        setFrame(frameNo, file, pageNo);
+        return frameNo;
+    }
+    
+    /**
+     * Delete page from file and also from buffer pool if present.
+     * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+     *
+     * @param file   	File object
+     * @param PageNo  Page number
+     */
+
+    void BufMgr::disposePage(File* file, const PageId PageNo)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        if (tier != NULL)
+        {
+            tier->erase(makePageKey(file->id(), PageNo));
+        }
+        FrameId frameNo;
+        try
+        {
+            hashTable->lookup(file,PageNo,frameNo);
+            if (!BufState::valid(bufState[frameNo])) {
+                clearFrame(frameNo);
+            }
+            if (BufState::dirty(bufState[frameNo])) {
+                writeBack(frameNo);
+            }
+            hashTable->remove(bufDescTable[frameNo].file, bufDescTable[frameNo].pageNo());
+            clearFrame(frameNo);
+            notifyFrameFreed();
+            file->deletePage(PageNo);
+        }
+        catch (HashNotFoundException e)
+        {
+            //do nothing
+        }
+    }
+    
+    /**
+     * Turn pin diagnostics on or off.
+     *
+     * @param enabled	Whether to keep diagnostics
+     */
+    void BufMgr::setPinDiagnostics(const bool enabled)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        if (enabled && !pinDiagnostics)
+        {
+            //forget owners from an earlier run; frames pinned since then have none
+            pinRecords.assign(maxBufs, PinRecord());
+        }
+        pinDiagnostics = enabled;
+    }
+    
+    /**
+     * Report every frame that has been pinned for at least the given time, oldest first.
+     *
+     * @param out		Stream to write the report to
+     * @param minSeconds	Only report pins held at least this long
+     * @return 		Number of frames reported
+     */
+    std::uint32_t BufMgr::dumpPinned(std::ostream& out, const double minSeconds)
+    {
+        std::lock_guard<std::mutex> guard(bufLatch);
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::vector<std::pair<double, FrameId> > pinned;
+        for (FrameId i = 0; i < numBufs; i++)
+        {
+            if (BufState::pinCnt(bufState[i]) == 0)
+                continue;
+            //pins taken while diagnostics were off count as held forever
+            double held = std::numeric_limits<double>::infinity();
+            if (!pinRecords.empty() && pinRecords[i].thread != std::thread::id())
+            {
+                held = std::chrono::duration<double>(now - pinRecords[i].since).count();
+            }
+            if (held >= minSeconds)
+                pinned.push_back(std::make_pair(held, i));
+        }
+        std::sort(pinned.rbegin(), pinned.rend());
+        
+        for (std::size_t p = 0; p < pinned.size(); p++)
+        {
+            const FrameId i = pinned[p].second;
+            out << "FrameNo:" << i << " file:" << bufDescTable[i].file->filename()
+                << " pageNo:" << bufDescTable[i].pageNo()
+                << " pinCnt:" << BufState::pinCnt(bufState[i]);
+            if (pinned[p].first != std::numeric_limits<double>::infinity())
+            {
+                out << " heldFor:" << pinned[p].first << "s thread:" << pinRecords[i].thread
+                    << " site:" << (pinRecords[i].site != NULL ? pinRecords[i].site : "-");
+            }
+            else
+            {
+                out << " owner:unknown";
+            }
+            out << "\n";
         }
+        out << "Total Number of Pinned Frames Reported:" << pinned.size() << "\n";
+        return (std::uint32_t) pinned.size();
     }
     
     /**
@@ -286,6 +1542,7 @@ namespace badgerdb {
      */
     void BufMgr::printSelf(void)
     {
+        std::lock_guard<std::mutex> guard(bufLatch);
         BufDesc* tmpbuf;
         int validFrames = 0;
         
@@ -293,9 +1550,9 @@ namespace badgerdb {
         {
             tmpbuf = &(bufDescTable[i]);
             std::cout << "FrameNo:" << i << " ";
-            tmpbuf->Print();
+            tmpbuf->Print(bufState[i]);
             
-            if (tmpbuf->valid == true)
+            if (BufState::valid(bufState[i]))
                 validFrames++;
         }
         
@@ -9,7 +9,20 @@
 
 #include "file.h"
 #include "bufHashTbl.h"
+#include "flush_handle.h"
+#include "frame_arena.h"
+#include "cache_tier.h"
+#include "log_manager.h"
+#include "numa_topology.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace badgerdb {
     
@@ -18,8 +31,51 @@ namespace badgerdb {
      */
     class BufMgr;
     
+    /**
+     * @brief Packed per-frame state word: valid, reference and dirty flags plus the pin count.
+     *
+     * State words of all frames are kept in one dense array, apart from the rest of the
+     * frame's descriptor, so that the clock sweep reads many frames per cache line.
+     */
+    struct BufState
+    {
+        /**
+         * Set if the frame holds a page
+         */
+        static const std::uint32_t VALID = 1u << 31;
+        
+        /**
+         * Set if the frame has been referenced since the clock last passed it
+         */
+        static const std::uint32_t REF = 1u << 30;
+        
+        /**
+         * Set if the page has been modified since it was read
+         */
+        static const std::uint32_t DIRTY = 1u << 29;
+        
+        /**
+         * Bits holding the number of times the page is pinned
+         */
+        static const std::uint32_t PIN_MASK = DIRTY - 1;
+        
+        /**
+         * State of a frame just assigned to a page: valid, referenced and pinned once
+         */
+        static const std::uint32_t LOADED = VALID | REF | 1;
+        
+        static bool valid(std::uint32_t state) { return (state & VALID) != 0; }
+        static bool refbit(std::uint32_t state) { return (state & REF) != 0; }
+        static bool dirty(std::uint32_t state) { return (state & DIRTY) != 0; }
+        static std::uint32_t pinCnt(std::uint32_t state) { return state & PIN_MASK; }
+    };
+    
+    
     /**
      * @brief Class for maintaining information about buffer pool frames
+     *
+     * Holds the parts of a frame's bookkeeping that the clock sweep does not need; the
+     * frame's flags and pin count live in its BufState word.
      */
     class BufDesc {
         
@@ -32,9 +88,9 @@ namespace badgerdb {
         File* file;
         
         /**
-         * Page within file to which corresponding frame is assigned
+         * Id of the file and page within file to which corresponding frame is assigned
          */
-        PageId pageNo;
+        PageKey key;
         
         /**
          * Frame number of the frame, in the buffer pool, being used
@@ -42,37 +98,37 @@ namespace badgerdb {
         FrameId	frameNo;
         
         /**
-         * Number of times this page has been pinned
+         * Next and previous frame holding a page of the same file, or BufMgr::NO_FRAME; the
+         * frames of each file form a list that starts at BufMgr::fileHead
          */
-        int pinCnt;
+        FrameId fileNext;
+        FrameId filePrev;
         
         /**
-         * True if page is dirty;  false otherwise
+         * End of the log when the frame was last pinned while clean: every change since the
+         * page was last written back has an LSN at or after it
          */
-        bool dirty;
+        Lsn recLsn;
         
         /**
-         * True if page is valid
+         * Initialize buffer frame for a new user
          */
-        bool valid;
+        void Clear()
+        {
+            file = NULL;
+            key = makePageKey(0, Page::INVALID_NUMBER);
+            recLsn = 0;
+        };
         
         /**
-         * Has this buffer frame been reference recently
+         * Page within file to which corresponding frame is assigned
          */
-        bool refbit;
+        PageId pageNo() const { return (PageId) key; }
         
         /**
-         * Initialize buffer frame for a new user
+         * Identifier of the file the frame is assigned to
          */
-        void Clear()
-        {
-            pinCnt = 0;
-            file = NULL;
-            pageNo = Page::INVALID_NUMBER;
-            dirty = false;
-            refbit = false;
-            valid = false;
-        };
+        FileId fileId() const { return (FileId) (key >> 32); }
         
         /**
          * Set values of member variables corresponding to assignment of frame to a page in the file. Called when a frame
@@ -84,27 +140,28 @@ namespace badgerdb {
         void Set(File* filePtr, PageId pageNum)
         {
             file = filePtr;
-            pageNo = pageNum;
-            pinCnt = 1;
-            dirty = false;
-            valid = true;
-            refbit = true;
+            key = makePageKey(filePtr->id(), pageNum);
         }
         
-        void Print()
+        /**
+         * Print the descriptor together with the frame's state word
+         *
+         * @param state	State word of the frame
+         */
+        void Print(std::uint32_t state)
         {
             if(file)
             {
                 std::cout << "file:" << file->filename() << " ";
-                std::cout << "pageNo:" << pageNo << " ";
+                std::cout << "pageNo:" << pageNo() << " ";
             }
             else
                 std::cout << "file:NULL ";
             
-            std::cout << "valid:" << valid << " ";
-            std::cout << "pinCnt:" << pinCnt << " ";
-            std::cout << "dirty:" << dirty << " ";
-            std::cout << "refbit:" << refbit << "\n";
+            std::cout << "valid:" << BufState::valid(state) << " ";
+            std::cout << "pinCnt:" << BufState::pinCnt(state) << " ";
+            std::cout << "dirty:" << BufState::dirty(state) << " ";
+            std::cout << "refbit:" << BufState::refbit(state) << "\n";
         }
         
         /**
@@ -156,135 +213,1564 @@ namespace badgerdb {
     
     
     /**
-     * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file
+     * @brief Buffered pages of one file
      */
-    class BufMgr
+    struct FileStats
     {
-    private:
         /**
-         * Current position of clockhand in our buffer pool
+         * Number of pages of the file in the buffer pool
          */
-        FrameId clockHand;
+        std::uint32_t residentPages;
         
         /**
-         * Number of frames in the buffer pool
+         * Number of those pages that are dirty
          */
-        std::uint32_t numBufs;
+        std::uint32_t dirtyPages;
         
         /**
-         * Hash table mapping (File, page) to frame
+         * Number of those pages that are pinned
          */
-        BufHashTbl *hashTable;
+        std::uint32_t pinnedPages;
         
         /**
-         * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+         * Constructor of FileStats class
          */
-        BufDesc *bufDescTable;
+        FileStats()
+        : residentPages(0), dirtyPages(0), pinnedPages(0)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief Dirty pages picked by BufMgr::snapshotOldestDirty() for write-back, oldest
+     * recovery LSN first, and how far BufMgr::flushSnapshot() has got through them
+     */
+    struct DirtySnapshot
+    {
+        /**
+         * Recovery LSN, page and frame of each page, oldest recovery LSN first
+         */
+        std::vector<std::pair<Lsn, std::pair<PageKey, FrameId> > > pages;
         
         /**
-         * Maintains Buffer pool usage statistics
+         * Position of the next page to write
          */
-        BufStats bufStats;
+        std::size_t next;
         
         /**
-         * Advance clock to next frame in the buffer pool
+         * Constructor of DirtySnapshot class
+         */
+        DirtySnapshot()
+        : next(0)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief Who took the first of the pins a frame currently holds, and when
+     */
+    struct PinRecord
+    {
+        /**
+         * Time the frame went from unpinned to pinned
          */
-        void advanceClock();
+        std::chrono::steady_clock::time_point since;
         
         /**
-         * Allocate a free frame.
-         *
-         * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
-         * @throws BufferExceededException If no such buffer is found which can be allocated
+         * Thread that pinned it
          */
-        void allocBuf(FrameId & frame);
+        std::thread::id thread;
         
-    public:
         /**
-         * Actual buffer pool from which frames are allocated
+         * Site label the thread had set with BufMgr::setPinSite(), or NULL
          */
-        Page* bufPool;
+        const char* site;
+    };
+    
+    
+    /**
+     * @brief Counters kept while pin diagnostics are on
+     */
+    struct PinStats
+    {
+        /**
+         * Number of clock sweeps run to find a frame
+         */
+        std::uint64_t sweeps;
         
         /**
-         * Constructor of BufMgr class
+         * Number of times a sweep passed over a frame it would have evicted had it not been pinned
          */
-        BufMgr(std::uint32_t bufs);
+        std::uint64_t pinnedSkips;
         
         /**
-         * Destructor of BufMgr class
+         * Number of BufferExceededExceptions thrown
          */
-        ~BufMgr();
+        std::uint64_t exceeded;
         
         /**
-         * Reads the given page from the file into a frame and returns the pointer to page.
-         * If the requested page is already present in the buffer pool pointer to that frame is returned
-         * otherwise a new frame is allocated from the buffer pool for reading the page.
-         *
-         * @param file   	File object
-         * @param PageNo  Page number in the file to be read
-         * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+         * Clear all values
          */
-        void readPage(File* file, const PageId PageNo, Page*& page);
+        void clear()
+        {
+            sweeps = pinnedSkips = exceeded = 0;
+        }
         
         /**
-         * Unpin a page from memory since it is no longer required for it to remain in memory.
-         *
-         * @param file   	File object
-         * @param PageNo  Page number
-         * @param dirty		True if the page to be unpinned needs to be marked dirty
-         * @throws  PageNotPinnedException If the page is not already pinned
+         * Constructor of PinStats class
          */
-        void unPinPage(File* file, const PageId PageNo, const bool dirty);
+        PinStats()
+        {
+            clear();
+        }
+    };
+    
+    
+    /**
+     * @brief Counters of page faults that found every frame pinned and waited for one
+     */
+    struct WaitStats
+    {
+        /**
+         * Number of waits for a frame
+         */
+        std::uint64_t waits;
         
         /**
-         * Allocates a new, empty page in the file and returns the Page object.
-         * The newly allocated page is also assigned a frame in the buffer pool.
-         *
-         * @param file   	File object
-         * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
-         * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+         * Number of waits that ended without a frame (and in BufferExceededException)
          */
-        void allocPage(File* file, PageId &PageNo, Page*& page); 
+        std::uint64_t timeouts;
         
         /**
-         * Writes out all dirty pages of the file to disk.
-         * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-         * Otherwise Error returned.
+         * Time spent waiting, in microseconds
+         */
+        std::uint64_t totalWaitMicros;
+        
+        /**
+         * Longest single wait, in microseconds
+         */
+        std::uint64_t maxWaitMicros;
+        
+        /**
+         * Clear all values
+         */
+        void clear()
+        {
+            waits = timeouts = totalWaitMicros = maxWaitMicros = 0;
+        }
+        
+        /**
+         * Constructor of WaitStats class
+         */
+        WaitStats()
+        {
+            clear();
+        }
+    };
+    
+    
+    /**
+     * @brief A frame and the version it had when an optimistic (unpinned) read of it started
+     *
+     * The read is only good if BufMgr::validate() still finds the frame at the same version
+     * once the reader is done with the page.
+     */
+    struct PageVersion
+    {
+        /**
+         * Frame holding the page
+         */
+        FrameId frameNo;
+        
+        /**
+         * Version of the frame when the read started
+         */
+        std::uint64_t version;
+        
+        /**
+         * The page; its contents may change under the reader until validated
+         */
+        const Page* page;
+    };
+    
+    
+    /**
+     * @brief Reference to a page that caches ("swizzles") the frame holding it
+     *
+     * While the page stays in the frame, BufMgr reaches it through the reference without a hash
+     * table lookup.  Evicting the page invalidates the cached frame, and the next access through
+     * the reference looks the page up again and re-swizzles it.  Meant for callers that keep
+     * following the same page links, such as next_page_number chains or index pointers.
+     */
+    class PageRef
+    {
+        friend class BufMgr;
+        
+    public:
+        /**
+         * Frame number of a reference that is not swizzled
+         */
+        static const FrameId UNSWIZZLED = ~0u;
+        
+        /**
+         * Constructs an unswizzled reference to a page
          *
-         * @param file   	File object
-         * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
-         * @throws BadBufferException If any frame allocated to the file is found to be invalid
+         * @param filePtr	File object
+         * @param pageNum	Page number in the file
          */
-        void flushFile(const File* file);
+        PageRef(File* filePtr, PageId pageNum)
+        : file(filePtr), pageNo(pageNum), frameNo(UNSWIZZLED), epoch(0)
+        {
+        }
         
         /**
-         * Delete page from file and also from buffer pool if present.
-         * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+         * File the page belongs to
+         */
+        File* getFile() const { return file; }
+        
+        /**
+         * Page within the file
+         */
+        PageId getPageNo() const { return pageNo; }
+        
+        /**
+         * True if the reference has a cached frame; the page may have been evicted from it since
+         */
+        bool isSwizzled() const { return frameNo != UNSWIZZLED; }
+        
+    private:
+        /**
+         * File the page belongs to
+         */
+        File* file;
+        
+        /**
+         * Page within the file
+         */
+        PageId pageNo;
+        
+        /**
+         * Frame the page was in when the reference was last swizzled
+         */
+        FrameId frameNo;
+        
+        /**
+         * Residency epoch of that frame at the time; any other value means the page has left it
+         */
+        std::uint32_t epoch;
+    };
+    
+    
+    /**
+     * @brief Pin on a buffered page that is released when the guard goes out of scope
+     *
+     * Guards are move-only, so exactly one of them owns a pin at any time.  Unpinning goes
+     * straight to the frame the guard holds, without a hash table lookup.  Use ReadPageGuard
+     * or WritePageGuard; this base only carries what they share.
+     */
+    class PageGuard
+    {
+    public:
+        /**
+         * True if the guard holds a pin
+         */
+        bool isValid() const { return page != NULL; }
+        
+        /**
+         * Unpin the page now rather than when the guard is destroyed; the guard is empty afterwards
+         */
+        void release();
+        
+    protected:
+        /**
+         * Constructs an empty guard
+         */
+        PageGuard()
+        : bufMgr(NULL), frameNo(0), page(NULL), dirty(false)
+        {
+        }
+        
+        /**
+         * Constructs a guard owning a pin that the caller has already taken
          *
-         * @param file   	File object
-         * @param PageNo  Page number
+         * @param mgr		Buffer manager the page is pinned in
+         * @param frame		Frame holding the page
+         * @param pagePtr	The page
+         * @param isDirty	Whether releasing the pin marks the page dirty
          */
-        void disposePage(File* file, const PageId PageNo);
+        PageGuard(BufMgr* mgr, FrameId frame, Page* pagePtr, bool isDirty)
+        : bufMgr(mgr), frameNo(frame), page(pagePtr), dirty(isDirty)
+        {
+        }
         
         /**
-         * Print member variable values. 
+         * Takes over the pin of another guard, leaving that guard empty
          */
-        void  printSelf();
+        PageGuard(PageGuard&& other)
+        : bufMgr(other.bufMgr), frameNo(other.frameNo), page(other.page), dirty(other.dirty)
+        {
+            other.page = NULL;
+        }
         
         /**
-         * Get buffer pool usage statistics
+         * Releases the pin, if the guard still holds one
          */
-        BufStats & getBufStats()
+        ~PageGuard()
         {
-            return bufStats;
+            if (page != NULL)
+                release();
         }
         
         /**
-         * Clear buffer pool usage statistics
+         * Releases the pin this guard holds and takes over the one of another guard
          */
-        void clearBufStats() 
+        void moveFrom(PageGuard& other)
         {
-            bufStats.clear();
+            if (this == &other)
+                return;
+            release();
+            bufMgr = other.bufMgr;
+            frameNo = other.frameNo;
+            page = other.page;
+            dirty = other.dirty;
+            other.page = NULL;
+        }
+        
+        /**
+         * Buffer manager the page is pinned in
+         */
+        BufMgr* bufMgr;
+        
+        /**
+         * Frame holding the page
+         */
+        FrameId frameNo;
+        
+        /**
+         * The page, or NULL if the guard is empty
+         */
+        Page* page;
+        
+        /**
+         * Whether releasing the pin marks the page dirty
+         */
+        bool dirty;
+        
+    private:
+        PageGuard(const PageGuard&);
+        PageGuard& operator=(const PageGuard&);
+    };
+    
+    
+    /**
+     * @brief Pin on a page that is only read; releasing it leaves the dirty bit alone
+     */
+    class ReadPageGuard : public PageGuard
+    {
+        friend class BufMgr;
+        
+    public:
+        /**
+         * Constructs an empty guard
+         */
+        ReadPageGuard()
+        {
+        }
+        
+        /**
+         * Takes over the pin of another guard, leaving that guard empty
+         */
+        ReadPageGuard(ReadPageGuard&& other)
+        : PageGuard(std::move(other))
+        {
+        }
+        
+        /**
+         * Releases the pin this guard holds and takes over the one of another guard
+         */
+        ReadPageGuard& operator=(ReadPageGuard&& other)
+        {
+            moveFrom(other);
+            return *this;
+        }
+        
+        const Page& operator*() const { return *page; }
+        const Page* operator->() const { return page; }
+        
+    private:
+        ReadPageGuard(BufMgr* mgr, FrameId frame, Page* pagePtr)
+        : PageGuard(mgr, frame, pagePtr, false)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief Pin on a page that is modified; releasing it marks the page dirty
+     */
+    class WritePageGuard : public PageGuard
+    {
+        friend class BufMgr;
+        
+    public:
+        /**
+         * Constructs an empty guard
+         */
+        WritePageGuard()
+        {
+        }
+        
+        /**
+         * Takes over the pin of another guard, leaving that guard empty
+         */
+        WritePageGuard(WritePageGuard&& other)
+        : PageGuard(std::move(other))
+        {
+        }
+        
+        /**
+         * Releases the pin this guard holds and takes over the one of another guard
+         */
+        WritePageGuard& operator=(WritePageGuard&& other)
+        {
+            moveFrom(other);
+            return *this;
+        }
+        
+        Page& operator*() const { return *page; }
+        Page* operator->() const { return page; }
+        
+    private:
+        WritePageGuard(BufMgr* mgr, FrameId frame, Page* pagePtr)
+        : PageGuard(mgr, frame, pagePtr, true)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief Range of buffer pool frames, local to one NUMA node, with its own clock
+     */
+    struct BufPartition
+    {
+        /**
+         * First frame of the partition
+         */
+        FrameId firstFrame;
+        
+        /**
+         * Number of frames in the partition
+         */
+        std::uint32_t numFrames;
+        
+        /**
+         * Current position of the partition's clock hand
+         */
+        FrameId clockHand;
+    };
+    
+    
+    /**
+     * @brief How a NUMA-aware BufMgr picks the partition for a page it has to bring in
+     */
+    enum NumaPlacement
+    {
+        /**
+         * Partition chosen by hashing the page's PageKey, spreading pages evenly over the nodes
+         */
+        PLACE_BY_HASH,
+        
+        /**
+         * Partition of the node the requesting thread runs on
+         */
+        PLACE_BY_FIRST_TOUCH
+    };
+    
+    
+    /**
+     * @brief Which unpinned frame the clock hands over when a page has to be brought in
+     */
+    enum ReplacementPolicy
+    {
+        /**
+         * Clock (second chance): frames referenced since the hand last passed are skipped once
+         */
+        REPLACE_CLOCK,
+        
+        /**
+         * Frames are reused in the order they were loaded, whatever their reuse; suits pools
+         * holding pages that are scanned once, such as a recycle pool
+         */
+        REPLACE_FIFO
+    };
+    
+    
+    /**
+     * @brief Options controlling how a BufMgr lays out its buffer pool
+     */
+    struct BufMgrOptions
+    {
+        /**
+         * Allocate all frames as one region backed by huge pages (MAP_HUGETLB,
+         * falling back to madvise(MADV_HUGEPAGE))
+         */
+        bool hugePages;
+        
+        /**
+         * Partition frames and descriptors per NUMA node, each partition with a node-local clock
+         */
+        bool numaAware;
+        
+        /**
+         * Placement of newly buffered pages when numaAware is set
+         */
+        NumaPlacement numaPlacement;
+        
+        /**
+         * How long a page fault may wait for a frame to be unpinned when every frame is pinned,
+         * before giving up with BufferExceededException; 0 gives up at once
+         */
+        std::uint32_t evictionWaitMillis;
+        
+        /**
+         * Replacement policy of the pool
+         */
+        ReplacementPolicy replacement;
+        
+        /**
+         * Number of frames BufMgr::resize() may grow the pool to; address space for them is
+         * reserved up front.  0 (or anything not above the initial size) fixes the maximum at
+         * the initial size.
+         */
+        std::uint32_t maxFrames;
+        
+        /**
+         * Write-ahead log the pages of this pool are changed under, or NULL.  The log is
+         * flushed up to a page's LSN before the page is written back.  Not owned by the pool.
+         */
+        LogManager* log;
+        
+        /**
+         * Second-level cache that evicted pages go to and misses look in before the file, or
+         * NULL.  Not owned by the pool.
+         */
+        CacheTier* tier;
+        
+        /**
+         * Constructor of BufMgrOptions class; every option off
+         */
+        BufMgrOptions()
+        : hugePages(false), numaAware(false), numaPlacement(PLACE_BY_FIRST_TOUCH), evictionWaitMillis(0),
+          replacement(REPLACE_CLOCK), maxFrames(0), log(NULL), tier(NULL)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file
+     *
+     * All public methods may be called concurrently; they are serialized by a single latch.
+     */
+    class BufMgr
+    {
+        friend class PageGuard;
+        
+    private:
+        /**
+         * Partitions of the buffer pool; one per NUMA node, or a single one covering every frame
+         */
+        BufPartition *partitions;
+        
+        /**
+         * Number of entries in 'partitions'
+         */
+        std::uint32_t numPartitions;
+        
+        /**
+         * NUMA nodes the partitions are placed on
+         */
+        NumaTopology numaTopology;
+        
+        /**
+         * Placement of newly buffered pages across partitions
+         */
+        NumaPlacement numaPlacement;
+        
+        /**
+         * Replacement policy of the pool
+         */
+        ReplacementPolicy replacement;
+        
+        /**
+         * Write-ahead log flushed before dirty pages are written back, or NULL
+         */
+        LogManager* log;
+        
+        /**
+         * Second-level cache of evicted pages, or NULL
+         */
+        CacheTier* tier;
+        
+        /**
+         * How long allocBuf waits for a frame to be unpinned before giving up
+         */
+        std::chrono::milliseconds evictionWait;
+        
+        /**
+         * Number of threads waiting in allocBuf for a frame
+         */
+        std::uint32_t evictionWaiters;
+        
+        /**
+         * Signalled when a frame may have become evictable; waited on with bufLatch
+         */
+        std::condition_variable_any frameFreed;
+        
+        /**
+         * Counters of the waits in allocBuf
+         */
+        WaitStats waitStats;
+        
+        /**
+         * Latch serializing access to the buffer pool and its bookkeeping
+         */
+        std::mutex bufLatch;
+        
+        /**
+         * Number of frames in the buffer pool
+         */
+        std::uint32_t numBufs;
+        
+        /**
+         * Number of frames the pool can grow to; frame and descriptor arrays are this long
+         */
+        std::uint32_t maxBufs;
+        
+        /**
+         * Hash table mapping (File, page) to frame
+         */
+        BufHashTbl *hashTable;
+        
+        /**
+         * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+         */
+        BufDesc *bufDescTable;
+        
+        /**
+         * Dense array of BufState words, one per frame, scanned by the clock sweep
+         */
+        std::uint32_t *bufState;
+        
+        /**
+         * Version of each frame for optimistic readers.  Odd while the frame is pinned, so its
+         * contents may change; bumped whenever the frame is pinned, unpinned or emptied.
+         */
+        std::atomic<std::uint64_t> *frameVersion;
+        
+        /**
+         * End of a list of frames
+         */
+        static const FrameId NO_FRAME = ~0u;
+        
+        /**
+         * First frame of each file's list of frames, indexed by file id, or NO_FRAME
+         */
+        std::vector<FrameId> fileHead;
+        
+        /**
+         * Flushes started by flushFileAsync() whose threads have not been joined yet
+         */
+        std::vector<std::shared_ptr<AsyncFlushState> > asyncFlushes;
+        
+        /**
+         * Whether pins are recorded and sweeps counted; see setPinDiagnostics()
+         */
+        bool pinDiagnostics;
+        
+        /**
+         * First pin of every pinned frame, kept while pin diagnostics are on
+         */
+        std::vector<PinRecord> pinRecords;
+        
+        /**
+         * Sweep counters, kept while pin diagnostics are on
+         */
+        PinStats pinStats;
+        
+        /**
+         * Site label of the calling thread, copied into the PinRecords of the frames it pins
+         */
+        static thread_local const char* pinSite;
+        
+        /**
+         * Residency epoch of each frame, bumped every time the frame gives up its page so that
+         * swizzled PageRefs to that page stop matching
+         */
+        std::atomic<std::uint32_t> *frameEpoch;
+        
+        /**
+         * Maintains Buffer pool usage statistics
+         */
+        BufStats bufStats;
+        
+        /**
+         * Memory region holding the frames of 'bufPool'
+         */
+        FrameArena *frameArena;
+        
+        /**
+         * Advance the partition's clock to its next frame
+         *
+         * @param partition	Partition whose clock is advanced
+         */
+        void advanceClock(BufPartition & partition);
+        
+        /**
+         * Allocate a free frame, sweeping the given partition first and the others only if it is fully pinned.
+         * If every frame is pinned and the pool was configured to wait, the latch is given up until
+         * a frame is unpinned or the wait times out; callers must then expect the pool to have
+         * changed, including the page they want having been brought in by another thread.
+         *
+         * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+         * @param home    	Partition the frame should preferably come from
+         * @return 		True if the latch was given up while waiting for the frame
+         * @throws BufferExceededException If no such buffer is found which can be allocated
+         */
+        bool allocBuf(FrameId & frame, std::uint32_t home);
+        
+        /**
+         * Sweep the given partition, then the others, for a frame to reuse.
+         *
+         * @param frame   	Frame ID of the freed frame returned via this variable
+         * @param home    	Partition to sweep first
+         * @return 		True if a frame was freed, false if every frame is pinned
+         */
+        bool sweepPartitions(FrameId & frame, std::uint32_t home);
+        
+        /**
+         * Wake the threads waiting in allocBuf, if any, after frames were freed
+         */
+        void notifyFrameFreed()
+        {
+            if (evictionWaiters > 0)
+                frameFreed.notify_all();
+        }
+        
+        /**
+         * Run the clock over one partition looking for a frame to reuse.
+         *
+         * @param partition	Partition to sweep
+         * @param frame   	Frame ID of the freed frame returned via this variable
+         * @return 		True if a frame was freed, false if every frame of the partition is pinned
+         */
+        bool sweepPartition(BufPartition & partition, FrameId & frame);
+        
+        /**
+         * Let the clock pass over four consecutive frames at once when none of them can be
+         * evicted, clearing their reference bits.
+         *
+         * @param partition	Partition being swept; its clock hand is advanced past the skipped frames
+         * @param visited	Number of frames the sweep has passed so far, updated
+         * @param limit   	Number of frames after which the sweep gives up
+         * @return 		True if frames were skipped, false if the next frames must be examined one by one
+         */
+        bool skipUnevictable(BufPartition & partition, std::uint32_t & visited, std::uint32_t limit);
+        
+        /**
+         * Release a frame that no longer holds a page
+         *
+         * @param frameNo	Frame to release
+         */
+        void clearFrame(FrameId frameNo)
+        {
+            if (bufDescTable[frameNo].file != NULL)
+            {
+                unlinkFileFrame(frameNo);
+            }
+            bufDescTable[frameNo].Clear();
+            bufState[frameNo] = 0;
+            frameEpoch[frameNo].fetch_add(1, std::memory_order_relaxed);
+            //move to the next even version, failing readers that started on the old page
+            const std::uint64_t version = frameVersion[frameNo].load(std::memory_order_relaxed);
+            frameVersion[frameNo].store(version + 2 - (version & 1), std::memory_order_release);
+        }
+        
+        /**
+         * Assign a frame to a page, leaving it pinned once
+         *
+         * @param frameNo	Frame to assign
+         * @param file   	File object
+         * @param pageNo  Page number in the file
+         */
+        void setFrame(FrameId frameNo, File* file, PageId pageNo)
+        {
+            bufDescTable[frameNo].Set(file, pageNo);
+            linkFileFrame(frameNo);
+            bufState[frameNo] = BufState::LOADED;
+            if (log != NULL)
+                bufDescTable[frameNo].recLsn = log->endLsn();
+            frameVersion[frameNo].fetch_add(1);
+            if (pinDiagnostics)
+                recordPin(frameNo);
+        }
+        
+        /**
+         * Add a frame to the list of frames of the file it was just assigned to
+         *
+         * @param frameNo	Frame to add
+         */
+        void linkFileFrame(FrameId frameNo)
+        {
+            BufDesc& desc = bufDescTable[frameNo];
+            if (desc.fileId() >= fileHead.size())
+            {
+                fileHead.resize(desc.fileId() + 1, NO_FRAME);
+            }
+            desc.filePrev = NO_FRAME;
+            desc.fileNext = fileHead[desc.fileId()];
+            if (desc.fileNext != NO_FRAME)
+            {
+                bufDescTable[desc.fileNext].filePrev = frameNo;
+            }
+            fileHead[desc.fileId()] = frameNo;
+        }
+        
+        /**
+         * Remove a frame from the list of frames of its file
+         *
+         * @param frameNo	Frame to remove
+         */
+        void unlinkFileFrame(FrameId frameNo)
+        {
+            const BufDesc& desc = bufDescTable[frameNo];
+            if (desc.filePrev != NO_FRAME)
+                bufDescTable[desc.filePrev].fileNext = desc.fileNext;
+            else
+                fileHead[desc.fileId()] = desc.fileNext;
+            if (desc.fileNext != NO_FRAME)
+                bufDescTable[desc.fileNext].filePrev = desc.filePrev;
+        }
+        
+        /**
+         * First frame holding a page of a file, or NO_FRAME
+         *
+         * @param file   	File object
+         */
+        FrameId firstFileFrame(const File* file) const
+        {
+            return file->id() < fileHead.size() ? fileHead[file->id()] : NO_FRAME;
+        }
+        
+        /**
+         * Note who is taking the first pin on a frame
+         *
+         * @param frameNo	Frame being pinned
+         */
+        void recordPin(FrameId frameNo)
+        {
+            PinRecord& record = pinRecords[frameNo];
+            record.since = std::chrono::steady_clock::now();
+            record.thread = std::this_thread::get_id();
+            record.site = pinSite;
+        }
+        
+        /**
+         * Pin a buffered frame once more and mark it referenced
+         *
+         * @param frameNo	Frame to pin
+         */
+        void pinFrame(FrameId frameNo)
+        {
+            if (BufState::pinCnt(bufState[frameNo]) == 0)
+            {
+                frameVersion[frameNo].fetch_add(1);
+                if (pinDiagnostics)
+                    recordPin(frameNo);
+                //changes made under this pin are logged from here on
+                if (log != NULL && !BufState::dirty(bufState[frameNo]))
+                    bufDescTable[frameNo].recLsn = log->endLsn();
+            }
+            bufState[frameNo] = (bufState[frameNo] | BufState::REF) + 1;
+        }
+        
+        /**
+         * Drop one pin of a frame that is known to be pinned
+         *
+         * @param frameNo	Frame to unpin
+         * @param dirty		True if the page needs to be marked dirty
+         */
+        void unpinFrame(FrameId frameNo, bool dirty)
+        {
+            bufState[frameNo] = (bufState[frameNo] - 1) | (dirty ? BufState::DIRTY : 0);
+            if (BufState::pinCnt(bufState[frameNo]) == 0)
+            {
+                frameVersion[frameNo].fetch_add(1);
+                if (evictionWaiters > 0)
+                    frameFreed.notify_one();
+            }
+        }
+        
+        /**
+         * Unpin a frame on behalf of a PageGuard, which is known to hold a pin on it
+         *
+         * @param frameNo	Frame to unpin
+         * @param dirty		True if the page in the frame needs to be marked dirty
+         */
+        void releaseFrame(FrameId frameNo, const bool dirty);
+        
+        /**
+         * Pin a page, reading it into a frame if it is not buffered.  The latch must be held.
+         *
+         * @param file   	File object
+         * @param pageNo  Page number in the file
+         * @return 		Frame holding the page
+         */
+        FrameId fetchFrame(File* file, const PageId pageNo);
+        
+        /**
+         * Bring in pages not in the pool, from the second-level cache or else the file.  The
+         * latch must be held.
+         *
+         * @param file   	File object
+         * @param pageNos	Pages to bring in, in increasing order, none of them buffered
+         * @param pages  	Receives the pages, in the order of pageNos
+         * @throws  InvalidPageException If a page read from the file doesn't exist
+         * @throws  ChecksumMismatchException If a page read from the file is damaged
+         */
+        void readMisses(File* file, const std::vector<PageId>& pageNos, std::vector<Page>& pages);
+        
+        /**
+         * Check a page just read from disk against its checksum, if its file checksums pages
+         *
+         * @param file   	File object the page was read from
+         * @param page		Page as read
+         * @throws  ChecksumMismatchException If the page does not match its checksum
+         */
+        static void verifyPage(const File* file, const Page& page);
+        
+        /**
+         * Allocates a new page in the file and pins it in a frame.  The latch must be held.
+         *
+         * @param file   	File object
+         * @param pageNo  Page number. The number assigned to the page in the file is returned via this reference.
+         * @return 		Frame holding the new page
+         */
+        FrameId newFrame(File* file, PageId& pageNo);
+        
+        /**
+         * Unpin a page found through the hash table; pages that are not buffered are ignored.  The
+         * latch must be held.
+         *
+         * @param file   	File object
+         * @param pageNo  Page number
+         * @param dirty		True if the page to be unpinned needs to be marked dirty
+         * @throws  PageNotPinnedException If the page is not already pinned
+         */
+        void releasePage(File* file, const PageId pageNo, const bool dirty);
+        
+        /**
+         * Write a dirty frame back to its file, flushing the log up to the page's LSN first.
+         * The latch must be held.
+         *
+         * @param frameNo	Frame to write
+         */
+        void writeBack(FrameId frameNo);
+        
+        /**
+         * Body of the thread started by flushFileAsync(): write the pages in batches, giving
+         * up the latch between batches, then retry the pinned ones with a growing pause.
+         *
+         * @param file   	File object
+         * @param pageNos	Dirty pages found when the flush started, in increasing order
+         * @param state		State of the flush, updated as pages are written
+         * @param batchPages	Number of pages examined per batch
+         * @param retryRounds	Number of times pinned pages are retried before they are skipped
+         */
+        void runAsyncFlush(const File* file, std::vector<PageId> pageNos, AsyncFlushState* state,
+                           const std::uint32_t batchPages, const std::uint32_t retryRounds);
+        
+        /**
+         * Write one batch of an asynchronous flush.  Pages no longer buffered or no longer
+         * dirty are passed over; pinned pages are left for a later retry.  The latch must be held.
+         *
+         * @param file   	File object
+         * @param pageNos	Pages of the batch, in increasing order
+         * @param pinned	Receives the pages that were pinned
+         * @return 		Number of pages written
+         */
+        std::uint32_t flushBatch(const File* file, const std::vector<PageId>& pageNos,
+                                 std::vector<PageId>& pinned);
+        
+        /**
+         * Join the threads of finished asynchronous flushes.  The latch must be held.
+         */
+        void reapAsyncFlushes();
+        
+        /**
+         * Load one batch of warmUp() pages into unpinned frames.  The latch must be held.  Stops at
+         * the first page that has to wait for a frame, since the pages read before the wait may
+         * have changed on disk during it.
+         *
+         * @param file   	File object
+         * @param pageNos	Pages to load, in increasing order, none of them buffered
+         * @return 		Number of pages loaded
+         */
+        std::uint32_t loadUnpinned(File* file, const std::vector<PageId>& pageNos);
+        
+        /**
+         * Fit the partitions to the current number of frames after a resize.  Partitions keep
+         * their first frame; the last one takes every frame beyond it, and partitions starting
+         * beyond the end of the pool are left empty.
+         *
+         * @param oldFrames	Number of frames before the resize; frames added are bound to the
+         *                 	node of their partition
+         */
+        void fitPartitions(std::uint32_t oldFrames);
+        
+        /**
+         * Size of the hash table for a pool of the given number of frames
+         */
+        static int hashTableSize(std::uint32_t frames)
+        {
+            return ((((int) (frames * 1.2))*2)/2)+1;
+        }
+        
+        /**
+         * Partition a page that is not yet buffered should be placed in
+         *
+         * @param file   	File object
+         * @param pageNo  Page number in the file
+         */
+        std::uint32_t partitionFor(const File* file, const PageId pageNo) const;
+        
+    public:
+        /**
+         * Actual buffer pool from which frames are allocated
+         */
+        Page* bufPool;
+        
+        /**
+         * Constructor of BufMgr class
+         *
+         * @param bufs   	Number of frames in the buffer pool
+         * @param options	Layout options for the buffer pool
+         */
+        BufMgr(std::uint32_t bufs, const BufMgrOptions& options = BufMgrOptions());
+        
+        /**
+         * Destructor of BufMgr class
+         */
+        ~BufMgr();
+        
+        /**
+         * Reads the given page from the file into a frame and returns the pointer to page.
+         * If the requested page is already present in the buffer pool pointer to that frame is returned
+         * otherwise a new frame is allocated from the buffer pool for reading the page.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number in the file to be read
+         * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+         */
+        void readPage(File* file, const PageId PageNo, Page*& page);
+        
+        /**
+         * Reads the page a PageRef refers to, going straight to the frame the reference remembers
+         * while the page is still in it and through the hash table (re-swizzling the reference)
+         * otherwise.
+         *
+         * @param ref   	Reference to the page; updated to the frame now holding it
+         * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+         */
+        void readPage(PageRef& ref, Page*& page);
+        
+        /**
+         * Reads the given page from the file into a frame and returns a guard holding the pin.
+         * The page is unpinned, clean, when the guard is destroyed.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number in the file to be read
+         * @return 		Guard giving read-only access to the page
+         */
+        ReadPageGuard readPageGuard(File* file, const PageId PageNo);
+        
+        /**
+         * Reads the given page from the file into a frame and returns a guard holding the pin.
+         * The page is unpinned and marked dirty when the guard is destroyed.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number in the file to be read
+         * @return 		Guard giving writable access to the page
+         */
+        WritePageGuard writePageGuard(File* file, const PageId PageNo);
+        
+        /**
+         * Reads several pages of one file into frames and returns pointers to them, as readPage would
+         * for each page in turn.  The hash probes for the whole batch are issued together, the pages
+         * that are not buffered are read from the file in page number order with consecutive pages
+         * coalesced into single reads, and the latch is taken once for the batch.  Either every page
+         * is pinned or, if an exception is thrown, none is.
+         *
+         * @param file   	File object
+         * @param pageNos	Page numbers in the file to be read; a page may appear more than once
+         * @param pages  	Receives a pointer to the frame of each page, in the order of pageNos
+         * @throws InvalidPageException If any page doesn't exist in the file
+         * @throws BufferExceededException If there are not enough unpinned frames for the pages not yet buffered
+         */
+        void readPages(File* file, const std::vector<PageId>& pageNos, std::vector<Page*>& pages);
+        
+        /**
+         * Unpin several pages of one file, as unPinPage would for each page in turn, under a single
+         * acquisition of the latch.
+         *
+         * @param file   	File object
+         * @param pageNos	Page numbers to unpin
+         * @param dirty		True if the pages need to be marked dirty
+         * @throws  PageNotPinnedException If a page is not pinned; the pages before it have been unpinned
+         */
+        void unPinPages(File* file, const std::vector<PageId>& pageNos, const bool dirty);
+        
+        /**
+         * Start an optimistic read of a buffered page.  Neither the pin count nor anything else
+         * in the frame is written, so readers of a hot page do not contend on its cache lines.
+         * The page may change or be evicted while it is being read; whatever was read must be
+         * discarded unless validate() succeeds afterwards.
+         *
+         * @param file   	File object
+         * @param pageNo  Page number in the file
+         * @param read   	Receives the frame, its version and the page when the read can go ahead
+         * @return 		False if the page is not buffered or is pinned; the caller should use readPage instead
+         */
+        bool tryReadOptimistic(File* file, const PageId pageNo, PageVersion& read);
+        
+        /**
+         * Check that the frame of an optimistic read was neither evicted nor pinned (and so possibly
+         * modified) since the read started.
+         *
+         * @param read   	Read started by tryReadOptimistic()
+         * @return 		True if everything read from the page since then is consistent
+         */
+        bool validate(const PageVersion& read) const
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return frameVersion[read.frameNo].load(std::memory_order_relaxed) == read.version;
+        }
+        
+        /**
+         * Run a read-only function over a page, optimistically when possible.  The function is
+         * retried while validation fails, so it must only read the page and must tolerate seeing
+         * torn contents (any exception it throws on an invalidated read is discarded).  After a
+         * few failed attempts, or if the page is not buffered, it runs once on a pinned page.
+         *
+         * @param file   	File object
+         * @param pageNo  Page number in the file
+         * @param reader 	Function called with a const Page&
+         */
+        template <typename Reader>
+        void readOptimistic(File* file, const PageId pageNo, Reader reader)
+        {
+            PageVersion read;
+            for (int attempt = 0; attempt < 4 && tryReadOptimistic(file, pageNo, read); attempt++)
+            {
+                try
+                {
+                    reader(*read.page);
+                }
+                catch (...)
+                {
+                    if (validate(read))
+                        throw;
+                    continue;
+                }
+                if (validate(read))
+                    return;
+            }
+            Page* page;
+            readPage(file, pageNo, page);
+            try
+            {
+                reader(*static_cast<const Page*>(page));
+            }
+            catch (...)
+            {
+                unPinPage(file, pageNo, false);
+                throw;
+            }
+            unPinPage(file, pageNo, false);
+        }
+        
+        /**
+         * Run a read-only function over the page a PageRef refers to.  While the reference is
+         * swizzled and its page unpinned this takes neither the latch nor a hash lookup; otherwise
+         * it reads through a pin, re-swizzling the reference.  The same rules as for the other
+         * readOptimistic() apply to the function.
+         *
+         * @param ref   	Reference to the page
+         * @param reader 	Function called with a const Page&
+         */
+        template <typename Reader>
+        void readOptimistic(PageRef& ref, Reader reader)
+        {
+            for (int attempt = 0; attempt < 4 && ref.isSwizzled(); attempt++)
+            {
+                PageVersion read;
+                read.frameNo = ref.frameNo;
+                read.version = frameVersion[read.frameNo].load(std::memory_order_acquire);
+                if (frameEpoch[read.frameNo].load(std::memory_order_acquire) != ref.epoch)
+                {
+                    ref.frameNo = PageRef::UNSWIZZLED;
+                    break;
+                }
+                if (read.version & 1)
+                {
+                    break;
+                }
+                read.page = &bufPool[read.frameNo];
+                try
+                {
+                    reader(*read.page);
+                }
+                catch (...)
+                {
+                    if (validate(read))
+                        throw;
+                    continue;
+                }
+                if (validate(read))
+                    return;
+            }
+            Page* page;
+            readPage(ref, page);
+            try
+            {
+                reader(*static_cast<const Page*>(page));
+            }
+            catch (...)
+            {
+                unPinPage(ref, false);
+                throw;
+            }
+            unPinPage(ref, false);
+        }
+        
+        /**
+         * Write the (file name, page number) of every buffered page to a file, so that a later
+         * warmUp() can bring the same pages back in after a restart.
+         *
+         * @param path		File to write the resident set to; replaced if it exists
+         * @return 		Number of pages written
+         * @throws  FileNotFoundException If the file cannot be created
+         */
+        std::uint32_t dumpResidentSet(const std::string& path);
+        
+        /**
+         * Bring the pages listed by dumpResidentSet() back into the pool, each file's pages in
+         * page order and in batches that are read with one I/O per run of consecutive pages.
+         * The latch is given up between batches so that other threads can use the pool while
+         * it warms up, which makes it practical to run this on a background thread at startup.
+         * Pages of files not given, pages that no longer exist and pages already buffered are
+         * skipped, and loading stops once the pool is full.  Loaded pages are left unpinned.
+         *
+         * @param path		File written by dumpResidentSet(); a missing file loads nothing
+         * @param files		Open files whose pages may be loaded, matched by file name
+         * @param batchPages	Number of pages read per batch
+         * @return 		Number of pages loaded
+         */
+        std::uint32_t warmUp(const std::string& path, const std::vector<File*>& files,
+                             const std::uint32_t batchPages = 64);
+        
+        /**
+         * Grow or shrink the buffer pool while it is in use.  Growing adds frames in address space
+         * reserved at construction (see BufMgrOptions::maxFrames), so pages already buffered
+         * stay where they are.  Shrinking writes back and evicts the pages in the frames being
+         * removed and gives their memory back to the system.  The hash table is rebuilt for the
+         * new size.
+         *
+         * @param newFrames	New number of frames
+         * @throws  BufferExceededException If newFrames is above the maximum the pool was created with
+         * @throws  PagePinnedException If a frame being removed is pinned; the pool is left unchanged
+         */
+        void resize(const std::uint32_t newFrames);
+        
+        /**
+         * Number of frames the pool can be grown to
+         */
+        std::uint32_t getMaxBufs() const
+        {
+            return maxBufs;
+        }
+        
+        /**
+         * Unpin a page from memory since it is no longer required for it to remain in memory.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number
+         * @param dirty		True if the page to be unpinned needs to be marked dirty
+         * @throws  PageNotPinnedException If the page is not already pinned
+         */
+        void unPinPage(File* file, const PageId PageNo, const bool dirty);
+        
+        /**
+         * Unpin the page a PageRef refers to, skipping the hash table while the reference is swizzled.
+         *
+         * @param ref   	Reference to the page
+         * @param dirty		True if the page to be unpinned needs to be marked dirty
+         * @throws  PageNotPinnedException If the page is not already pinned
+         */
+        void unPinPage(PageRef& ref, const bool dirty);
+        
+        /**
+         * Allocates a new, empty page in the file and returns the Page object.
+         * The newly allocated page is also assigned a frame in the buffer pool.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+         * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+         */
+        void allocPage(File* file, PageId &PageNo, Page*& page); 
+        
+        /**
+         * Allocates a new, empty page in the file and returns a guard holding the pin on it.
+         * The page is unpinned and marked dirty when the guard is destroyed.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+         * @return 		Guard giving writable access to the new page
+         */
+        WritePageGuard allocPageGuard(File* file, PageId& PageNo);
+        
+        /**
+         * Writes out all dirty pages of the file to disk.
+         * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
+         * Otherwise Error returned.  The file's pages also leave the second-level cache.
+         *
+         * @param file   	File object
+         * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
+         * @throws BadBufferException If any frame allocated to the file is found to be invalid
+         */
+        void flushFile(const File* file);
+        
+        /**
+         * Start writing out the dirty pages of the file on a background thread and return at
+         * once.  The set of dirty pages is taken when the call is made; they are written in page
+         * order, each run of consecutive pages with one write, and the latch is given up between
+         * batches so that the pool stays usable.  Unlike flushFile(), pages stay buffered (clean),
+         * and pinned pages do not fail the flush: they are retried after the other pages, with a
+         * growing pause between rounds, and left dirty if they are still pinned after the last one.
+         * The file must stay open until the flush is done.
+         *
+         * @param file   	File object
+         * @param batchPages	Number of pages examined while holding the latch
+         * @param retryRounds	Number of times pinned pages are retried before they are skipped
+         * @return 		Handle to poll, wait for or cancel the flush
+         */
+        FlushHandle flushFileAsync(const File* file, const std::uint32_t batchPages = 64,
+                                   const std::uint32_t retryRounds = 8);
+        
+        /**
+         * Take a fuzzy checkpoint: log the table of dirty and pinned pages with their recovery
+         * LSNs, without writing any page or waiting for pins to be released.  Recovery then
+         * starts from the oldest recovery LSN in the table; writing back the oldest dirty pages
+         * (see flushOldestDirty()) between checkpoints moves that point forward.  The log must
+         * not be shared with another pool.
+         *
+         * @return 		Redo LSN of the checkpoint, or 0 if the pool has no log
+         */
+        Lsn checkpoint();
+        
+        /**
+         * Write back the unpinned dirty pages with the oldest recovery LSNs, each file's in page
+         * order and each run of consecutive pages with one write.  Pages stay buffered.
+         *
+         * @param maxPages	Most pages to write
+         * @return 		Number of pages written
+         */
+        std::uint32_t flushOldestDirty(const std::uint32_t maxPages);
+        
+        /**
+         * Pick the unpinned dirty pages with the oldest recovery LSNs for flushSnapshot() to
+         * write back.  The pool is scanned once; picking a batch at a time from the snapshot
+         * instead of calling flushOldestDirty() for each keeps the latch from being held for
+         * a scan of every frame per batch.
+         *
+         * @param snapshot	Receives the pages, replacing what it held
+         * @param maxPages	Most pages to pick
+         */
+        void snapshotOldestDirty(DirtySnapshot& snapshot, const std::uint32_t maxPages);
+        
+        /**
+         * Write back the next pages of a snapshot, as flushOldestDirty() does.  Pages that
+         * have since been written back, evicted or pinned are skipped.
+         *
+         * @param snapshot	Snapshot taken by snapshotOldestDirty()
+         * @param maxPages	Most pages to write
+         * @return 		Number of pages written; below maxPages only once the snapshot is used up
+         */
+        std::uint32_t flushSnapshot(DirtySnapshot& snapshot, const std::uint32_t maxPages);
+        
+        /**
+         * Write-ahead log of the pool, or NULL
+         */
+        LogManager* getLog() const
+        {
+            return log;
+        }
+        
+        /**
+         * Second-level cache of the pool, or NULL
+         */
+        CacheTier* getTier() const
+        {
+            return tier;
+        }
+        
+        /**
+         * Drops every page of the file from the buffer pool without writing it back, as when
+         * the file is about to be removed.  Costs time in the number of pages of the file that
+         * are buffered, not in the size of the pool.  The file's pages also leave the
+         * second-level cache.
+         *
+         * @param file   	File object
+         * @throws  PagePinnedException If any page of the file is pinned in the buffer pool
+         */
+        void dropFile(const File* file);
+        
+        /**
+         * Counts the buffered, dirty and pinned pages of a file, in time proportional to the
+         * number of its pages that are buffered.
+         *
+         * @param file   	File object
+         */
+        FileStats getFileStats(const File* file);
+        
+        /**
+         * Delete page from file and also from buffer pool if present.
+         * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+         *
+         * @param file   	File object
+         * @param PageNo  Page number
+         */
+        void disposePage(File* file, const PageId PageNo);
+        
+        /**
+         * Print member variable values. 
+         */
+        void  printSelf();
+        
+        /**
+         * Get buffer pool usage statistics
+         */
+        BufStats & getBufStats()
+        {
+            return bufStats;
+        }
+        
+        /**
+         * Clear buffer pool usage statistics
+         */
+        void clearBufStats() 
+        {
+            bufStats.clear();
+        }
+        
+        /**
+         * Turn pin diagnostics on or off.  While on, the first pin of every frame is recorded
+         * with its thread, site label and time for dumpPinned(), and clock sweeps are counted
+         * in getPinStats().  While off they cost one predictable branch per pin and sweep.
+         *
+         * @param enabled	Whether to keep diagnostics
+         */
+        void setPinDiagnostics(const bool enabled);
+        
+        /**
+         * Label the pins the calling thread takes from now on (on any BufMgr), so that
+         * dumpPinned() can tell which code path holds them.
+         *
+         * @param site		Label with static storage duration, or NULL to clear it
+         */
+        static void setPinSite(const char* site)
+        {
+            pinSite = site;
+        }
+        
+        /**
+         * Report every frame that has been pinned for at least the given time, oldest first.
+         * Frames pinned while diagnostics were off are reported without owner.
+         *
+         * @param out		Stream to write the report to
+         * @param minSeconds	Only report pins held at least this long
+         * @return 		Number of frames reported
+         */
+        std::uint32_t dumpPinned(std::ostream& out, const double minSeconds = 0);
+        
+        /**
+         * Get the counters kept while pin diagnostics are on
+         */
+        PinStats getPinStats()
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            return pinStats;
+        }
+        
+        /**
+         * Clear the counters kept while pin diagnostics are on
+         */
+        void clearPinStats()
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            pinStats.clear();
+        }
+        
+        /**
+         * Get the counters of waits for a frame
+         */
+        WaitStats getWaitStats()
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            return waitStats;
+        }
+        
+        /**
+         * Clear the counters of waits for a frame
+         */
+        void clearWaitStats()
+        {
+            std::lock_guard<std::mutex> guard(bufLatch);
+            waitStats.clear();
+        }
+        
+        /**
+         * Number of partitions (NUMA nodes) the buffer pool is split into
+         */
+        std::uint32_t getNumPartitions() const
+        {
+            return numPartitions;
+        }
+        
+        /**
+         * Number of frames in the buffer pool
+         */
+        std::uint32_t getNumBufs() const
+        {
+            return numBufs;
+        }
+        
+        /**
+         * Replacement policy of the pool
+         */
+        ReplacementPolicy getReplacementPolicy() const
+        {
+            return replacement;
+        }
+        
+        /**
+         * Kind of memory the buffer pool frames are backed by
+         */
+        HugePageBacking hugePageBacking() const
+        {
+            return frameArena->backing();
         }
     };
     
@@ -0,0 +1,169 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <sstream>
+#include "buffer_pools.h"
+#include "exceptions/invalid_pool_exception.h"
+
+namespace badgerdb {
+
+    const PoolId BufPoolMgr::DEFAULT_POOL;
+
+    /**
+     * Constructor of BufPoolMgr class; creates the default pool
+     */
+    BufPoolMgr::BufPoolMgr(std::uint32_t defaultFrames, const BufMgrOptions& options)
+    {
+        addPool("default", defaultFrames, options);
+    }
+
+    /**
+     * Destructor of BufPoolMgr class
+     */
+    BufPoolMgr::~BufPoolMgr()
+    {
+        for (std::size_t p = 0; p < pools.size(); p++)
+        {
+            delete pools[p];
+        }
+    }
+
+    PoolId BufPoolMgr::addPool(const std::string& name, std::uint32_t frames, const BufMgrOptions& options)
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        for (std::size_t p = 0; p < names.size(); p++)
+        {
+            if (names[p] == name)
+            {
+                throw InvalidPoolException(name + " (already exists)");
+            }
+        }
+        pools.push_back(new BufMgr(frames, options));
+        names.push_back(name);
+        return (PoolId) (pools.size() - 1);
+    }
+
+    PoolId BufPoolMgr::addKeepPool(std::uint32_t frames)
+    {
+        return addPool("keep", frames);
+    }
+
+    PoolId BufPoolMgr::addRecyclePool(std::uint32_t frames)
+    {
+        BufMgrOptions options;
+        options.replacement = REPLACE_FIFO;
+        return addPool("recycle", frames, options);
+    }
+
+    PoolId BufPoolMgr::findPool(const std::string& name) const
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        for (std::size_t p = 0; p < names.size(); p++)
+        {
+            if (names[p] == name)
+            {
+                return (PoolId) p;
+            }
+        }
+        throw InvalidPoolException(name);
+    }
+
+    void BufPoolMgr::assign(const File* file, const PoolId pool)
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        if (pool >= pools.size())
+        {
+            std::ostringstream id;
+            id << pool;
+            throw InvalidPoolException(id.str());
+        }
+        std::unordered_map<std::string, PoolId>::iterator current = assignment.find(file->filename());
+        const PoolId from = current == assignment.end() ? DEFAULT_POOL : current->second;
+        if (from != pool)
+        {
+            //the old pool must not keep pages the new one will bring in again
+            pools[from]->flushFile(file);
+        }
+        if (pool == DEFAULT_POOL)
+        {
+            if (current != assignment.end())
+                assignment.erase(current);
+        }
+        else
+        {
+            assignment[file->filename()] = pool;
+        }
+    }
+
+    PoolId BufPoolMgr::poolOf(const File* file) const
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        if (assignment.empty())
+        {
+            return DEFAULT_POOL;
+        }
+        std::unordered_map<std::string, PoolId>::const_iterator found = assignment.find(file->filename());
+        return found == assignment.end() ? DEFAULT_POOL : found->second;
+    }
+
+    BufMgr& BufPoolMgr::poolFor(const File* file)
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        if (assignment.empty())
+        {
+            return *pools[DEFAULT_POOL];
+        }
+        std::unordered_map<std::string, PoolId>::const_iterator found = assignment.find(file->filename());
+        return *pools[found == assignment.end() ? DEFAULT_POOL : found->second];
+    }
+
+    BufMgr& BufPoolMgr::getPool(const PoolId pool)
+    {
+        std::lock_guard<std::mutex> guard(poolLatch);
+        if (pool >= pools.size())
+        {
+            std::ostringstream id;
+            id << pool;
+            throw InvalidPoolException(id.str());
+        }
+        return *pools[pool];
+    }
+
+    PoolStats BufPoolMgr::getPoolStats(const PoolId pool)
+    {
+        BufMgr& bufMgr = getPool(pool);
+        PoolStats stats;
+        stats.frames = bufMgr.getNumBufs();
+        stats.replacement = bufMgr.getReplacementPolicy();
+        stats.bufStats = bufMgr.getBufStats();
+
+        std::lock_guard<std::mutex> guard(poolLatch);
+        stats.name = names[pool];
+        stats.files = 0;
+        for (std::unordered_map<std::string, PoolId>::const_iterator it = assignment.begin();
+             it != assignment.end(); ++it)
+        {
+            if (it->second == pool)
+                stats.files++;
+        }
+        return stats;
+    }
+
+    void BufPoolMgr::printStats(std::ostream& out)
+    {
+        for (PoolId p = 0; p < getNumPools(); p++)
+        {
+            const PoolStats stats = getPoolStats(p);
+            out << "Pool:" << stats.name << " frames:" << stats.frames
+                << " replacement:" << (stats.replacement == REPLACE_FIFO ? "fifo" : "clock")
+                << " files:" << stats.files << " accesses:" << stats.bufStats.accesses
+                << " diskreads:" << stats.bufStats.diskreads << " diskwrites:" << stats.bufStats.diskwrites
+                << " hitRatio:" << stats.hitRatio() << "\n";
+        }
+    }
+
+}
@@ -0,0 +1,251 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include "buffer.h"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace badgerdb {
+
+    /**
+     * @brief Identifier of a pool within a BufPoolMgr
+     */
+    typedef std::uint32_t PoolId;
+
+
+    /**
+     * @brief Snapshot of the configuration and usage of one pool of a BufPoolMgr
+     */
+    struct PoolStats
+    {
+        /**
+         * Name of the pool
+         */
+        std::string name;
+
+        /**
+         * Number of frames in the pool
+         */
+        std::uint32_t frames;
+
+        /**
+         * Replacement policy of the pool
+         */
+        ReplacementPolicy replacement;
+
+        /**
+         * Number of files assigned to the pool; the default pool also serves every unassigned file
+         */
+        std::uint32_t files;
+
+        /**
+         * Accesses, disk reads and disk writes of the pool
+         */
+        BufStats bufStats;
+
+        /**
+         * Fraction of accesses that did not have to read from disk
+         */
+        double hitRatio() const
+        {
+            if (bufStats.accesses == 0)
+                return 0;
+            return 1.0 - (double) bufStats.diskreads / bufStats.accesses;
+        }
+    };
+
+
+    /**
+     * @brief Several independently sized buffer pools, with files routed to pools by assignment
+     *
+     * Every file is served by the default pool until it is assigned to another one, so that, for
+     * example, small hot lookup tables can be kept in a keep pool where large scans of archive
+     * tables cannot push them out, and those archive tables can be confined to a small recycle
+     * pool.  Files are assigned by name, so an assignment outlives the File object.
+     */
+    class BufPoolMgr
+    {
+    public:
+        /**
+         * Pool serving every file that is not assigned elsewhere
+         */
+        static const PoolId DEFAULT_POOL = 0;
+
+        /**
+         * Constructor of BufPoolMgr class; creates the default pool
+         *
+         * @param defaultFrames	Number of frames of the default pool
+         * @param options		Options of the default pool
+         */
+        BufPoolMgr(std::uint32_t defaultFrames, const BufMgrOptions& options = BufMgrOptions());
+
+        /**
+         * Destructor of BufPoolMgr class; destroys every pool, writing back dirty pages
+         */
+        ~BufPoolMgr();
+
+        /**
+         * Adds a pool
+         *
+         * @param name		Name of the pool, unique within this BufPoolMgr
+         * @param frames		Number of frames of the pool
+         * @param options		Options of the pool, including its replacement policy
+         * @return 		Identifier of the new pool
+         */
+        PoolId addPool(const std::string& name, std::uint32_t frames, const BufMgrOptions& options = BufMgrOptions());
+
+        /**
+         * Adds a pool named "keep" with clock replacement, for small tables that should stay resident
+         *
+         * @param frames		Number of frames of the pool
+         * @return 		Identifier of the new pool
+         */
+        PoolId addKeepPool(std::uint32_t frames);
+
+        /**
+         * Adds a pool named "recycle" with FIFO replacement, for large tables that are scanned
+         *
+         * @param frames		Number of frames of the pool
+         * @return 		Identifier of the new pool
+         */
+        PoolId addRecyclePool(std::uint32_t frames);
+
+        /**
+         * Looks up a pool by name
+         *
+         * @param name		Name of the pool
+         * @return 		Identifier of the pool
+         * @throws  InvalidPoolException If there is no pool of that name
+         */
+        PoolId findPool(const std::string& name) const;
+
+        /**
+         * Routes a file to a pool.  Pages of the file buffered in the pool that served it until
+         * now are written back and dropped from that pool first.
+         *
+         * @param file   	File object
+         * @param pool		Pool to serve the file from now on
+         * @throws  InvalidPoolException If the pool does not exist
+         * @throws  PagePinnedException If a page of the file is pinned in its current pool
+         */
+        void assign(const File* file, const PoolId pool);
+
+        /**
+         * Pool serving a file
+         *
+         * @param file   	File object
+         */
+        PoolId poolOf(const File* file) const;
+
+        /**
+         * The buffer manager of a pool
+         *
+         * @param pool		Pool identifier
+         * @throws  InvalidPoolException If the pool does not exist
+         */
+        BufMgr& getPool(const PoolId pool);
+
+        /**
+         * The buffer manager serving a file
+         *
+         * @param file   	File object
+         */
+        BufMgr& poolFor(const File* file);
+
+        /**
+         * Reads the given page from the file into a frame of the file's pool; see BufMgr::readPage
+         */
+        void readPage(File* file, const PageId PageNo, Page*& page)
+        {
+            poolFor(file).readPage(file, PageNo, page);
+        }
+
+        /**
+         * Unpin a page in the file's pool; see BufMgr::unPinPage
+         */
+        void unPinPage(File* file, const PageId PageNo, const bool dirty)
+        {
+            poolFor(file).unPinPage(file, PageNo, dirty);
+        }
+
+        /**
+         * Allocates a new page in the file, buffered in the file's pool; see BufMgr::allocPage
+         */
+        void allocPage(File* file, PageId& PageNo, Page*& page)
+        {
+            poolFor(file).allocPage(file, PageNo, page);
+        }
+
+        /**
+         * Writes out all dirty pages of the file from its pool; see BufMgr::flushFile
+         */
+        void flushFile(const File* file)
+        {
+            poolFor(file).flushFile(file);
+        }
+
+        /**
+         * Delete page from file and from its pool; see BufMgr::disposePage
+         */
+        void disposePage(File* file, const PageId PageNo)
+        {
+            poolFor(file).disposePage(file, PageNo);
+        }
+
+        /**
+         * Number of pools, including the default one
+         */
+        std::uint32_t getNumPools() const
+        {
+            return (std::uint32_t) pools.size();
+        }
+
+        /**
+         * Configuration and usage of a pool
+         *
+         * @param pool		Pool identifier
+         * @throws  InvalidPoolException If the pool does not exist
+         */
+        PoolStats getPoolStats(const PoolId pool);
+
+        /**
+         * Print the configuration and usage of every pool
+         *
+         * @param out		Stream to print to
+         */
+        void printStats(std::ostream& out);
+
+    private:
+        BufPoolMgr(const BufPoolMgr&);
+        BufPoolMgr& operator=(const BufPoolMgr&);
+
+        /**
+         * Buffer manager of each pool
+         */
+        std::vector<BufMgr*> pools;
+
+        /**
+         * Name of each pool
+         */
+        std::vector<std::string> names;
+
+        /**
+         * Pool of each assigned file, by file name
+         */
+        std::unordered_map<std::string, PoolId> assignment;
+
+        /**
+         * Latch protecting the pool list and the assignments
+         */
+        mutable std::mutex poolLatch;
+    };
+
+}
@@ -0,0 +1,139 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief Counters of a CacheTier
+     */
+    struct TierStats
+    {
+        /**
+         * Number of buffer pool misses that looked in the tier
+         */
+        std::uint64_t lookups;
+
+        /**
+         * Number of those found in the tier, each saving a read of the file
+         */
+        std::uint64_t hits;
+
+        /**
+         * Number of evicted pages the tier took in
+         */
+        std::uint64_t inserts;
+
+        /**
+         * Number of pages the tier dropped to stay within its capacity
+         */
+        std::uint64_t evictions;
+
+        /**
+         * Number of pages held now
+         */
+        std::uint64_t pages;
+
+        /**
+         * Bytes the held pages take now, bookkeeping included
+         */
+        std::uint64_t bytes;
+
+        /**
+         * Time spent storing pages (compressing or writing them)
+         */
+        std::uint64_t storeNanos;
+
+        /**
+         * Time spent loading pages back (reading and decompressing them)
+         */
+        std::uint64_t loadNanos;
+
+        /**
+         * Constructor of TierStats class; zeroed counters
+         */
+        TierStats()
+        : lookups(0), hits(0), inserts(0), evictions(0), pages(0), bytes(0), storeNanos(0), loadNanos(0)
+        {
+        }
+
+        /**
+         * Fraction of lookups that hit
+         */
+        double hitRatio() const
+        {
+            return lookups == 0 ? 0 : (double) hits / lookups;
+        }
+    };
+
+
+    /**
+     * @brief Second-level cache for clean pages evicted from a buffer pool
+     *
+     * A BufMgr given a tier in BufMgrOptions::tier offers it every page its replacement
+     * evicts (dirty pages once they have been written back), and looks in it on a miss before
+     * reading the file.  The tier is exclusive: a page found there goes back into the pool and
+     * leaves the tier.  Like the pool itself, a tier assumes the files change only through the
+     * buffer manager; the pool drops a file's pages from it in flushFile() and dropFile().
+     *
+     * A BufMgr calls its tier with its latch held, so a tier shared by several pools must
+     * serialize its callers itself.
+     */
+    class CacheTier
+    {
+    public:
+        /**
+         * Destructor of CacheTier class
+         */
+        virtual ~CacheTier()
+        {
+        }
+
+        /**
+         * Offer a clean page evicted from the pool.  The tier may keep it, make room for it by
+         * dropping older pages, or ignore it.
+         *
+         * @param key		File and page number of the page
+         * @param page		Contents of the page
+         */
+        virtual void put(const PageKey key, const Page& page) = 0;
+
+        /**
+         * Take a page out of the tier
+         *
+         * @param key		File and page number of the page
+         * @param page		Receives the contents of the page if it is held
+         * @return 		True if the page was held
+         */
+        virtual bool take(const PageKey key, Page& page) = 0;
+
+        /**
+         * Drop a page, if held
+         *
+         * @param key		File and page number of the page
+         */
+        virtual void erase(const PageKey key) = 0;
+
+        /**
+         * Drop every page of a file
+         *
+         * @param file		Identifier of the file
+         */
+        virtual void eraseFile(const FileId file) = 0;
+
+        /**
+         * Counters of the tier
+         */
+        virtual TierStats getStats() const = 0;
+    };
+
+}
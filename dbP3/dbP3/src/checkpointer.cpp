@@ -0,0 +1,138 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include "checkpointer.h"
+
+namespace badgerdb {
+
+    /**
+     * Constructor of Checkpointer class; starts the thread
+     */
+    Checkpointer::Checkpointer(BufMgr& bufMgr, const CheckpointOptions& options)
+    : bufMgr(bufMgr), options(options), stopping(false)
+    {
+        worker = std::thread(&Checkpointer::run, this);
+    }
+    
+    /**
+     * Destructor of Checkpointer class; stops the thread
+     */
+    Checkpointer::~Checkpointer()
+    {
+        try
+        {
+            stop();
+        }
+        catch (...)
+        {
+        }
+    }
+    
+    void Checkpointer::stop()
+    {
+        {
+            std::lock_guard<std::mutex> guard(latch);
+            stopping = true;
+            wake.notify_all();
+        }
+        if (worker.joinable())
+            worker.join();
+        std::exception_ptr failure;
+        {
+            std::lock_guard<std::mutex> guard(latch);
+            failure = error;
+            error = std::exception_ptr();
+        }
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+    
+    CheckpointStats Checkpointer::getStats() const
+    {
+        std::lock_guard<std::mutex> guard(latch);
+        CheckpointStats current = stats;
+        if (bufMgr.getLog() != NULL && current.checkpoints > 0)
+            current.redoBytes = bufMgr.getLog()->endLsn() - current.redoLsn;
+        return current;
+    }
+    
+    /**
+     * Body of the thread
+     */
+    void Checkpointer::run()
+    {
+        typedef std::chrono::steady_clock Clock;
+        const std::chrono::milliseconds tick(options.tickMillis > 0 ? options.tickMillis : 1);
+        const std::chrono::milliseconds interval(options.intervalMillis);
+        //unspent budget does not pile up into a burst larger than a few rounds' worth
+        const double burst = std::max<double>(Page::SIZE, options.bytesPerSecond * 4 * tick.count() / 1000.0);
+        const std::uint32_t batchPages = options.batchPages > 0 ? options.batchPages : 1;
+        double budget = 0;
+        Clock::time_point lastRound = Clock::now();
+        Clock::time_point lastCheckpoint = lastRound;
+        
+        std::unique_lock<std::mutex> lock(latch);
+        try
+        {
+            while (!stopping)
+            {
+                wake.wait_for(lock, tick);
+                if (stopping)
+                    break;
+                lock.unlock();
+                
+                const Clock::time_point now = Clock::now();
+                budget = std::min(burst, budget + options.bytesPerSecond *
+                                  std::chrono::duration<double>(now - lastRound).count());
+                lastRound = now;
+                std::uint64_t written = 0;
+                //one scan of the pool picks the pages of the whole round
+                DirtySnapshot snapshot;
+                if (budget >= Page::SIZE)
+                    bufMgr.snapshotOldestDirty(snapshot, (std::uint32_t) (budget / Page::SIZE));
+                while (budget >= Page::SIZE)
+                {
+                    const std::uint32_t wanted = std::min<std::uint32_t>(batchPages, (std::uint32_t) (budget / Page::SIZE));
+                    const std::uint32_t batch = bufMgr.flushSnapshot(snapshot, wanted);
+                    written += batch;
+                    budget -= (double) batch * Page::SIZE;
+                    if (batch < wanted)
+                    {
+                        //nothing left to write; an idle pool does not bank budget
+                        budget = 0;
+                        break;
+                    }
+                }
+                
+                Lsn redoLsn = 0;
+                const bool checkpointDue = now - lastCheckpoint >= interval;
+                if (checkpointDue)
+                {
+                    redoLsn = bufMgr.checkpoint();
+                    lastCheckpoint = now;
+                }
+                
+                lock.lock();
+                stats.pagesWritten += written;
+                if (checkpointDue)
+                {
+                    stats.checkpoints++;
+                    stats.redoLsn = redoLsn;
+                }
+            }
+        }
+        catch (...)
+        {
+            if (!lock.owns_lock())
+                lock.lock();
+            error = std::current_exception();
+        }
+    }
+
+}
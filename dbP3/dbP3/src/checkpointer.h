@@ -0,0 +1,178 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include "buffer.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace badgerdb {
+
+    /**
+     * @brief Options of a Checkpointer
+     */
+    struct CheckpointOptions
+    {
+        /**
+         * Bytes per second the background write-back of dirty pages may use; 0 only takes
+         * checkpoints
+         */
+        std::uint64_t bytesPerSecond;
+        
+        /**
+         * Time between checkpoints
+         */
+        std::uint32_t intervalMillis;
+        
+        /**
+         * Time between rounds of write-back; the budget of a round is spent at once
+         */
+        std::uint32_t tickMillis;
+        
+        /**
+         * Most pages written while holding the pool's latch, which bounds how long a
+         * foreground page fault can be held up by the write-back
+         */
+        std::uint32_t batchPages;
+        
+        /**
+         * Constructor of CheckpointOptions class; 16 MB/s, a checkpoint a second
+         */
+        CheckpointOptions()
+        : bytesPerSecond(16 * 1024 * 1024), intervalMillis(1000), tickMillis(10), batchPages(8)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief What a Checkpointer has done, and the recovery work it leaves
+     */
+    struct CheckpointStats
+    {
+        /**
+         * Number of checkpoints taken
+         */
+        std::uint64_t checkpoints;
+        
+        /**
+         * Number of dirty pages written back
+         */
+        std::uint64_t pagesWritten;
+        
+        /**
+         * Redo LSN of the last checkpoint
+         */
+        Lsn redoLsn;
+        
+        /**
+         * Bytes of log recovery would read if the system crashed now: from the redo LSN of the
+         * last checkpoint to the end of the log.  Together with the number of dirty pages
+         * (each read and written at most once) this bounds the time recovery takes.
+         */
+        std::uint64_t redoBytes;
+        
+        /**
+         * Constructor of CheckpointStats class
+         */
+        CheckpointStats()
+        : checkpoints(0), pagesWritten(0), redoLsn(0), redoBytes(0)
+        {
+        }
+    };
+    
+    
+    /**
+     * @brief Background thread taking fuzzy checkpoints of a buffer pool and trickling its
+     * oldest dirty pages to disk within an I/O budget
+     *
+     * Writing back the pages with the oldest recovery LSNs is what lets each checkpoint move
+     * the redo LSN forward, so the log recovery has to replay stays about as long as what the
+     * budget cannot keep up with.  The pool must have been given a LogManager.
+     */
+    class Checkpointer
+    {
+    public:
+        /**
+         * Constructor of Checkpointer class; starts the thread
+         *
+         * @param bufMgr		Pool to checkpoint; must outlive the Checkpointer
+         * @param options		Budget and intervals
+         */
+        Checkpointer(BufMgr& bufMgr, const CheckpointOptions& options = CheckpointOptions());
+        
+        /**
+         * Destructor of Checkpointer class; stops the thread
+         */
+        ~Checkpointer();
+        
+        /**
+         * Stop the thread, letting it finish the round it is in
+         *
+         * @throws  Whatever exception stopped the thread earlier, such as LogException
+         */
+        void stop();
+        
+        /**
+         * What the checkpointer has done so far, and the log recovery would read now
+         */
+        CheckpointStats getStats() const;
+        
+    private:
+        Checkpointer(const Checkpointer&);
+        Checkpointer& operator=(const Checkpointer&);
+        
+        /**
+         * Body of the thread
+         */
+        void run();
+        
+        /**
+         * Pool being checkpointed
+         */
+        BufMgr& bufMgr;
+        
+        /**
+         * Budget and intervals
+         */
+        const CheckpointOptions options;
+        
+        /**
+         * Counters, guarded by latch
+         */
+        CheckpointStats stats;
+        
+        /**
+         * Set to ask the thread to stop
+         */
+        bool stopping;
+        
+        /**
+         * Exception that stopped the thread, rethrown by stop()
+         */
+        std::exception_ptr error;
+        
+        /**
+         * Latch protecting stats, stopping and error
+         */
+        mutable std::mutex latch;
+        
+        /**
+         * Signalled to wake the thread up early when it is asked to stop
+         */
+        std::condition_variable wake;
+        
+        /**
+         * The checkpointing thread
+         */
+        std::thread worker;
+    };
+
+}
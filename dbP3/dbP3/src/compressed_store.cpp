@@ -0,0 +1,214 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "compressed_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "lz4.h"
+#include "page.h"
+
+namespace badgerdb {
+
+namespace {
+
+const std::uint32_t kExtentMagic = 0x58504442;  // "BDPX"
+
+// Extents are aligned to this, and get an eighth of their size again as slack
+// so that a page that gains a record can usually be rewritten in place.
+const std::uint32_t kExtentAlign = 64;
+
+std::uint32_t alignUp(const std::uint32_t length) {
+  return (length + kExtentAlign - 1) / kExtentAlign * kExtentAlign;
+}
+
+}
+
+const std::uint64_t CompressedStore::FIRST_EXTENT;
+
+CompressedStore::CompressedStore(std::fstream& stream)
+    : stream_(stream),
+      end_(FIRST_EXTENT),
+      sequence_(1),
+      buffer_(alignUp(sizeof(ExtentHeader) + Page::SIZE +
+                      (sizeof(ExtentHeader) + Page::SIZE) / 8)) {
+  load();
+}
+
+bool CompressedStore::read(const PageId page_number, char* page) {
+  if (!readExtent(page_number, Page::SIZE)) {
+    return false;
+  }
+  const Extent& extent = extents_[page_number];
+  const char* payload = &buffer_[sizeof(ExtentHeader)];
+  if (extent.length == Page::SIZE) {
+    std::memcpy(page, payload, Page::SIZE);
+    return true;
+  }
+  return lz4Decompress(payload, extent.length, page, Page::SIZE) ==
+         Page::SIZE;
+}
+
+bool CompressedStore::readPrefix(const PageId page_number, char* prefix,
+                                 const std::size_t length) {
+  // Every byte of output costs at most a byte of input plus the framing of
+  // its sequence, so twice the prefix (and a token's worth) is always enough.
+  if (!readExtent(page_number, 2 * length + 16)) {
+    return false;
+  }
+  const Extent& extent = extents_[page_number];
+  const char* payload = &buffer_[sizeof(ExtentHeader)];
+  if (extent.length == Page::SIZE) {
+    std::memcpy(prefix, payload, length);
+    return true;
+  }
+  return lz4DecompressPrefix(payload,
+                             std::min<std::size_t>(extent.length,
+                                                   2 * length + 16),
+                             prefix, length) == length;
+}
+
+void CompressedStore::write(const PageId page_number, const char* page) {
+  char* payload = &buffer_[sizeof(ExtentHeader)];
+  std::uint32_t length = (std::uint32_t) lz4Compress(
+      page, Page::SIZE, payload, Page::SIZE - 1);
+  if (length == 0) {
+    std::memcpy(payload, page, Page::SIZE);
+    length = Page::SIZE;
+  }
+  if (page_number >= extents_.size()) {
+    const Extent none = {0, 0, 0};
+    extents_.resize(page_number + 1, none);
+  }
+  Extent& extent = extents_[page_number];
+  const std::uint32_t needed = sizeof(ExtentHeader) + length;
+  if (extent.offset == 0 || extent.capacity < needed) {
+    if (extent.offset != 0) {
+      ++stats_.relocations;
+      stats_.storedBytes -= extent.capacity;
+      stats_.payloadBytes -= extent.length;
+    } else {
+      ++stats_.pages;
+    }
+    extent.offset = end_;
+    extent.capacity = alignUp(needed + needed / 8);
+    end_ += extent.capacity;
+    stats_.storedBytes += extent.capacity;
+  } else {
+    stats_.payloadBytes -= extent.length;
+  }
+  extent.length = length;
+  stats_.payloadBytes += length;
+
+  const ExtentHeader header = {kExtentMagic, page_number, extent.capacity,
+                               length, sequence_++};
+  std::memcpy(&buffer_[0], &header, sizeof(header));
+  // Pad a new extent at the end of the file out to its full capacity, so
+  // that the next one starts where the map says it does.
+  const std::size_t written =
+      extent.offset + extent.capacity == end_ ? extent.capacity : needed;
+  if (written > needed) {
+    std::memset(&buffer_[needed], 0, written - needed);
+  }
+  stream_.seekp(extent.offset, std::ios::beg);
+  stream_.write(&buffer_[0], written);
+  ++stats_.pagesWritten;
+  stats_.bytesWritten += written;
+}
+
+CompressionStats CompressedStore::stats() const {
+  CompressionStats stats = stats_;
+  stats.fileBytes = end_;
+  return stats;
+}
+
+bool CompressedStore::readExtent(const PageId page_number,
+                                 const std::size_t length) {
+  if (page_number >= extents_.size() || extents_[page_number].offset == 0) {
+    return false;
+  }
+  const Extent& extent = extents_[page_number];
+  const std::size_t bytes =
+      sizeof(ExtentHeader) + std::min<std::size_t>(length, extent.length);
+  stream_.seekg(extent.offset, std::ios::beg);
+  stream_.read(&buffer_[0], bytes);
+  ++stats_.pagesRead;
+  stats_.bytesRead += bytes;
+  ExtentHeader header;
+  std::memcpy(&header, &buffer_[0], sizeof(header));
+  if (!stream_ || header.magic != kExtentMagic ||
+      header.page_number != page_number) {
+    stream_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool CompressedStore::readHeader(const std::uint64_t offset,
+                                 const std::uint64_t size,
+                                 ExtentHeader& header) {
+  stream_.seekg(offset, std::ios::beg);
+  stream_.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream_) {
+    stream_.clear();
+    return false;
+  }
+  // Every page of the file has an extent of at least kExtentAlign bytes, so
+  // no page number can be above the number of those that fit.
+  return header.magic == kExtentMagic &&
+         header.page_number <= size / kExtentAlign &&
+         header.capacity % kExtentAlign == 0 &&
+         header.capacity >= sizeof(ExtentHeader) + header.length &&
+         header.capacity <= buffer_.size() &&
+         header.length > 0 && header.length <= Page::SIZE &&
+         offset + header.capacity <= size;
+}
+
+void CompressedStore::load() {
+  stream_.seekg(0, std::ios::end);
+  const std::uint64_t size = stream_.tellg();
+  std::vector<std::uint64_t> sequences;
+  std::uint64_t offset = FIRST_EXTENT;
+  while (offset + sizeof(ExtentHeader) <= size) {
+    ExtentHeader header;
+    if (!readHeader(offset, size, header)) {
+      // A torn write at the end of the file, or an extent damaged in the
+      // middle of it.  Extents start on kExtentAlign boundaries, so look for
+      // the next whole one there; the pages after the damage keep theirs.
+      offset += kExtentAlign;
+      continue;
+    }
+    if (header.page_number >= extents_.size()) {
+      const Extent none = {0, 0, 0};
+      extents_.resize(header.page_number + 1, none);
+      sequences.resize(header.page_number + 1, 0);
+    }
+    Extent& extent = extents_[header.page_number];
+    if (header.sequence > sequences[header.page_number]) {
+      if (extent.offset == 0) {
+        ++stats_.pages;
+      } else {
+        stats_.storedBytes -= extent.capacity;
+        stats_.payloadBytes -= extent.length;
+      }
+      extent.offset = offset;
+      extent.capacity = header.capacity;
+      extent.length = header.length;
+      stats_.storedBytes += extent.capacity;
+      stats_.payloadBytes += extent.length;
+      sequences[header.page_number] = header.sequence;
+    }
+    if (header.sequence >= sequence_) {
+      sequence_ = header.sequence + 1;
+    }
+    offset += header.capacity;
+    // Only a torn tail, with no whole extent after it, is written over.
+    end_ = offset;
+  }
+}
+}
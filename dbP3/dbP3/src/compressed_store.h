@@ -0,0 +1,241 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Footprint and I/O counters of a compressed file.
+ */
+struct CompressionStats {
+  /**
+   * Number of pages stored.
+   */
+  std::uint32_t pages;
+
+  /**
+   * Bytes the pages take in the file: their compressed payloads plus extent
+   * headers and the slack left for regrowing in place.
+   */
+  std::uint64_t storedBytes;
+
+  /**
+   * Compressed bytes of the pages alone.
+   */
+  std::uint64_t payloadBytes;
+
+  /**
+   * Size of the file, including extents of pages that have since moved.
+   */
+  std::uint64_t fileBytes;
+
+  /**
+   * Number of pages read since the file was opened.
+   */
+  std::uint64_t pagesRead;
+
+  /**
+   * Bytes read from the file for those pages.
+   */
+  std::uint64_t bytesRead;
+
+  /**
+   * Number of pages written since the file was opened.
+   */
+  std::uint64_t pagesWritten;
+
+  /**
+   * Bytes written to the file for those pages.
+   */
+  std::uint64_t bytesWritten;
+
+  /**
+   * Number of writes that outgrew a page's extent and moved it to the end of
+   * the file.
+   */
+  std::uint64_t relocations;
+
+  /**
+   * Constructs zeroed counters.
+   */
+  CompressionStats()
+      : pages(0),
+        storedBytes(0),
+        payloadBytes(0),
+        fileBytes(0),
+        pagesRead(0),
+        bytesRead(0),
+        pagesWritten(0),
+        bytesWritten(0),
+        relocations(0) {}
+};
+
+/**
+ * @brief Pages of a file stored LZ4-compressed, each in its own extent.
+ *
+ * Every page is written as an extent: a small header naming the page,
+ * followed by its compressed bytes and some slack.  A page that still fits in
+ * its extent is rewritten in place; one that has outgrown it gets a new
+ * extent at the end of the file, and the old one becomes dead space.  Pages
+ * that do not compress are stored as they are.
+ *
+ * The map from page number to extent lives only in memory.  It is rebuilt
+ * when the file is opened by walking the extent headers, where the one with
+ * the highest sequence number wins for each page.  A torn extent at the end
+ * of the file is ignored and written over; a damaged one in the middle is
+ * skipped, so only its own page is lost.
+ *
+ * @warning This class is not threadsafe.
+ */
+class CompressedStore {
+ public:
+  /**
+   * Offset of the first extent in the file; everything before it belongs to
+   * the file header.
+   */
+  static const std::uint64_t FIRST_EXTENT = 64;
+
+  /**
+   * Constructs a store over the extents of an open file, reading its map.
+   *
+   * @param stream  Stream of the file, shared with its File objects.
+   */
+  explicit CompressedStore(std::fstream& stream);
+
+  /**
+   * Reads and decompresses a page.
+   *
+   * @param page_number  Number of the page.
+   * @param page         Receives the Page::SIZE bytes of the page.
+   * @return  False if the page was never written or its extent is damaged;
+   *          <page> is left alone then.
+   */
+  bool read(const PageId page_number, char* page);
+
+  /**
+   * Reads and decompresses only the start of a page, such as its header.
+   *
+   * @param page_number  Number of the page.
+   * @param prefix       Receives the first <length> bytes of the page.
+   * @param length       Number of bytes wanted.
+   * @return  False if the page was never written or its extent is damaged.
+   */
+  bool readPrefix(const PageId page_number, char* prefix,
+                  const std::size_t length);
+
+  /**
+   * Compresses and writes a page.  The stream is not flushed.
+   *
+   * @param page_number  Number of the page.
+   * @param page         The Page::SIZE bytes of the page.
+   */
+  void write(const PageId page_number, const char* page);
+
+  /**
+   * Returns the footprint of the file and the counters since it was opened.
+   */
+  CompressionStats stats() const;
+
+ private:
+  /**
+   * Where a page is stored.
+   */
+  struct Extent {
+    /**
+     * Offset of the extent in the file, or 0 if the page has none.
+     */
+    std::uint64_t offset;
+
+    /**
+     * Length of the extent, header and slack included.
+     */
+    std::uint32_t capacity;
+
+    /**
+     * Length of the compressed page; Page::SIZE if stored uncompressed.
+     */
+    std::uint32_t length;
+  };
+
+  /**
+   * Header at the start of every extent.
+   */
+  struct ExtentHeader {
+    std::uint32_t magic;
+    PageId page_number;
+    std::uint32_t capacity;
+    std::uint32_t length;
+    std::uint64_t sequence;
+  };
+
+  /**
+   * Walks the extents of the file to build the map.
+   */
+  void load();
+
+  /**
+   * Reads the header of the extent at an offset and checks that it is whole.
+   *
+   * @param offset  Offset of the extent in the file.
+   * @param size    Size of the file.
+   * @param header  Receives the header.
+   * @return  False if there is no whole extent at <offset>.
+   */
+  bool readHeader(const std::uint64_t offset, const std::uint64_t size,
+                  ExtentHeader& header);
+
+  /**
+   * Reads the header of a page's extent and the first bytes of its payload
+   * into buffer_.
+   *
+   * @param page_number  Number of the page.
+   * @param length       Number of payload bytes to read, at most the
+   *                     extent's.
+   * @return  False if the page has no extent or it is damaged.
+   */
+  bool readExtent(const PageId page_number, const std::size_t length);
+
+  /**
+   * Stream of the file.
+   */
+  std::fstream& stream_;
+
+  /**
+   * Extent of each page, indexed by page number.
+   */
+  std::vector<Extent> extents_;
+
+  /**
+   * Offset just past the last extent, where new extents are appended.
+   */
+  std::uint64_t end_;
+
+  /**
+   * Sequence number of the next extent header written.
+   */
+  std::uint64_t sequence_;
+
+  /**
+   * Buffer for one extent.
+   */
+  std::vector<char> buffer_;
+
+  /**
+   * Footprint and counters.
+   */
+  CompressionStats stats_;
+};
+
+}
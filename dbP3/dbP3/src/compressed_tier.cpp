@@ -0,0 +1,120 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <chrono>
+#include <cstring>
+#include "compressed_tier.h"
+#include "lz4.h"
+
+namespace badgerdb {
+
+    const std::uint32_t CompressedTier::ENTRY_OVERHEAD;
+
+    /**
+     * Constructor of CompressedTier class
+     */
+    CompressedTier::CompressedTier(const std::uint64_t capacityBytes, const bool compress)
+    : capacityBytes(capacityBytes), compress(compress), scratch(Page::SIZE)
+    {
+    }
+
+    void CompressedTier::put(const PageKey key, const Page& page)
+    {
+        EntryMap::iterator existing = entries.find(key);
+        if (existing != entries.end())
+        {
+            drop(existing);
+        }
+        const char* raw = reinterpret_cast<const char*>(&page);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::size_t length = compress ? lz4Compress(raw, Page::SIZE, &scratch[0], Page::SIZE - 1) : 0;
+        if (length == 0)
+        {
+            std::memcpy(&scratch[0], raw, Page::SIZE);
+            length = Page::SIZE;
+        }
+        stats.storeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        
+        const std::uint64_t cost = length + ENTRY_OVERHEAD;
+        if (cost > capacityBytes)
+        {
+            return;
+        }
+        while (stats.bytes + cost > capacityBytes)
+        {
+            drop(entries.find(ages.front()));
+            stats.evictions++;
+        }
+        Entry& entry = entries[key];
+        entry.data.assign(scratch.begin(), scratch.begin() + length);
+        entry.age = ages.insert(ages.end(), key);
+        stats.inserts++;
+        stats.pages++;
+        stats.bytes += cost;
+    }
+
+    bool CompressedTier::take(const PageKey key, Page& page)
+    {
+        stats.lookups++;
+        EntryMap::iterator entry = entries.find(key);
+        if (entry == entries.end())
+        {
+            return false;
+        }
+        const std::vector<char>& data = entry->second.data;
+        char* raw = reinterpret_cast<char*>(&page);
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool intact = true;
+        if (data.size() == Page::SIZE)
+        {
+            std::memcpy(raw, &data[0], Page::SIZE);
+        }
+        else
+        {
+            intact = lz4Decompress(&data[0], data.size(), raw, Page::SIZE) == Page::SIZE;
+        }
+        stats.loadNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        drop(entry);
+        if (intact)
+        {
+            stats.hits++;
+        }
+        return intact;
+    }
+
+    void CompressedTier::erase(const PageKey key)
+    {
+        EntryMap::iterator entry = entries.find(key);
+        if (entry != entries.end())
+        {
+            drop(entry);
+        }
+    }
+
+    void CompressedTier::eraseFile(const FileId file)
+    {
+        EntryMap::iterator entry = entries.lower_bound(makePageKey(file, 0));
+        while (entry != entries.end() && (FileId) (entry->first >> 32) == file)
+        {
+            drop(entry++);
+        }
+    }
+
+    /**
+     * Drop a held page
+     */
+    void CompressedTier::drop(EntryMap::iterator entry)
+    {
+        stats.pages--;
+        stats.bytes -= entry->second.data.size() + ENTRY_OVERHEAD;
+        ages.erase(entry->second.age);
+        entries.erase(entry);
+    }
+
+}
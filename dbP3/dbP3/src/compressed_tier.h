@@ -0,0 +1,112 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+#include "cache_tier.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief CacheTier holding evicted pages in memory, LZ4-compressed
+     *
+     * Pages that do not compress, or all pages if compression is turned off, are held as
+     * plain copies.  When the tier is full the pages held longest are dropped first; since a
+     * page found in the tier leaves it, that is also the least recently used one.
+     *
+     * @warning This class is not threadsafe.
+     */
+    class CompressedTier : public CacheTier
+    {
+    public:
+        /**
+         * Bytes of bookkeeping counted for each held page on top of its contents
+         */
+        static const std::uint32_t ENTRY_OVERHEAD = 96;
+
+        /**
+         * Constructor of CompressedTier class
+         *
+         * @param capacityBytes	Most bytes the held pages may take, bookkeeping included
+         * @param compress		Whether to compress the pages or hold plain copies
+         */
+        explicit CompressedTier(const std::uint64_t capacityBytes, const bool compress = true);
+
+        virtual void put(const PageKey key, const Page& page);
+
+        virtual bool take(const PageKey key, Page& page);
+
+        virtual void erase(const PageKey key);
+
+        virtual void eraseFile(const FileId file);
+
+        virtual TierStats getStats() const
+        {
+            return stats;
+        }
+
+    private:
+        /**
+         * A held page
+         */
+        struct Entry
+        {
+            /**
+             * Contents, compressed unless exactly Page::SIZE bytes long
+             */
+            std::vector<char> data;
+
+            /**
+             * Position of the page in ages
+             */
+            std::list<PageKey>::iterator age;
+        };
+
+        typedef std::map<PageKey, Entry> EntryMap;
+
+        /**
+         * Drop a held page
+         *
+         * @param entry		Page to drop
+         */
+        void drop(EntryMap::iterator entry);
+
+        /**
+         * Held pages, ordered so that the pages of a file are adjacent
+         */
+        EntryMap entries;
+
+        /**
+         * Held pages, the one held longest first
+         */
+        std::list<PageKey> ages;
+
+        /**
+         * Most bytes the held pages may take
+         */
+        const std::uint64_t capacityBytes;
+
+        /**
+         * Whether pages are compressed
+         */
+        const bool compress;
+
+        /**
+         * Buffer to compress into
+         */
+        std::vector<char> scratch;
+
+        /**
+         * Counters
+         */
+        TierStats stats;
+    };
+
+}
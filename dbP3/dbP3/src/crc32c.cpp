@@ -0,0 +1,132 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "crc32c.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace badgerdb {
+
+namespace {
+
+// Reflected Castagnoli polynomial.
+const std::uint32_t kPolynomial = 0x82F63B78;
+
+// tables[0] is the usual byte-at-a-time table; tables[k][b] is the CRC of
+// byte b followed by k zero bytes, so eight bytes can be folded at once.
+struct Tables {
+  std::uint32_t entries[8][256];
+
+  Tables() {
+    for (std::uint32_t b = 0; b < 256; ++b) {
+      std::uint32_t crc = b;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc >> 1) ^ (kPolynomial & (0 - (crc & 1)));
+      }
+      entries[0][b] = crc;
+    }
+    for (std::uint32_t b = 0; b < 256; ++b) {
+      for (int k = 1; k < 8; ++k) {
+        const std::uint32_t previous = entries[k - 1][b];
+        entries[k][b] = (previous >> 8) ^ entries[0][previous & 0xFF];
+      }
+    }
+  }
+};
+
+const Tables& tables() {
+  static const Tables instance;
+  return instance;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2")))
+std::uint32_t crc32cSse42(const void* data, const std::size_t length,
+                          const std::uint32_t crc) {
+  const unsigned char* next = static_cast<const unsigned char*>(data);
+  std::size_t left = length;
+  std::uint64_t state = ~crc;
+  while (left > 0 && (reinterpret_cast<std::uintptr_t>(next) & 7) != 0) {
+    state = _mm_crc32_u8((std::uint32_t) state, *next++);
+    --left;
+  }
+  while (left >= 8) {
+    std::uint64_t word;
+    std::memcpy(&word, next, sizeof(word));
+    state = _mm_crc32_u64(state, word);
+    next += 8;
+    left -= 8;
+  }
+  while (left > 0) {
+    state = _mm_crc32_u8((std::uint32_t) state, *next++);
+    --left;
+  }
+  return ~(std::uint32_t) state;
+}
+
+#endif
+
+typedef std::uint32_t (*Crc32cFunction)(const void*, const std::size_t,
+                                        const std::uint32_t);
+
+Crc32cFunction chooseCrc32c() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("sse4.2")) {
+    return crc32cSse42;
+  }
+#endif
+  return crc32cPortable;
+}
+
+const Crc32cFunction kCrc32c = chooseCrc32c();
+
+}
+
+std::uint32_t crc32c(const void* data, const std::size_t length,
+                     const std::uint32_t crc) {
+  return kCrc32c(data, length, crc);
+}
+
+std::uint32_t crc32cPortable(const void* data, const std::size_t length,
+                             const std::uint32_t crc) {
+  const Tables& t = tables();
+  const unsigned char* next = static_cast<const unsigned char*>(data);
+  std::size_t left = length;
+  std::uint32_t state = ~crc;
+  while (left >= 8) {
+    // Little-endian load; the tables assume the first byte is the lowest.
+    const std::uint32_t low = state ^ (next[0] | (next[1] << 8) |
+                                       (next[2] << 16) |
+                                       ((std::uint32_t) next[3] << 24));
+    state = t.entries[7][low & 0xFF] ^ t.entries[6][(low >> 8) & 0xFF] ^
+            t.entries[5][(low >> 16) & 0xFF] ^ t.entries[4][low >> 24] ^
+            t.entries[3][next[4]] ^ t.entries[2][next[5]] ^
+            t.entries[1][next[6]] ^ t.entries[0][next[7]];
+    next += 8;
+    left -= 8;
+  }
+  while (left > 0) {
+    state = (state >> 8) ^ t.entries[0][(state ^ *next++) & 0xFF];
+    --left;
+  }
+  return ~state;
+}
+
+bool crc32cHardware() {
+#if defined(__x86_64__)
+  return kCrc32c == crc32cSse42;
+#else
+  return false;
+#endif
+}
+
+}
@@ -0,0 +1,46 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace badgerdb {
+
+/**
+ * Computes the CRC-32C (Castagnoli) of a buffer, using the CPU's CRC32
+ * instruction when it has one and a table-driven implementation otherwise.
+ * The result of one call can be passed as <crc> to the next to checksum data
+ * spread over several buffers.
+ *
+ * @param data    First byte of the buffer.
+ * @param length  Length of the buffer in bytes.
+ * @param crc     CRC of the data before the buffer, or 0.
+ * @return  CRC of the data up to and including the buffer.
+ */
+std::uint32_t crc32c(const void* data, const std::size_t length,
+                     const std::uint32_t crc = 0);
+
+/**
+ * Computes the same CRC as crc32c() without the CRC32 instruction, eight
+ * bytes at a time through lookup tables.
+ *
+ * @param data    First byte of the buffer.
+ * @param length  Length of the buffer in bytes.
+ * @param crc     CRC of the data before the buffer, or 0.
+ * @return  CRC of the data up to and including the buffer.
+ */
+std::uint32_t crc32cPortable(const void* data, const std::size_t length,
+                             const std::uint32_t crc = 0);
+
+/**
+ * Returns whether crc32c() uses the CPU's CRC32 instruction.
+ */
+bool crc32cHardware();
+
+}
@@ -0,0 +1,27 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "checksum_mismatch_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+ChecksumMismatchException::ChecksumMismatchException(
+    const PageId requested_number, const std::string& file)
+    : BadgerDbException(""),
+      page_number_(requested_number),
+      filename_(file) {
+  std::stringstream ss;
+  ss << "Checksum mismatch reading a page."
+     << " Page " << page_number_
+     << " from file '" << filename_ << "'";
+  message_.assign(ss.str());
+}
+
+}
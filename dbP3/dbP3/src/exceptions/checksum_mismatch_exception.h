@@ -0,0 +1,64 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a page read from a file does not
+ *        match the checksum it was written with.
+ *
+ * This means the page was damaged on its way to or from the disk (or by a
+ * torn write), so its contents cannot be trusted.
+ */
+class ChecksumMismatchException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a checksum mismatch exception for the given page number
+   * and filename.
+   *
+   * @param requested_number  Number of the damaged page.
+   * @param file              Name of file the page was read from.
+   */
+  ChecksumMismatchException(const PageId requested_number,
+                            const std::string& file);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~ChecksumMismatchException() throw() {}
+
+  /**
+   * Returns the number of the page that caused this exception.
+   */
+  virtual PageId page_number() const { return page_number_; }
+
+  /**
+   * Returns name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Number of the page which caused this exception.
+   */
+  const PageId page_number_;
+
+  /**
+   * Name of file which caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
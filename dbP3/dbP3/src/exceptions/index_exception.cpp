@@ -0,0 +1,23 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "index_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+IndexException::IndexException(const std::string& filenameIn,
+                               const std::string& reasonIn)
+    : BadgerDbException(""), filename(filenameIn), reason(reasonIn) {
+  std::stringstream ss;
+  ss << "Index operation failed. file: " << filename << " reason: " << reason;
+  message_.assign(ss.str());
+}
+
+}
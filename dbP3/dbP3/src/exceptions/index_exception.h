@@ -0,0 +1,39 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when an index is given a key or input it
+ * cannot take, or its file is not an index of the expected kind.
+ */
+class IndexException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an index exception for the given index file and reason.
+   */
+  IndexException(const std::string& filenameIn, const std::string& reasonIn);
+
+ protected:
+  /**
+   * Name of the index file.
+   */
+  const std::string filename;
+
+  /**
+   * What was wrong.
+   */
+  const std::string reason;
+};
+
+}
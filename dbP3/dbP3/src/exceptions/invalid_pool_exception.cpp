@@ -0,0 +1,22 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "invalid_pool_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+InvalidPoolException::InvalidPoolException(const std::string& poolIn)
+    : BadgerDbException(""), pool(poolIn) {
+  std::stringstream ss;
+  ss << "Request for a buffer pool that does not exist. pool: " << pool;
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,33 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a buffer pool that does not exist is requested.
+ */
+class InvalidPoolException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid pool exception for the given pool.
+   */
+  explicit InvalidPoolException(const std::string& poolIn);
+
+ protected:
+  /**
+   * Pool (number or name) that was requested.
+   */
+  const std::string pool;
+};
+
+}
@@ -0,0 +1,39 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when the write-ahead log cannot be read
+ * or written.
+ */
+class LogException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a log exception for the given log file and failed operation.
+   */
+  LogException(const std::string& pathIn, const std::string& operationIn);
+
+ protected:
+  /**
+   * Path of the log file.
+   */
+  const std::string path;
+
+  /**
+   * Operation that failed.
+   */
+  const std::string operation;
+};
+
+}
@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "tier_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+TierException::TierException(const std::string& pathIn,
+                             const std::string& operationIn)
+    : BadgerDbException(""), path(pathIn), operation(operationIn) {
+  std::stringstream ss;
+  ss << "Cache tier operation failed. file: " << path
+     << " operation: " << operation;
+  message_.assign(ss.str());
+}
+
+}
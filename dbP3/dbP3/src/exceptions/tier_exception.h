@@ -0,0 +1,39 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when the cache file of a tier cannot be
+ * created or opened.
+ */
+class TierException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a tier exception for the given cache file and failed operation.
+   */
+  TierException(const std::string& pathIn, const std::string& operationIn);
+
+ protected:
+  /**
+   * Path of the cache file.
+   */
+  const std::string path;
+
+  /**
+   * Operation that failed.
+   */
+  const std::string operation;
+};
+
+}
@@ -14,6 +14,7 @@
 #include <cstdio>
 #include <cassert>
 
+#include "exceptions/checksum_mismatch_exception.h"
 #include "exceptions/file_exists_exception.h"
 #include "exceptions/file_not_found_exception.h"
 #include "exceptions/file_open_exception.h"
@@ -25,11 +26,18 @@ namespace badgerdb {
 
 File::StreamMap File::open_streams_;
 File::CountMap File::open_counts_;
+File::StoreMap File::open_stores_;
+File::IdMap File::file_ids_;
+std::vector<bool> File::checksums_off_;
 
 File File::create(const std::string& filename) {
   return File(filename, true /* create_new */);
 }
 
+File File::createCompressed(const std::string& filename) {
+  return File(filename, true /* create_new */, true /* compress */);
+}
+
 File File::open(const std::string& filename) {
   return File(filename, false /* create_new */);
 }
@@ -64,7 +72,9 @@ bool File::exists(const std::string& filename) {
 
 File::File(const File& other)
   : filename_(other.filename_),
-    stream_(open_streams_[filename_]) {
+    id_(other.id_),
+    stream_(open_streams_[filename_]),
+    store_(other.store_) {
   ++open_counts_[filename_];
 }
 
@@ -123,14 +133,11 @@ Page File::allocatePage() {
       header.first_used_page = new_page.page_number();
     } else {
       // If we have pages allocated, we need to add the new page to the tail
-      // of the linked list.
-      for (FileIterator iter = begin(); iter != end(); ++iter) {
-        if ((*iter).next_page_number() == Page::INVALID_NUMBER) {
-          existing_page = *iter;
-          break;
-        }
-      }
-      assert(existing_page.isUsed());
+      // of the linked list.  With no free pages every page is in use and the
+      // list is in page order, so the tail is the last page of the file.
+      existing_page = readPage(header.num_pages - 1);
+      assert(existing_page.isUsed() &&
+             existing_page.next_page_number() == Page::INVALID_NUMBER);
       existing_page.set_next_page_number(new_page.page_number());
     }
     ++header.num_pages;
@@ -156,9 +163,16 @@ Page File::readPage(const PageId page_number) const {
 
 Page File::readPage(const PageId page_number, const bool allow_free) const {
   Page page;
-  stream_->seekg(pagePosition(page_number), std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&page.header_), sizeof(page.header_));
-  stream_->read(reinterpret_cast<char*>(&page.data_[0]), Page::DATA_SIZE);
+  if (store_) {
+    if (!store_->read(page_number, reinterpret_cast<char*>(&page))) {
+      throw ChecksumMismatchException(page_number, filename_);
+    }
+  } else {
+    stream_->seekg(pagePosition(page_number), std::ios::beg);
+    stream_->read(reinterpret_cast<char*>(&page.header_),
+                  sizeof(page.header_));
+    stream_->read(reinterpret_cast<char*>(&page.data_[0]), Page::DATA_SIZE);
+  }
   if (!allow_free && !page.isUsed()) {
     throw InvalidPageException(page_number, filename_);
   }
@@ -166,6 +180,44 @@ Page File::readPage(const PageId page_number, const bool allow_free) const {
   return page;
 }
 
+void File::readPages(const std::vector<PageId>& page_numbers,
+                     std::vector<Page>& pages) const {
+  pages.resize(page_numbers.size());
+  if (page_numbers.empty()) {
+    return;
+  }
+  const FileHeader header = readHeader();
+  if (page_numbers.back() >= header.num_pages) {
+    throw InvalidPageException(page_numbers.back(), filename_);
+  }
+  if (store_) {
+    for (std::size_t i = 0; i < page_numbers.size(); ++i) {
+      if (!store_->read(page_numbers[i], reinterpret_cast<char*>(&pages[i]))) {
+        throw ChecksumMismatchException(page_numbers[i], filename_);
+      }
+    }
+  }
+  // Pages are laid out on disk exactly as in memory, so each run of
+  // consecutive page numbers lands directly in consecutive vector entries.
+  std::size_t run_start = store_ ? page_numbers.size() : 0;
+  while (run_start < page_numbers.size()) {
+    std::size_t run_end = run_start + 1;
+    while (run_end < page_numbers.size() &&
+           page_numbers[run_end] == page_numbers[run_end - 1] + 1) {
+      ++run_end;
+    }
+    stream_->seekg(pagePosition(page_numbers[run_start]), std::ios::beg);
+    stream_->read(reinterpret_cast<char*>(&pages[run_start]),
+                  (run_end - run_start) * Page::SIZE);
+    run_start = run_end;
+  }
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    if (!pages[i].isUsed()) {
+      throw InvalidPageException(page_numbers[i], filename_);
+    }
+  }
+}
+
 void File::writePage(const Page& new_page) {
   PageHeader header = readPageHeader(new_page.page_number());
   if (header.current_page_number == Page::INVALID_NUMBER) {
@@ -181,6 +233,64 @@ void File::writePage(const Page& new_page) {
   writePage(new_page.page_number(), header, new_page);
 }
 
+void File::writePages(const std::vector<const Page*>& pages) {
+  if (pages.empty()) {
+    return;
+  }
+  // Stage the pages contiguously, keeping the on-disk next page pointers just
+  // as writePage() does, so that each run goes out in one write.
+  std::vector<Page> staged(pages.size());
+  for (std::size_t i = 0; i < pages.size(); ++i) {
+    PageHeader header = readPageHeader(pages[i]->page_number());
+    if (header.current_page_number == Page::INVALID_NUMBER) {
+      throw InvalidPageException(pages[i]->page_number(), filename_);
+    }
+    const PageId next_page_number = header.next_page_number;
+    staged[i] = *pages[i];
+    staged[i].header_.next_page_number = next_page_number;
+    stampChecksum(staged[i].header_, staged[i].data_);
+    if (store_) {
+      store_->write(staged[i].page_number(),
+                    reinterpret_cast<const char*>(&staged[i]));
+    }
+  }
+  std::size_t run_start = store_ ? staged.size() : 0;
+  while (run_start < staged.size()) {
+    std::size_t run_end = run_start + 1;
+    while (run_end < staged.size() &&
+           staged[run_end].page_number() ==
+               staged[run_end - 1].page_number() + 1) {
+      ++run_end;
+    }
+    stream_->seekp(pagePosition(staged[run_start].page_number()),
+                   std::ios::beg);
+    stream_->write(reinterpret_cast<const char*>(&staged[run_start]),
+                   (run_end - run_start) * Page::SIZE);
+    run_start = run_end;
+  }
+  stream_->flush();
+}
+
+PageId File::numPages() const {
+  // The header counts itself as page 0.
+  return readHeader().num_pages - 1;
+}
+
+void File::setChecksums(const bool enabled) {
+  if (checksums_off_.size() <= id_) {
+    checksums_off_.resize(id_ + 1, false);
+  }
+  checksums_off_[id_] = !enabled;
+}
+
+bool File::checksums() const {
+  return id_ >= checksums_off_.size() || !checksums_off_[id_];
+}
+
+CompressionStats File::compressionStats() const {
+  return store_ ? store_->stats() : CompressionStats();
+}
+
 void File::deletePage(const PageId page_number) {
   FileHeader header = readHeader();
   Page existing_page = readPage(page_number);
@@ -220,21 +330,37 @@ FileIterator File::end() {
   return FileIterator(this, Page::INVALID_NUMBER);
 }
 
-File::File(const std::string& name, const bool create_new) : filename_(name) {
+File::File(const std::string& name, const bool create_new,
+           const bool compress) : filename_(name) {
   openIfNeeded(create_new);
 
   if (create_new) {
     // File starts with 1 page (the header).
     FileHeader header = {1 /* num_pages */, 0 /* first_used_page */,
-                         0 /* num_free_pages */, 0 /* first_free_page */};
+                         0 /* num_free_pages */, 0 /* first_free_page */,
+                         compress ? FileHeader::COMPRESSED : 0 /* flags */};
     writeHeader(header);
+    if (compress) {
+      store_.reset(new CompressedStore(*stream_));
+      open_stores_[filename_] = store_;
+    }
   }
 }
 
 void File::openIfNeeded(const bool create_new) {
+  IdMap::const_iterator known = file_ids_.find(filename_);
+  if (known == file_ids_.end()) {
+    const FileId next = (FileId) file_ids_.size();
+    known = file_ids_.insert(std::make_pair(filename_, next)).first;
+  }
+  id_ = known->second;
   if (open_counts_.find(filename_) != open_counts_.end()) {	//exists an entry already
     ++open_counts_[filename_];
     stream_ = open_streams_[filename_];
+    StoreMap::const_iterator store = open_stores_.find(filename_);
+    if (store != open_stores_.end()) {
+      store_ = store->second;
+    }
   } else {
     std::ios_base::openmode mode =
         std::fstream::in | std::fstream::out | std::fstream::binary;
@@ -255,15 +381,21 @@ void File::openIfNeeded(const bool create_new) {
     stream_.reset(new std::fstream(filename_, mode));
     open_streams_[filename_] = stream_;
     open_counts_[filename_] = 1;
+    if (!create_new && (readHeader().flags & FileHeader::COMPRESSED) != 0) {
+      store_.reset(new CompressedStore(*stream_));
+      open_stores_[filename_] = store_;
+    }
   }
 }
 
 void File::close() {
   --open_counts_[filename_];
   stream_.reset();
+  store_.reset();
   if (open_counts_[filename_] == 0) {
     open_streams_.erase(filename_);
     open_counts_.erase(filename_);
+    open_stores_.erase(filename_);
   }
 }
 
@@ -273,13 +405,32 @@ void File::writePage(const PageId page_number, const Page& new_page) {
 
 void File::writePage(const PageId page_number, const PageHeader& header,
                      const Page& new_page) {
+  PageHeader stamped = header;
+  stampChecksum(stamped, new_page.data_);
+  if (store_) {
+    Page staged = new_page;
+    staged.header_ = stamped;
+    store_->write(page_number, reinterpret_cast<const char*>(&staged));
+    stream_->flush();
+    return;
+  }
   stream_->seekp(pagePosition(page_number), std::ios::beg);
-  stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream_->write(reinterpret_cast<const char*>(&stamped), sizeof(stamped));
   stream_->write(reinterpret_cast<const char*>(&new_page.data_[0]),
                  Page::DATA_SIZE);
   stream_->flush();
 }
 
+void File::stampChecksum(PageHeader& header, const char* data) const {
+  if (checksums()) {
+    header.page_flags |= Page::CHECKSUMMED;
+    header.checksum = Page::computeChecksum(header, data);
+  } else {
+    header.page_flags &= ~Page::CHECKSUMMED;
+    header.checksum = 0;
+  }
+}
+
 FileHeader File::readHeader() const {
   FileHeader header;
   stream_->seekg(0 /* pos */, std::ios::beg);
@@ -296,6 +447,15 @@ void File::writeHeader(const FileHeader& header) {
 
 PageHeader File::readPageHeader(PageId page_number) const {
   PageHeader header;
+  if (store_) {
+    Page page;
+    if (!store_->readPrefix(page_number,
+                            reinterpret_cast<char*>(&page.header_),
+                            sizeof(page.header_))) {
+      throw ChecksumMismatchException(page_number, filename_);
+    }
+    return page.header_;
+  }
   stream_->seekg(pagePosition(page_number), std::ios::beg);
   stream_->read(reinterpret_cast<char*>(&header), sizeof(header));
 
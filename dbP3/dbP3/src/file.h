@@ -11,7 +11,9 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
+#include "compressed_store.h"
 #include "page.h"
 
 namespace badgerdb {
@@ -22,6 +24,11 @@ class FileIterator;
  * @brief Header metadata for files on disk which contain pages.
  */
 struct FileHeader {
+  /**
+   * Flag set in <flags> for a file whose pages are stored compressed.
+   */
+  static const std::uint32_t COMPRESSED = 1;
+
   /**
    * Number of pages allocated in the file.
    */
@@ -42,6 +49,11 @@ struct FileHeader {
    */
   PageId first_free_page;
 
+  /**
+   * Format flags of the file.
+   */
+  std::uint32_t flags;
+
   /**
    * Returns true if this file header is equal to the other.
    *
@@ -80,6 +92,18 @@ class File {
    */
   static File create(const std::string& filename);
 
+  /**
+   * Creates a new file that stores each page LZ4-compressed, for files that
+   * are mostly read and whose pages are mostly empty.  Apart from taking
+   * less space (and more CPU), such a file behaves like any other; open()
+   * recognizes it.
+   *
+   * @see CompressedStore
+   * @param filename  Name of the file.
+   * @throws  FileExistsException     If the requested file already exists.
+   */
+  static File createCompressed(const std::string& filename);
+
   /**
    * Opens the file named fileName and returns the corresponding File object.
 	 * It first checks if the file is already open. If so, then the new File object created uses the same input-output stream to read to or write fom
@@ -152,9 +176,26 @@ class File {
    * @return  The page.
    * @throws  InvalidPageException  If the page doesn't exist in the file or is
    *                                not currently used.
+   * @throws  ChecksumMismatchException  If the page's extent in a compressed
+   *                                     file is missing or damaged.
    */
   Page readPage(const PageId page_number) const;
 
+  /**
+   * Reads several existing pages from the file.  Runs of consecutive page
+   * numbers are read with a single seek and read each.
+   *
+   * @param page_numbers  Numbers of pages to read, sorted and without
+   *                      duplicates.
+   * @param pages         Receives the pages, in the order of <page_numbers>.
+   * @throws  InvalidPageException  If any page doesn't exist in the file or is
+   *                                not currently used.
+   * @throws  ChecksumMismatchException  If the extent of any page in a
+   *                                     compressed file is missing or damaged.
+   */
+  void readPages(const std::vector<PageId>& page_numbers,
+                 std::vector<Page>& pages) const;
+
   /**
    * Writes a page into the file, replacing any existing contents.  The page
    * must have been already allocated in this file by a call to allocatePage().
@@ -164,6 +205,17 @@ class File {
    */
   void writePage(const Page& new_page);
 
+  /**
+   * Writes several pages into the file, as writePage() does for each.  Runs
+   * of consecutive page numbers are written with a single seek and write each.
+   *
+   * @param pages  Pages to write, sorted by page number and without
+   *               duplicates.
+   * @throws  InvalidPageException  If any page has been deleted from the file;
+   *                                nothing is written then.
+   */
+  void writePages(const std::vector<const Page*>& pages);
+
   /**
    * Deletes a page from the file.
    *
@@ -178,6 +230,57 @@ class File {
    */
   const std::string& filename() const { return filename_; }
 
+  /**
+   * Returns the number of pages allocated in the file, used or free.  Pages
+   * are numbered from 1 to this number.
+   *
+   * @return  Number of pages.
+   */
+  PageId numPages() const;
+
+  /**
+   * Returns the identifier of the file this object represents.  Every File
+   * object for the same file name has the same identifier, which stays the
+   * same when the file is closed and opened again.
+   *
+   * @return Identifier of file.
+   */
+  FileId id() const { return id_; }
+
+  /**
+   * Sets whether pages written to this file are stamped with a checksum and
+   * whether pages read from it through a buffer manager are verified against
+   * theirs.  On by default.  The setting applies to every File object for the
+   * same file name for as long as the program runs; pages already on disk
+   * keep whatever checksum they were written with.
+   *
+   * @param enabled  Whether to checksum pages.
+   */
+  void setChecksums(const bool enabled);
+
+  /**
+   * Returns whether pages of this file are checksummed.
+   *
+   * @see setChecksums()
+   * @return  Whether pages are checksummed.
+   */
+  bool checksums() const;
+
+  /**
+   * Returns whether this file stores its pages compressed.
+   *
+   * @see createCompressed()
+   */
+  bool compressed() const { return store_.get() != NULL; }
+
+  /**
+   * Returns the footprint of this compressed file and its page I/O since it
+   * was opened.  All zero for a file that is not compressed.
+   *
+   * @return  Footprint and counters.
+   */
+  CompressionStats compressionStats() const;
+
   /**
    * Returns an iterator at the first page in the file.
    *
@@ -214,12 +317,14 @@ class File {
    * @see File::open()
    * @param name        Name of file.
    * @param create_new  Whether to create a new file.
+   * @param compress    Whether a new file stores its pages compressed.
    * @throws  FileExistsException     If the underlying file exists and
    *                                  create_new is true.
    * @throws  FileNotFoundException   If the underlying file doesn't exist and
    *                                  create_new is false.
    */
-  File(const std::string& name, const bool create_new);
+  File(const std::string& name, const bool create_new,
+       const bool compress = false);
 
   /**
    * Opens the underlying file named in filename_.
@@ -253,6 +358,8 @@ class File {
    * @return  The page.
    * @throws  InvalidPageException  If the page is free (unused) and
    *                                allow_free is false.
+   * @throws  ChecksumMismatchException  If the page's extent in a compressed
+   *                                     file is missing or damaged.
    */
   Page readPage(const PageId page_number, const bool allow_free) const;
 
@@ -278,6 +385,15 @@ class File {
   void writePage(const PageId page_number, const PageHeader& header,
                  const Page& new_page);
 
+  /**
+   * Sets or clears the checksum of a page header about to be written, as
+   * the checksum setting of this file says.
+   *
+   * @param header  Header of page to write.
+   * @param data    Data of page to write.
+   */
+  void stampChecksum(PageHeader& header, const char* data) const;
+
   /**
    * Reads the header for this file from disk.
    *
@@ -298,12 +414,17 @@ class File {
    *
    * @param page_number   Number of page whose header is to be read.
    * @return  Header of page.
+   * @throws  ChecksumMismatchException  If the page's extent in a compressed
+   *                                     file is missing or damaged.
    */
   PageHeader readPageHeader(const PageId page_number) const;
 
   typedef std::map<std::string,
                    std::shared_ptr<std::fstream> > StreamMap;
   typedef std::map<std::string, int> CountMap;
+  typedef std::map<std::string, FileId> IdMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<CompressedStore> > StoreMap;
 
   /**
    * Streams for opened files.
@@ -315,16 +436,42 @@ class File {
    */
   static CountMap open_counts_;
 
+  /**
+   * Page stores of opened compressed files.
+   */
+  static StoreMap open_stores_;
+
+  /**
+   * Identifiers handed out to file names, numbered densely from 0.
+   */
+  static IdMap file_ids_;
+
+  /**
+   * Whether checksums are turned off, indexed by file identifier.
+   */
+  static std::vector<bool> checksums_off_;
+
   /**
    * Name of the file this object represents.
    */
   std::string filename_;
 
+  /**
+   * Identifier of the file this object represents.
+   */
+  FileId id_;
+
   /**
    * Stream for underlying filesystem object.
    */
   std::shared_ptr<std::fstream> stream_;
 
+  /**
+   * Where the pages of a compressed file are, or NULL if the file is not
+   * compressed.
+   */
+  std::shared_ptr<CompressedStore> store_;
+
   friend class FileIterator;
   friend class FileTest;
 };
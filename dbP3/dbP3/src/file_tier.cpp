@@ -0,0 +1,160 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "crc32c.h"
+#include "file_tier.h"
+#include "exceptions/tier_exception.h"
+
+namespace badgerdb {
+
+    const PageKey FileTier::NO_PAGE;
+
+    /**
+     * Constructor of FileTier class
+     */
+    FileTier::FileTier(const std::string& path, const std::uint32_t capacityPages)
+    : path(path), fd(-1), capacity(capacityPages), slotKeys(capacityPages, NO_PAGE),
+      slotChecksums(capacityPages, 0), hand(0)
+    {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw TierException(path, "create");
+        }
+        //reserve the space up front, so that a full device shows now rather than as misses;
+        //file systems that cannot reserve space just get a sparse file
+        const off_t size = (off_t) capacityPages * Page::SIZE;
+        const int reserved = size > 0 ? ::posix_fallocate(fd, 0, size) : 0;
+        if (reserved == ENOSPC || (reserved != 0 && ::ftruncate(fd, size) != 0))
+        {
+            ::close(fd);
+            std::remove(path.c_str());
+            throw TierException(path, "truncate");
+        }
+        freeSlots.reserve(capacityPages);
+        for (std::uint32_t slot = capacityPages; slot > 0; slot--)
+        {
+            freeSlots.push_back(slot - 1);
+        }
+        slots.reserve(capacityPages);
+    }
+
+    /**
+     * Destructor of FileTier class
+     */
+    FileTier::~FileTier()
+    {
+        ::close(fd);
+        std::remove(path.c_str());
+    }
+
+    void FileTier::put(const PageKey key, const Page& page)
+    {
+        if (capacity == 0)
+        {
+            return;
+        }
+        erase(key);
+        const std::uint32_t slot = allocSlot();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const ssize_t written = ::pwrite(fd, &page, Page::SIZE, (off_t) slot * Page::SIZE);
+        const std::uint32_t checksum = crc32c(&page, Page::SIZE);
+        stats.storeNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (written != (ssize_t) Page::SIZE)
+        {
+            freeSlots.push_back(slot);
+            return;
+        }
+        slotKeys[slot] = key;
+        slotChecksums[slot] = checksum;
+        slots[key] = slot;
+        stats.inserts++;
+        stats.pages++;
+        stats.bytes += Page::SIZE;
+    }
+
+    bool FileTier::take(const PageKey key, Page& page)
+    {
+        stats.lookups++;
+        std::unordered_map<PageKey, std::uint32_t>::iterator found = slots.find(key);
+        if (found == slots.end())
+        {
+            return false;
+        }
+        const std::uint32_t slot = found->second;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const ssize_t read = ::pread(fd, &page, Page::SIZE, (off_t) slot * Page::SIZE);
+        const bool intact = read == (ssize_t) Page::SIZE && crc32c(&page, Page::SIZE) == slotChecksums[slot];
+        stats.loadNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        freeSlot(slot);
+        if (intact)
+        {
+            stats.hits++;
+        }
+        return intact;
+    }
+
+    void FileTier::erase(const PageKey key)
+    {
+        std::unordered_map<PageKey, std::uint32_t>::iterator found = slots.find(key);
+        if (found != slots.end())
+        {
+            freeSlot(found->second);
+        }
+    }
+
+    void FileTier::eraseFile(const FileId file)
+    {
+        if (slots.empty())
+        {
+            return;
+        }
+        for (std::uint32_t slot = 0; slot < capacity; slot++)
+        {
+            if (slotKeys[slot] != NO_PAGE && (FileId) (slotKeys[slot] >> 32) == file)
+            {
+                freeSlot(slot);
+            }
+        }
+    }
+
+    /**
+     * Find a slot for a new page
+     */
+    std::uint32_t FileTier::allocSlot()
+    {
+        if (freeSlots.empty())
+        {
+            freeSlot(hand);
+            stats.evictions++;
+            hand = (hand + 1) % capacity;
+        }
+        const std::uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+
+    /**
+     * Drop the page in a slot
+     */
+    void FileTier::freeSlot(const std::uint32_t slot)
+    {
+        slots.erase(slotKeys[slot]);
+        slotKeys[slot] = NO_PAGE;
+        freeSlots.push_back(slot);
+        stats.pages--;
+        stats.bytes -= Page::SIZE;
+    }
+
+}
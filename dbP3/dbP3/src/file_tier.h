@@ -0,0 +1,144 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cache_tier.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief CacheTier keeping evicted pages in a local cache file, such as one on flash
+     *
+     * Extends the buffer pool onto a fast local device when the database files live on a
+     * slower or remote one.  The cache file is divided into slots of one page each, and a hash
+     * map finds the slot of a page.  When every slot is taken, slots are reused in turn.  The
+     * checksum of each cached page is kept in memory, so a page the device damaged is treated
+     * as a miss and read from its file instead.
+     *
+     * The cache file only holds copies of clean pages: it is created empty, never synced, and
+     * removed when the tier is destroyed.  A failed read or write of it also counts as a miss.
+     *
+     * @warning This class is not threadsafe.
+     */
+    class FileTier : public CacheTier
+    {
+    public:
+        /**
+         * Constructor of FileTier class; creates (or truncates) the cache file
+         *
+         * @param path		Path of the cache file
+         * @param capacityPages	Number of pages the cache file holds
+         * @throws  TierException If the cache file cannot be created
+         */
+        FileTier(const std::string& path, const std::uint32_t capacityPages);
+
+        /**
+         * Destructor of FileTier class; closes and removes the cache file
+         */
+        ~FileTier();
+
+        virtual void put(const PageKey key, const Page& page);
+
+        virtual bool take(const PageKey key, Page& page);
+
+        virtual void erase(const PageKey key);
+
+        /**
+         * Drop every page of a file.  Costs time in the number of slots.
+         *
+         * @param file		Identifier of the file
+         */
+        virtual void eraseFile(const FileId file);
+
+        virtual TierStats getStats() const
+        {
+            return stats;
+        }
+
+        /**
+         * Path of the cache file
+         */
+        const std::string& getPath() const
+        {
+            return path;
+        }
+
+    private:
+        FileTier(const FileTier&);
+        FileTier& operator=(const FileTier&);
+
+        /**
+         * Key of a slot that holds no page
+         */
+        static const PageKey NO_PAGE = ~(PageKey) 0;
+
+        /**
+         * Find a slot for a new page, dropping the page in the next slot in turn if none is
+         * free
+         *
+         * @return 		Slot number
+         */
+        std::uint32_t allocSlot();
+
+        /**
+         * Drop the page in a slot
+         *
+         * @param slot		Slot number
+         */
+        void freeSlot(const std::uint32_t slot);
+
+        /**
+         * Path of the cache file
+         */
+        const std::string path;
+
+        /**
+         * Descriptor of the cache file
+         */
+        int fd;
+
+        /**
+         * Number of slots
+         */
+        const std::uint32_t capacity;
+
+        /**
+         * Page held in each slot, or NO_PAGE
+         */
+        std::vector<PageKey> slotKeys;
+
+        /**
+         * CRC-32C of the page held in each slot
+         */
+        std::vector<std::uint32_t> slotChecksums;
+
+        /**
+         * Slots holding no page
+         */
+        std::vector<std::uint32_t> freeSlots;
+
+        /**
+         * Slot whose page is dropped next when none is free
+         */
+        std::uint32_t hand;
+
+        /**
+         * Slot of each held page
+         */
+        std::unordered_map<PageKey, std::uint32_t> slots;
+
+        /**
+         * Counters
+         */
+        TierStats stats;
+    };
+
+}
@@ -0,0 +1,66 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "flush_handle.h"
+
+namespace badgerdb {
+
+    /**
+     * Mark the flush finished and wake its waiters
+     */
+    void AsyncFlushState::finish(std::exception_ptr failure)
+    {
+        std::lock_guard<std::mutex> guard(latch);
+        error = failure;
+        finished = true;
+        finishedCond.notify_all();
+    }
+
+    bool FlushHandle::done() const
+    {
+        if (!state)
+            return true;
+        std::lock_guard<std::mutex> guard(state->latch);
+        return state->finished;
+    }
+
+    void FlushHandle::wait() const
+    {
+        if (!state)
+            return;
+        std::unique_lock<std::mutex> lock(state->latch);
+        while (!state->finished)
+        {
+            state->finishedCond.wait(lock);
+        }
+        if (state->error)
+        {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+    bool FlushHandle::waitFor(const std::chrono::milliseconds timeout) const
+    {
+        if (!state)
+            return true;
+        std::unique_lock<std::mutex> lock(state->latch);
+        const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        while (!state->finished)
+        {
+            if (state->finishedCond.wait_until(lock, deadline) == std::cv_status::timeout)
+                return state->finished;
+        }
+        return true;
+    }
+
+    void FlushHandle::cancel()
+    {
+        if (state)
+            state->cancelled = true;
+    }
+
+}
@@ -0,0 +1,172 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+
+namespace badgerdb {
+
+    /**
+     * @brief State of one background flush, shared by the flushing thread and every FlushHandle to it
+     */
+    struct AsyncFlushState
+    {
+        /**
+         * Bytes of the dirty pages found when the flush started
+         */
+        std::uint64_t bytesTotal;
+
+        /**
+         * Bytes written so far
+         */
+        std::atomic<std::uint64_t> bytesWritten;
+
+        /**
+         * Pages left unwritten because they were still pinned after the last retry
+         */
+        std::atomic<std::uint32_t> pagesSkipped;
+
+        /**
+         * Set to ask the flushing thread to stop after its current batch
+         */
+        std::atomic<bool> cancelled;
+
+        /**
+         * Set by the flushing thread once it has stopped
+         */
+        bool finished;
+
+        /**
+         * Exception that stopped the flush, rethrown by FlushHandle::wait()
+         */
+        std::exception_ptr error;
+
+        /**
+         * Latch protecting finished and error
+         */
+        std::mutex latch;
+
+        /**
+         * Signalled when the flush finishes
+         */
+        std::condition_variable finishedCond;
+
+        /**
+         * Thread running the flush; joined by the BufMgr that started it
+         */
+        std::thread worker;
+
+        /**
+         * Constructor of AsyncFlushState class
+         */
+        AsyncFlushState()
+        : bytesTotal(0), bytesWritten(0), pagesSkipped(0), cancelled(false), finished(false)
+        {
+        }
+
+        /**
+         * Mark the flush finished and wake its waiters
+         *
+         * @param failure	Exception that stopped the flush, or a null pointer
+         */
+        void finish(std::exception_ptr failure);
+    };
+
+
+    /**
+     * @brief Handle to a flush started with BufMgr::flushFileAsync()
+     *
+     * Copies of a handle refer to the same flush.  Dropping every handle does not stop the
+     * flush; the BufMgr that started it waits for it when destroyed.
+     */
+    class FlushHandle
+    {
+    public:
+        /**
+         * Constructor of FlushHandle class; an empty handle counts as finished
+         */
+        FlushHandle()
+        {
+        }
+
+        /**
+         * Constructor of FlushHandle class
+         *
+         * @param state		State of the flush
+         */
+        explicit FlushHandle(const std::shared_ptr<AsyncFlushState>& state)
+        : state(state)
+        {
+        }
+
+        /**
+         * True once the flush has written every page it could, was cancelled, or failed
+         */
+        bool done() const;
+
+        /**
+         * Wait for the flush to finish
+         *
+         * @throws  Whatever exception stopped the flush, such as InvalidPageException
+         */
+        void wait() const;
+
+        /**
+         * Wait for the flush to finish, but not longer than the given time
+         *
+         * @param timeout	Longest time to wait
+         * @return 		True if the flush has finished
+         */
+        bool waitFor(const std::chrono::milliseconds timeout) const;
+
+        /**
+         * Ask the flush to stop after the batch it is writing.  Pages already written stay
+         * written and the rest stay dirty in the pool.
+         */
+        void cancel();
+
+        /**
+         * Bytes written so far
+         */
+        std::uint64_t bytesWritten() const
+        {
+            return state ? state->bytesWritten.load() : 0;
+        }
+
+        /**
+         * Bytes of the dirty pages found when the flush started.  Pages that were written back
+         * or dropped by someone else in the meantime are never counted as written.
+         */
+        std::uint64_t bytesTotal() const
+        {
+            return state ? state->bytesTotal : 0;
+        }
+
+        /**
+         * Pages left dirty because they were still pinned after the last retry
+         */
+        std::uint32_t pagesSkipped() const
+        {
+            return state ? state->pagesSkipped.load() : 0;
+        }
+
+    private:
+        /**
+         * State of the flush, or NULL for an empty handle
+         */
+        std::shared_ptr<AsyncFlushState> state;
+    };
+
+}
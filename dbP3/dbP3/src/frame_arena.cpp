@@ -0,0 +1,133 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "frame_arena.h"
+
+#include <fstream>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace badgerdb {
+
+FrameArena::FrameArena(const std::uint32_t numFrames, const bool useHugePages,
+                       const std::uint32_t capacity)
+    : frames_(NULL),
+      numFrames_(numFrames),
+      capacity_(capacity > numFrames ? capacity : numFrames),
+      mapBase_(NULL),
+      mapLength_(0),
+      backing_(HUGE_PAGES_NONE) {
+  if (!useHugePages && capacity_ == numFrames) {
+    frames_ = new Page[numFrames];
+    return;
+  }
+
+  const std::size_t bytes = (std::size_t) capacity_ * sizeof(Page);
+  if (!useHugePages) {
+    // Reserve the whole capacity; untouched frames cost no memory.
+    void* base = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    mapBase_ = base;
+    mapLength_ = bytes;
+    frames_ = static_cast<Page*>(base);
+    for (std::uint32_t i = 0; i < numFrames_; i++) {
+      new (&frames_[i]) Page();
+    }
+    return;
+  }
+
+  const std::size_t hugeSize = hugePageSize();
+  const std::size_t rounded = (bytes + hugeSize - 1) / hugeSize * hugeSize;
+  void* base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  base = mmap(NULL, rounded, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (base != MAP_FAILED) {
+    mapBase_ = base;
+    mapLength_ = rounded;
+    frames_ = static_cast<Page*>(base);
+    backing_ = HUGE_PAGES_HUGETLB;
+  }
+#endif
+  if (base == MAP_FAILED) {
+    // No reserved huge pages; over-allocate by one huge page so the frames can
+    // start on a huge page boundary, which khugepaged needs to promote them.
+    base = mmap(NULL, rounded + hugeSize, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    mapBase_ = base;
+    mapLength_ = rounded + hugeSize;
+    const std::size_t misalign = (std::size_t) base % hugeSize;
+    char* aligned = static_cast<char*>(base) +
+        (misalign == 0 ? 0 : hugeSize - misalign);
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, rounded, MADV_HUGEPAGE) == 0) {
+      backing_ = HUGE_PAGES_TRANSPARENT;
+    }
+#endif
+    frames_ = reinterpret_cast<Page*>(aligned);
+  }
+
+  for (std::uint32_t i = 0; i < numFrames_; i++) {
+    new (&frames_[i]) Page();
+  }
+}
+
+FrameArena::~FrameArena() {
+  if (mapBase_ == NULL) {
+    delete[] frames_;
+    return;
+  }
+  for (std::uint32_t i = 0; i < numFrames_; i++) {
+    frames_[i].~Page();
+  }
+  munmap(mapBase_, mapLength_);
+}
+
+void FrameArena::resize(const std::uint32_t numFrames) {
+  for (std::uint32_t i = numFrames_; i < numFrames; i++) {
+    new (&frames_[i]) Page();
+  }
+  if (numFrames < numFrames_ && mapBase_ != NULL &&
+      backing_ != HUGE_PAGES_HUGETLB) {
+    // Only whole base pages inside the removed frames can be dropped.
+    const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+    const std::size_t start = reinterpret_cast<std::size_t>(&frames_[numFrames]);
+    const std::size_t end = reinterpret_cast<std::size_t>(&frames_[numFrames_]);
+    const std::size_t first = (start + pageSize - 1) / pageSize * pageSize;
+    const std::size_t last = end / pageSize * pageSize;
+    if (first < last) {
+      madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+    }
+  }
+  numFrames_ = numFrames;
+}
+
+std::size_t FrameArena::hugePageSize() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  while (meminfo >> key) {
+    if (key == "Hugepagesize:") {
+      std::size_t kilobytes = 0;
+      if (meminfo >> kilobytes && kilobytes > 0) {
+        return kilobytes * 1024;
+      }
+      break;
+    }
+    meminfo.ignore(256, '\n');
+  }
+  return 2 * 1024 * 1024;
+}
+
+}
@@ -0,0 +1,135 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+#include "page.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Kind of memory backing the frames of a FrameArena.
+ */
+enum HugePageBacking {
+  /**
+   * Regular (base size) pages.
+   */
+  HUGE_PAGES_NONE,
+
+  /**
+   * Transparent huge pages requested with madvise(MADV_HUGEPAGE).  Whether the
+   * kernel actually promotes the region is up to khugepaged.
+   */
+  HUGE_PAGES_TRANSPARENT,
+
+  /**
+   * Explicit huge pages reserved with mmap(MAP_HUGETLB).
+   */
+  HUGE_PAGES_HUGETLB
+};
+
+/**
+ * @brief One contiguous region holding every frame of a buffer pool.
+ *
+ * Page objects hold their data inline, so placing all frames in a single
+ * mapping lets the region be backed by huge pages and keeps random frame
+ * accesses from thrashing the TLB.  When huge pages are requested the arena
+ * first tries explicit huge pages and falls back to transparent ones.
+ *
+ * An arena may reserve address space for more frames than it starts with, so
+ * that it can later grow in place: frames already handed out never move, and
+ * the memory of the reserved part is only committed when frames are added.
+ *
+ * @warning This class is not threadsafe.
+ */
+class FrameArena {
+ public:
+  /**
+   * Allocates and initializes <numFrames> frames.
+   *
+   * @param numFrames     Number of frames in the arena.
+   * @param useHugePages  Whether to back the arena with huge pages.
+   * @param capacity      Number of frames the arena can grow to; no growth if
+   *                      not larger than <numFrames>.
+   */
+  FrameArena(const std::uint32_t numFrames, const bool useHugePages,
+             const std::uint32_t capacity = 0);
+
+  /**
+   * Releases the arena.
+   */
+  ~FrameArena();
+
+  /**
+   * Returns the first frame of the arena.
+   */
+  Page* frames() const { return frames_; }
+
+  /**
+   * Returns the number of frames the arena can grow to.
+   */
+  std::uint32_t capacity() const { return capacity_; }
+
+  /**
+   * Grows or shrinks the arena in place.  Frames added are initialized;
+   * the memory of frames removed is given back to the system where the arena
+   * is backed by its own mapping.
+   *
+   * @param numFrames  New number of frames, at most capacity().
+   */
+  void resize(const std::uint32_t numFrames);
+
+  /**
+   * Returns the kind of memory the arena ended up backed by.
+   */
+  HugePageBacking backing() const { return backing_; }
+
+ private:
+  FrameArena(const FrameArena&);
+  FrameArena& operator=(const FrameArena&);
+
+  /**
+   * Returns the system default huge page size in bytes.
+   */
+  static std::size_t hugePageSize();
+
+  /**
+   * Frames of the arena.
+   */
+  Page* frames_;
+
+  /**
+   * Number of frames in the arena.
+   */
+  std::uint32_t numFrames_;
+
+  /**
+   * Number of frames the arena has address space for.
+   */
+  std::uint32_t capacity_;
+
+  /**
+   * Start of the mapping backing the arena, or NULL if the frames came from
+   * the heap.
+   */
+  void* mapBase_;
+
+  /**
+   * Length of the mapping at <mapBase_>.
+   */
+  std::size_t mapLength_;
+
+  /**
+   * Kind of memory backing the arena.
+   */
+  HugePageBacking backing_;
+};
+
+}
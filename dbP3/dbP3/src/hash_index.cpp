@@ -0,0 +1,477 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "hash_index.h"
+#include "crc32c.h"
+#include "file_iterator.h"
+#include "exceptions/index_exception.h"
+
+namespace badgerdb {
+
+    namespace {
+
+        const PageId META_PAGE = 1;
+
+        const std::uint32_t META_MAGIC = 0x48424442; // "BDBH"
+
+        /**
+         * Contents of page 1
+         */
+        struct HashMeta
+        {
+            std::uint32_t magic;
+            std::uint32_t keyType;
+            std::uint32_t numPages;
+        };
+
+        const std::uint16_t BUCKET_PAGE = 1;
+        const std::uint16_t OVERFLOW_PAGE = 2;
+
+        /**
+         * Start of every bucket and overflow page, followed by its entries in insertion order
+         */
+        struct BucketHeader
+        {
+            /**
+             * BUCKET_PAGE or OVERFLOW_PAGE
+             */
+            std::uint16_t kind;
+
+            /**
+             * Number of low bits of the hash shared by the keys of the bucket
+             */
+            std::uint16_t depth;
+
+            /**
+             * Number of entries
+             */
+            std::uint16_t count;
+
+            /**
+             * Bytes of entries
+             */
+            std::uint16_t used;
+
+            /**
+             * The low depth bits of the hashes of the bucket's keys
+             */
+            std::uint32_t bits;
+
+            /**
+             * Next page of the bucket's chain
+             */
+            PageId overflow;
+        };
+
+        /**
+         * An entry is the hash of its key, the key's length, the key and the RecordId
+         */
+        const std::size_t ENTRY_HEADER = sizeof(std::uint32_t) + sizeof(std::uint16_t);
+        const std::size_t RID_BYTES = sizeof(PageId) + sizeof(SlotId);
+        const std::size_t CAPACITY = Page::DATA_SIZE - sizeof(BucketHeader);
+
+        BucketHeader& headerOf(char* node)
+        {
+            return *reinterpret_cast<BucketHeader*>(node);
+        }
+
+        const BucketHeader& headerOf(const char* node)
+        {
+            return *reinterpret_cast<const BucketHeader*>(node);
+        }
+
+        std::uint32_t hashOf(const char* entry)
+        {
+            std::uint32_t hash;
+            std::memcpy(&hash, entry, sizeof(hash));
+            return hash;
+        }
+
+        std::uint16_t keyLength(const char* entry)
+        {
+            std::uint16_t length;
+            std::memcpy(&length, entry + sizeof(std::uint32_t), sizeof(length));
+            return length;
+        }
+
+        std::size_t entrySize(const char* entry)
+        {
+            return ENTRY_HEADER + keyLength(entry) + RID_BYTES;
+        }
+
+        RecordId ridOf(const char* entry)
+        {
+            const char* value = entry + ENTRY_HEADER + keyLength(entry);
+            RecordId rid;
+            std::memcpy(&rid.page_number, value, sizeof(rid.page_number));
+            std::memcpy(&rid.slot_number, value + sizeof(rid.page_number), sizeof(rid.slot_number));
+            return rid;
+        }
+
+        std::string makeEntry(const std::uint32_t hash, const std::string& key, const RecordId& rid)
+        {
+            std::string entry(ENTRY_HEADER + key.size() + RID_BYTES, '\0');
+            const std::uint16_t length = key.size();
+            std::memcpy(&entry[0], &hash, sizeof(hash));
+            std::memcpy(&entry[sizeof(hash)], &length, sizeof(length));
+            std::memcpy(&entry[ENTRY_HEADER], key.data(), key.size());
+            std::memcpy(&entry[ENTRY_HEADER + key.size()], &rid.page_number, sizeof(rid.page_number));
+            std::memcpy(&entry[ENTRY_HEADER + key.size() + sizeof(rid.page_number)], &rid.slot_number,
+                        sizeof(rid.slot_number));
+            return entry;
+        }
+
+        /**
+         * Append an entry to a page with room for it
+         */
+        void appendEntry(char* node, const char* entry, const std::size_t size)
+        {
+            BucketHeader& header = headerOf(node);
+            assert(header.used + size <= CAPACITY);
+            std::memcpy(node + sizeof(BucketHeader) + header.used, entry, size);
+            header.used += size;
+            header.count++;
+        }
+
+        std::uint32_t hashKey(const std::string& key)
+        {
+            return crc32c(key.data(), key.size());
+        }
+
+    }
+
+    const std::uint32_t HashIndex::MAX_KEY_LENGTH;
+    const std::uint32_t HashIndex::MAX_DEPTH;
+
+    /**
+     * Constructor of HashIndex class; opens the index in the file, or creates an empty one
+     */
+    HashIndex::HashIndex(BufMgr& bufMgr, File& file, const KeyType keyType)
+    : bufMgr(bufMgr), file(file), keyType(keyType), globalDepth(0), numBuckets(0), numPages(0)
+    {
+        if (file.begin() == file.end())
+        {
+            PageId metaNo;
+            {
+                WritePageGuard meta = bufMgr.allocPageGuard(&file, metaNo);
+            }
+            assert(metaNo == META_PAGE);
+            directory.push_back(allocBucket(BUCKET_PAGE, 0, 0));
+            return;
+        }
+        HashMeta contents;
+        {
+            ReadPageGuard meta = bufMgr.readPageGuard(&file, META_PAGE);
+            std::memcpy(&contents, meta->data(), sizeof(contents));
+        }
+        if (contents.magic != META_MAGIC)
+        {
+            throw IndexException(file.filename(), "not a hash index");
+        }
+        if (contents.keyType != (std::uint32_t) keyType)
+        {
+            throw IndexException(file.filename(), "index has another kind of key");
+        }
+        numPages = contents.numPages;
+
+        //each bucket fills the directory entries ending in its bits
+        std::vector<BucketHeader> buckets;
+        std::vector<PageId> bucketPages;
+        for (PageId pageNo = META_PAGE + 1; pageNo <= numPages + META_PAGE; pageNo++)
+        {
+            ReadPageGuard page = bufMgr.readPageGuard(&file, pageNo);
+            const BucketHeader& header = headerOf(page->data());
+            if (header.kind == BUCKET_PAGE)
+            {
+                buckets.push_back(header);
+                bucketPages.push_back(pageNo);
+                globalDepth = std::max<std::uint32_t>(globalDepth, header.depth);
+            }
+        }
+        directory.assign((std::size_t) 1 << globalDepth, (PageId) Page::INVALID_NUMBER);
+        for (std::size_t b = 0; b < buckets.size(); b++)
+        {
+            for (std::size_t i = buckets[b].bits; i < directory.size(); i += (std::size_t) 1 << buckets[b].depth)
+            {
+                directory[i] = bucketPages[b];
+            }
+        }
+        numBuckets = buckets.size();
+    }
+
+    void HashIndex::insert(const std::int64_t key, const RecordId& rid)
+    {
+        const std::string encoded = encodeKey(key);
+        checkKey(encoded, INTEGER_KEYS);
+        insertKey(encoded, rid);
+    }
+
+    void HashIndex::insert(const std::string& key, const RecordId& rid)
+    {
+        checkKey(key, BYTE_KEYS);
+        insertKey(key, rid);
+    }
+
+    bool HashIndex::lookup(const std::int64_t key, RecordId& rid)
+    {
+        return find(encodeKey(key), rid, NULL) > 0;
+    }
+
+    bool HashIndex::lookup(const std::string& key, RecordId& rid)
+    {
+        return find(key, rid, NULL) > 0;
+    }
+
+    std::uint32_t HashIndex::lookupAll(const std::int64_t key, std::vector<RecordId>& rids)
+    {
+        RecordId first;
+        return find(encodeKey(key), first, &rids);
+    }
+
+    std::uint32_t HashIndex::lookupAll(const std::string& key, std::vector<RecordId>& rids)
+    {
+        RecordId first;
+        return find(key, first, &rids);
+    }
+
+    std::string HashIndex::encodeKey(const std::int64_t key)
+    {
+        return std::string(reinterpret_cast<const char*>(&key), sizeof(key));
+    }
+
+    /**
+     * Throw IndexException unless a key is of the index's kind and not too long
+     */
+    void HashIndex::checkKey(const std::string& key, const KeyType expected) const
+    {
+        if (keyType != expected)
+        {
+            throw IndexException(file.filename(), keyType == INTEGER_KEYS ? "byte key for an index of integer keys"
+                                                                          : "integer key for an index of byte keys");
+        }
+        if (key.size() > MAX_KEY_LENGTH)
+        {
+            throw IndexException(file.filename(), "key longer than MAX_KEY_LENGTH");
+        }
+    }
+
+    /**
+     * Insert an encoded key
+     */
+    void HashIndex::insertKey(const std::string& key, const RecordId& rid)
+    {
+        const std::uint32_t hash = hashKey(key);
+        const std::string entry = makeEntry(hash, key, rid);
+        for (;;)
+        {
+            const PageId bucket = directory[hash & (((std::uint32_t) 1 << globalDepth) - 1)];
+            //look for room along the chain, gathering its entries in case there is none
+            std::vector<std::string> entries;
+            bool sameHash = true;
+            std::uint32_t depth = 0;
+            std::uint32_t bits = 0;
+            PageId room = Page::INVALID_NUMBER;
+            PageId last = bucket;
+            for (PageId pageNo = bucket; pageNo != Page::INVALID_NUMBER; )
+            {
+                ReadPageGuard page = bufMgr.readPageGuard(&file, pageNo);
+                const char* node = page->data();
+                const BucketHeader& header = headerOf(node);
+                if (pageNo == bucket)
+                {
+                    depth = header.depth;
+                    bits = header.bits;
+                }
+                if (header.used + entry.size() <= CAPACITY)
+                {
+                    room = pageNo;
+                    break;
+                }
+                const char* stored = node + sizeof(BucketHeader);
+                for (std::uint32_t i = 0; i < header.count; i++)
+                {
+                    const std::size_t size = entrySize(stored);
+                    entries.push_back(std::string(stored, size));
+                    sameHash = sameHash && hashOf(stored) == hash;
+                    stored += size;
+                }
+                last = pageNo;
+                pageNo = header.overflow;
+            }
+            if (room != Page::INVALID_NUMBER)
+            {
+                WritePageGuard page = bufMgr.writePageGuard(&file, room);
+                appendEntry(page->data(), entry.data(), entry.size());
+                return;
+            }
+            //another bit of the hash may tell some of the keys apart; if not, chain a page
+            if (!sameHash && depth < MAX_DEPTH)
+            {
+                splitBucket(bucket, entries);
+                continue;
+            }
+            const PageId overflow = allocBucket(OVERFLOW_PAGE, depth, bits);
+            {
+                WritePageGuard page = bufMgr.writePageGuard(&file, last);
+                headerOf(page->data()).overflow = overflow;
+            }
+            WritePageGuard page = bufMgr.writePageGuard(&file, overflow);
+            appendEntry(page->data(), entry.data(), entry.size());
+            return;
+        }
+    }
+
+    /**
+     * Find the entries with an encoded key
+     */
+    std::uint32_t HashIndex::find(const std::string& key, RecordId& first, std::vector<RecordId>* rids)
+    {
+        const std::uint32_t hash = hashKey(key);
+        std::uint32_t found = 0;
+        PageId pageNo = directory[hash & (((std::uint32_t) 1 << globalDepth) - 1)];
+        while (pageNo != Page::INVALID_NUMBER)
+        {
+            ReadPageGuard page = bufMgr.readPageGuard(&file, pageNo);
+            const char* node = page->data();
+            const BucketHeader& header = headerOf(node);
+            const char* entry = node + sizeof(BucketHeader);
+            for (std::uint32_t i = 0; i < header.count; i++)
+            {
+                if (hashOf(entry) == hash && keyLength(entry) == key.size() &&
+                    std::memcmp(entry + ENTRY_HEADER, key.data(), key.size()) == 0)
+                {
+                    if (found == 0)
+                    {
+                        first = ridOf(entry);
+                    }
+                    found++;
+                    if (rids == NULL)
+                    {
+                        return found;
+                    }
+                    rids->push_back(ridOf(entry));
+                }
+                entry += entrySize(entry);
+            }
+            pageNo = header.overflow;
+        }
+        return found;
+    }
+
+    /**
+     * Split a bucket by the next bit of the hash, doubling the directory if need be
+     */
+    void HashIndex::splitBucket(const PageId bucket, const std::vector<std::string>& entries)
+    {
+        std::uint32_t depth;
+        std::uint32_t bits;
+        {
+            ReadPageGuard page = bufMgr.readPageGuard(&file, bucket);
+            depth = headerOf(page->data()).depth;
+            bits = headerOf(page->data()).bits;
+        }
+        if (depth == globalDepth)
+        {
+            const std::size_t size = directory.size();
+            directory.resize(2 * size);
+            std::copy(directory.begin(), directory.begin() + size, directory.begin() + size);
+            globalDepth++;
+        }
+        std::vector<std::string> low;
+        std::vector<std::string> high;
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            if ((hashOf(entries[i].data()) >> depth) & 1)
+                high.push_back(entries[i]);
+            else
+                low.push_back(entries[i]);
+        }
+        const std::uint32_t highBits = bits | ((std::uint32_t) 1 << depth);
+        const PageId sibling = allocBucket(BUCKET_PAGE, depth + 1, highBits);
+        writeChain(bucket, depth + 1, bits, low);
+        writeChain(sibling, depth + 1, highBits, high);
+        for (std::size_t i = highBits; i < directory.size(); i += (std::size_t) 1 << (depth + 1))
+        {
+            directory[i] = sibling;
+        }
+    }
+
+    /**
+     * Rewrite a bucket and its overflow pages to hold just the given entries
+     */
+    void HashIndex::writeChain(const PageId bucket, const std::uint32_t depth, const std::uint32_t bits,
+                               const std::vector<std::string>& entries)
+    {
+        std::size_t next = 0;
+        PageId pageNo = bucket;
+        //pages of the chain left over stay on it, empty
+        while (pageNo != Page::INVALID_NUMBER)
+        {
+            WritePageGuard page = bufMgr.writePageGuard(&file, pageNo);
+            char* node = page->data();
+            BucketHeader& header = headerOf(node);
+            header.depth = depth;
+            header.bits = bits;
+            header.count = 0;
+            header.used = 0;
+            while (next < entries.size() && header.used + entries[next].size() <= CAPACITY)
+            {
+                appendEntry(node, entries[next].data(), entries[next].size());
+                next++;
+            }
+            if (next < entries.size() && header.overflow == Page::INVALID_NUMBER)
+            {
+                header.overflow = allocBucket(OVERFLOW_PAGE, depth, bits);
+            }
+            pageNo = header.overflow;
+        }
+    }
+
+    /**
+     * Allocate an empty bucket or overflow page
+     */
+    PageId HashIndex::allocBucket(const std::uint16_t kind, const std::uint32_t depth, const std::uint32_t bits)
+    {
+        PageId pageNo;
+        {
+            WritePageGuard page = bufMgr.allocPageGuard(&file, pageNo);
+            BucketHeader& header = headerOf(page->data());
+            header.kind = kind;
+            header.depth = depth;
+            header.count = 0;
+            header.used = 0;
+            header.bits = bits;
+            header.overflow = Page::INVALID_NUMBER;
+        }
+        //pages are allocated in order, so they are found again by number when opening
+        assert(pageNo == numPages + META_PAGE + 1);
+        numPages++;
+        if (kind == BUCKET_PAGE)
+        {
+            numBuckets++;
+        }
+        writeMeta();
+        return pageNo;
+    }
+
+    /**
+     * Write the number of pages to page 1
+     */
+    void HashIndex::writeMeta()
+    {
+        HashMeta contents;
+        contents.magic = META_MAGIC;
+        contents.keyType = keyType;
+        contents.numPages = numPages;
+        WritePageGuard meta = bufMgr.writePageGuard(&file, META_PAGE);
+        std::memcpy(meta->data(), &contents, sizeof(contents));
+    }
+
+}
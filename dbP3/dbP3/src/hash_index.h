@@ -0,0 +1,218 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "buffer.h"
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief Extendible hash index mapping keys to RecordIds, its buckets stored in the pages
+     * of a file and read and written through a buffer pool
+     *
+     * Keys are either 64-bit integers or byte strings of up to MAX_KEY_LENGTH bytes, fixed
+     * when the index is created, as for BTreeIndex; only equality lookups are offered.  A key
+     * may be inserted more than once.
+     *
+     * A key goes to the bucket its CRC-32C picks out of the directory, which is indexed by
+     * the low globalDepth bits of the hash and kept only in memory.  Each bucket records its
+     * own depth and the bits its keys share, so the directory is rebuilt from the buckets
+     * when the index is opened.  A bucket that fills up is split in two by one more bit of
+     * the hash, doubling the directory first if the bucket was as deep as it; only that
+     * bucket's entries move, so no insert ever rehashes the whole index.  A bucket whose
+     * entries all have the same hash cannot be split and grows a chain of overflow pages
+     * instead, as does one at MAX_DEPTH.
+     *
+     * Page 1 of the file holds the kind of key and the number of pages; the others are
+     * buckets and overflow pages, allocated in order.  Flush the file before opening it
+     * again.
+     *
+     * @warning This class is not threadsafe.
+     */
+    class HashIndex
+    {
+    public:
+        /**
+         * Kind of key of an index
+         */
+        enum KeyType
+        {
+            INTEGER_KEYS = 1,
+            BYTE_KEYS = 2
+        };
+
+        /**
+         * Longest byte key
+         */
+        static const std::uint32_t MAX_KEY_LENGTH = 1024;
+
+        /**
+         * Deepest a bucket is split, which bounds the directory at 2^MAX_DEPTH entries
+         */
+        static const std::uint32_t MAX_DEPTH = 24;
+
+        /**
+         * Constructor of HashIndex class; opens the index in the file, or creates one with a
+         * single empty bucket if the file is empty
+         *
+         * @param bufMgr		Pool the buckets are read and written through; must outlive the index
+         * @param file		File of the index; must outlive the index
+         * @param keyType		Kind of key of the index
+         * @throws  IndexException if the file holds something other than an index of this kind
+         */
+        HashIndex(BufMgr& bufMgr, File& file, const KeyType keyType);
+
+        /**
+         * Add an entry
+         *
+         * @param key		Key of the entry
+         * @param rid		Record the entry points at
+         * @throws  IndexException if the key is not of the index's kind, or too long
+         */
+        void insert(const std::int64_t key, const RecordId& rid);
+        void insert(const std::string& key, const RecordId& rid);
+
+        /**
+         * Find the first entry with a key
+         *
+         * @param key		Key to look up
+         * @param rid		Receives the record of the entry, if there is one
+         * @return 		True if there is an entry with the key
+         */
+        bool lookup(const std::int64_t key, RecordId& rid);
+        bool lookup(const std::string& key, RecordId& rid);
+
+        /**
+         * Collect the records of every entry with a key, in insertion order
+         *
+         * @param key		Key to look up
+         * @param rids		The records are appended to this
+         * @return 		Number of entries found
+         */
+        std::uint32_t lookupAll(const std::int64_t key, std::vector<RecordId>& rids);
+        std::uint32_t lookupAll(const std::string& key, std::vector<RecordId>& rids);
+
+        /**
+         * Kind of key of the index
+         */
+        KeyType getKeyType() const
+        {
+            return keyType;
+        }
+
+        /**
+         * Number of bits of the hash that index the directory
+         */
+        std::uint32_t getGlobalDepth() const
+        {
+            return globalDepth;
+        }
+
+        /**
+         * Number of buckets, not counting overflow pages
+         */
+        std::uint32_t getNumBuckets() const
+        {
+            return numBuckets;
+        }
+
+        /**
+         * Bytes an integer key is stored as
+         */
+        static std::string encodeKey(const std::int64_t key);
+
+    private:
+        /**
+         * Throw IndexException unless a key is of the index's kind and not too long
+         */
+        void checkKey(const std::string& key, const KeyType expected) const;
+
+        /**
+         * Insert an encoded key
+         */
+        void insertKey(const std::string& key, const RecordId& rid);
+
+        /**
+         * Find the entries with an encoded key
+         *
+         * @param key		Encoded key
+         * @param first		Receives the record of the first entry, if there is one
+         * @param rids		If not NULL, receives the records of all the entries; else only
+         * 					the first is looked for
+         * @return 		Number of entries found
+         */
+        std::uint32_t find(const std::string& key, RecordId& first, std::vector<RecordId>* rids);
+
+        /**
+         * Split a bucket by the next bit of the hash, doubling the directory if need be
+         *
+         * @param bucket		Bucket to split
+         * @param entries		Entries of the bucket and its overflow pages
+         */
+        void splitBucket(const PageId bucket, const std::vector<std::string>& entries);
+
+        /**
+         * Rewrite a bucket and its overflow pages to hold just the given entries, adding
+         * overflow pages if they do not fit
+         */
+        void writeChain(const PageId bucket, const std::uint32_t depth, const std::uint32_t bits,
+                        const std::vector<std::string>& entries);
+
+        /**
+         * Allocate an empty bucket or overflow page
+         */
+        PageId allocBucket(const std::uint16_t kind, const std::uint32_t depth, const std::uint32_t bits);
+
+        /**
+         * Write the number of pages to page 1
+         */
+        void writeMeta();
+
+        /**
+         * Pool the buckets go through
+         */
+        BufMgr& bufMgr;
+
+        /**
+         * File of the index
+         */
+        File& file;
+
+        /**
+         * Kind of key of the index
+         */
+        const KeyType keyType;
+
+        /**
+         * Bucket of each value of the low globalDepth bits of a hash
+         */
+        std::vector<PageId> directory;
+
+        /**
+         * Number of bits of the hash that index the directory
+         */
+        std::uint32_t globalDepth;
+
+        /**
+         * Number of buckets
+         */
+        std::uint32_t numBuckets;
+
+        /**
+         * Number of pages after page 1
+         */
+        std::uint32_t numPages;
+    };
+
+}
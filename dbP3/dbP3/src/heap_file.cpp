@@ -0,0 +1,232 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include "heap_file.h"
+#include "file_iterator.h"
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_record_exception.h"
+
+namespace badgerdb {
+
+    const std::uint32_t HeapFile::CLASS_BYTES;
+    const std::uint32_t HeapFile::MAX_CLASS;
+    const std::uint32_t HeapFile::PAGES_PER_FSM;
+
+    /**
+     * Constructor of HeapFile class; reads the free-space map of the file, or starts one
+     */
+    HeapFile::HeapFile(BufMgr& bufMgr, File& file)
+    : bufMgr(bufMgr), file(file), classes(1, 0), candidates(MAX_CLASS + 1), numCandidates(0),
+      numDataPages(0), lastFsmPage(Page::INVALID_NUMBER)
+    {
+        if (file.begin() == file.end())
+        {
+            addFsmPage();
+            return;
+        }
+        //every group but the last is full
+        for (PageId fsmPage = 1; ; fsmPage += PAGES_PER_FSM + 1)
+        {
+            std::string map;
+            {
+                ReadPageGuard page = bufMgr.readPageGuard(&file, fsmPage);
+                map = page->getRecord({fsmPage, 1});
+            }
+            lastFsmPage = fsmPage;
+            classes.resize(fsmPage + 1 + map.size(), 0);
+            std::copy(map.begin(), map.end(), classes.begin() + fsmPage + 1);
+            numDataPages += map.size();
+            if (map.size() < PAGES_PER_FSM)
+            {
+                break;
+            }
+        }
+        rebuildCandidates();
+    }
+
+    RecordId HeapFile::insertRecord(const std::string& record)
+    {
+        //a slot may have to be added for the record as well
+        const std::size_t needed = record.length() + sizeof(PageSlot);
+        if (needed > Page::DATA_SIZE)
+        {
+            throw InsufficientSpaceException(Page::INVALID_NUMBER, record.length(),
+                                             Page::DATA_SIZE - sizeof(PageSlot));
+        }
+        const PageId pageNo = findPage((needed + CLASS_BYTES - 1) / CLASS_BYTES);
+        RecordId rid;
+        std::uint32_t freeBytes;
+        {
+            WritePageGuard page = bufMgr.writePageGuard(&file, pageNo);
+            rid = page->insertRecord(record);
+            freeBytes = page->getFreeSpace();
+        }
+        setClass(pageNo, classOf(freeBytes));
+        return rid;
+    }
+
+    std::string HeapFile::getRecord(const RecordId& rid)
+    {
+        checkRecordId(rid);
+        ReadPageGuard page = bufMgr.readPageGuard(&file, rid.page_number);
+        return page->getRecord(rid);
+    }
+
+    void HeapFile::updateRecord(const RecordId& rid, const std::string& record)
+    {
+        checkRecordId(rid);
+        std::uint32_t freeBytes;
+        {
+            WritePageGuard page = bufMgr.writePageGuard(&file, rid.page_number);
+            page->updateRecord(rid, record);
+            freeBytes = page->getFreeSpace();
+        }
+        setClass(rid.page_number, classOf(freeBytes));
+    }
+
+    void HeapFile::deleteRecord(const RecordId& rid)
+    {
+        checkRecordId(rid);
+        std::uint32_t freeBytes;
+        {
+            WritePageGuard page = bufMgr.writePageGuard(&file, rid.page_number);
+            page->deleteRecord(rid);
+            freeBytes = page->getFreeSpace();
+        }
+        setClass(rid.page_number, classOf(freeBytes));
+    }
+
+    std::uint32_t HeapFile::getFreeSpaceClass(const PageId pageNo) const
+    {
+        return pageNo < classes.size() ? classes[pageNo] : 0;
+    }
+
+    /**
+     * Throw InvalidRecordException unless a record identifier names a data page of the heap
+     */
+    void HeapFile::checkRecordId(const RecordId& rid) const
+    {
+        if (rid.page_number == Page::INVALID_NUMBER || rid.page_number >= classes.size() ||
+            isFsmPage(rid.page_number))
+        {
+            throw InvalidRecordException(rid, rid.page_number);
+        }
+    }
+
+    /**
+     * Find a page of at least the given free-space class, or add one
+     */
+    PageId HeapFile::findPage(const std::uint32_t minClass)
+    {
+        for (std::uint32_t pageClass = minClass; pageClass <= MAX_CLASS; pageClass++)
+        {
+            std::vector<PageId>& pages = candidates[pageClass];
+            while (!pages.empty())
+            {
+                const PageId pageNo = pages.back();
+                if (classes[pageNo] == pageClass)
+                {
+                    return pageNo;
+                }
+                pages.pop_back();
+                numCandidates--;
+            }
+        }
+        return addDataPage();
+    }
+
+    /**
+     * Add an empty data page to the last group
+     */
+    PageId HeapFile::addDataPage()
+    {
+        PageId pageNo;
+        {
+            WritePageGuard page = bufMgr.allocPageGuard(&file, pageNo);
+        }
+        assert(pageNo == classes.size());
+        classes.push_back(0);
+        numDataPages++;
+        setClass(pageNo, MAX_CLASS);
+        if (classes.size() == lastFsmPage + 1 + PAGES_PER_FSM)
+        {
+            addFsmPage();
+        }
+        return pageNo;
+    }
+
+    /**
+     * Allocate the FSM page of a new, empty group
+     */
+    void HeapFile::addFsmPage()
+    {
+        PageId pageNo;
+        WritePageGuard page = bufMgr.allocPageGuard(&file, pageNo);
+        assert(pageNo == classes.size() && isFsmPage(pageNo));
+        page->insertRecord(std::string());
+        classes.push_back(0);
+        lastFsmPage = pageNo;
+    }
+
+    /**
+     * Record the free-space class of a page in the map, and in its FSM page if it changed
+     */
+    void HeapFile::setClass(const PageId pageNo, const std::uint32_t pageClass)
+    {
+        if (classes[pageNo] == pageClass)
+        {
+            return;
+        }
+        classes[pageNo] = pageClass;
+        if (pageClass > 0)
+        {
+            candidates[pageClass].push_back(pageNo);
+            numCandidates++;
+            //the entries left behind by pages that changed class are dropped only when a
+            //search gets to them; bound how many there can be
+            if (numCandidates > 2 * (std::uint64_t) numDataPages + 64)
+            {
+                rebuildCandidates();
+            }
+        }
+        writeMap(fsmPageOf(pageNo));
+    }
+
+    /**
+     * Write the map of a group from the copy in memory to its FSM page
+     */
+    void HeapFile::writeMap(const PageId fsmPage)
+    {
+        const std::size_t length = std::min<std::size_t>(PAGES_PER_FSM, classes.size() - fsmPage - 1);
+        const std::string map(reinterpret_cast<const char*>(classes.data()) + fsmPage + 1, length);
+        WritePageGuard page = bufMgr.writePageGuard(&file, fsmPage);
+        page->updateRecord({fsmPage, 1}, map);
+    }
+
+    /**
+     * Rebuild the lists of candidates from the map
+     */
+    void HeapFile::rebuildCandidates()
+    {
+        for (std::uint32_t pageClass = 0; pageClass <= MAX_CLASS; pageClass++)
+        {
+            candidates[pageClass].clear();
+        }
+        numCandidates = 0;
+        for (PageId pageNo = 1; pageNo < classes.size(); pageNo++)
+        {
+            if (classes[pageNo] > 0)
+            {
+                candidates[classes[pageNo]].push_back(pageNo);
+                numCandidates++;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,221 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "buffer.h"
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief Records of a file, placed on its pages through a free-space map, and read and
+     * written through a buffer pool
+     *
+     * The file is laid out in groups: a free-space map (FSM) page followed by the data pages
+     * it describes, one byte each.  The byte is the page's free-space class, its free bytes
+     * divided by CLASS_BYTES, so a page of class c has room for a record needing c *
+     * CLASS_BYTES bytes.  The map of a group is the single record of its FSM page and grows
+     * by a byte as each data page is added, so its length also says how many pages the group
+     * has; the FSM page of the next group is allocated as soon as one fills up.
+     *
+     * A copy of the map kept in memory, with the pages of each class in a list of
+     * candidates, lets insertRecord() find a page with room without reading any other page.
+     * Only changes of class are written to the FSM pages.
+     *
+     * The file must hold nothing but the heap and be changed only through it.  Records are
+     * not logged, whether or not the pool has a LogManager.
+     *
+     * @warning This class is not threadsafe.
+     */
+    class HeapFile
+    {
+    public:
+        /**
+         * Bytes of free space per step of the free-space class
+         */
+        static const std::uint32_t CLASS_BYTES = 32;
+
+        /**
+         * Highest free-space class, that of an empty page
+         */
+        static const std::uint32_t MAX_CLASS = Page::DATA_SIZE / CLASS_BYTES;
+
+        /**
+         * Number of data pages described by one FSM page
+         */
+        static const std::uint32_t PAGES_PER_FSM = Page::DATA_SIZE - sizeof(PageSlot);
+
+        /**
+         * Constructor of HeapFile class; reads the free-space map of the file, or starts one
+         * if the file is empty
+         *
+         * @param bufMgr		Pool the pages are read and written through; must outlive the heap
+         * @param file		File of the heap; must outlive the heap
+         */
+        HeapFile(BufMgr& bufMgr, File& file);
+
+        /**
+         * Insert a record on a page with room for it, adding a page if none has
+         *
+         * @param record		Contents of the record
+         * @return 		Identifier of the new record
+         * @throws  InsufficientSpaceException if the record does not fit even on an empty page
+         */
+        RecordId insertRecord(const std::string& record);
+
+        /**
+         * Read a record
+         *
+         * @param rid		Identifier of the record
+         * @return 		Contents of the record
+         * @throws  InvalidRecordException if there is no such record
+         */
+        std::string getRecord(const RecordId& rid);
+
+        /**
+         * Replace the contents of a record, keeping its identifier
+         *
+         * @param rid		Identifier of the record
+         * @param record		New contents of the record
+         * @throws  InvalidRecordException if there is no such record
+         * @throws  InsufficientSpaceException if the new contents do not fit on the record's page
+         */
+        void updateRecord(const RecordId& rid, const std::string& record);
+
+        /**
+         * Delete a record; its space is reused by later inserts
+         *
+         * @param rid		Identifier of the record
+         * @throws  InvalidRecordException if there is no such record
+         */
+        void deleteRecord(const RecordId& rid);
+
+        /**
+         * Number of data pages in the heap
+         */
+        std::uint32_t getNumDataPages() const
+        {
+            return numDataPages;
+        }
+
+        /**
+         * Free-space class the map records for a data page
+         *
+         * @param pageNo		Number of the page
+         */
+        std::uint32_t getFreeSpaceClass(const PageId pageNo) const;
+
+        /**
+         * Whether a page of a heap file is an FSM page rather than a data page
+         *
+         * @param pageNo		Number of the page
+         */
+        static bool isFsmPage(const PageId pageNo)
+        {
+            return (pageNo - 1) % (PAGES_PER_FSM + 1) == 0;
+        }
+
+    private:
+        HeapFile(const HeapFile&);
+        HeapFile& operator=(const HeapFile&);
+
+        /**
+         * Free-space class of a page with the given number of free bytes
+         */
+        static std::uint32_t classOf(const std::uint32_t freeBytes)
+        {
+            return freeBytes / CLASS_BYTES;
+        }
+
+        /**
+         * Number of the FSM page describing a data page
+         */
+        static PageId fsmPageOf(const PageId pageNo)
+        {
+            return pageNo - (pageNo - 1) % (PAGES_PER_FSM + 1);
+        }
+
+        /**
+         * Throw InvalidRecordException unless a record identifier names a data page of the heap
+         */
+        void checkRecordId(const RecordId& rid) const;
+
+        /**
+         * Find a page of at least the given free-space class, or add one
+         */
+        PageId findPage(const std::uint32_t minClass);
+
+        /**
+         * Add an empty data page to the last group, and the FSM page of the next group if
+         * that fills it up
+         */
+        PageId addDataPage();
+
+        /**
+         * Allocate the FSM page of a new, empty group
+         */
+        void addFsmPage();
+
+        /**
+         * Record the free-space class of a page in the map, and in its FSM page if it changed
+         */
+        void setClass(const PageId pageNo, const std::uint32_t pageClass);
+
+        /**
+         * Write the map of a group from the copy in memory to its FSM page
+         */
+        void writeMap(const PageId fsmPage);
+
+        /**
+         * Rebuild the lists of candidates from the map, dropping stale entries
+         */
+        void rebuildCandidates();
+
+        /**
+         * Pool the pages go through
+         */
+        BufMgr& bufMgr;
+
+        /**
+         * File of the heap
+         */
+        File& file;
+
+        /**
+         * Free-space class of each page, indexed by page number; 0 for FSM pages
+         */
+        std::vector<std::uint8_t> classes;
+
+        /**
+         * Pages of each free-space class above 0, indexed by class.  An entry whose page has
+         * since changed class is stale and dropped when it is come across.
+         */
+        std::vector<std::vector<PageId> > candidates;
+
+        /**
+         * Number of entries in candidates, stale ones included
+         */
+        std::uint64_t numCandidates;
+
+        /**
+         * Number of data pages in the heap
+         */
+        std::uint32_t numDataPages;
+
+        /**
+         * Number of the last FSM page, whose group new data pages are added to
+         */
+        PageId lastFsmPage;
+    };
+
+}
@@ -0,0 +1,659 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "log_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "exceptions/invalid_page_exception.h"
+#include "exceptions/log_exception.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * First bytes of every log file.
+ */
+const char LOG_MAGIC[16] = "BadgerDB WAL 2";
+
+/**
+ * Header at the start of every log file; the first record follows it.
+ */
+struct LogFileHeader {
+  /**
+   * LOG_MAGIC.
+   */
+  char magic[sizeof(LOG_MAGIC)];
+
+  /**
+   * LSN of the last durable checkpoint record, or 0.  Updated in place once
+   * the checkpoint is durable.
+   */
+  Lsn checkpointLsn;
+
+  /**
+   * Unused.
+   */
+  Lsn reserved;
+};
+
+/**
+ * LSN of the first record of every log.
+ */
+const Lsn LOG_START = sizeof(LogFileHeader);
+
+/**
+ * Record types.
+ */
+enum LogRecordType {
+  /**
+   * Names the file a file number stands for, until the number is reused.
+   */
+  LOG_FILE = 1,
+
+  /**
+   * New contents of a byte range of a page.
+   */
+  LOG_UPDATE = 2,
+
+  /**
+   * Every change before this record is committed.
+   */
+  LOG_COMMIT = 3,
+
+  /**
+   * Dirty-page table and file names of a fuzzy checkpoint.
+   */
+  LOG_CHECKPOINT = 4
+};
+
+/**
+ * Header of every log record; the payload follows it.
+ */
+struct LogRecordHeader {
+  /**
+   * Length of the record, header included.
+   */
+  std::uint32_t size;
+
+  /**
+   * Checksum of the record, computed with this field 0.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * LSN of the record, so that stale bytes past the end are not mistaken for
+   * a record.
+   */
+  Lsn lsn;
+
+  /**
+   * One of LogRecordType.
+   */
+  std::uint16_t type;
+
+  /**
+   * Offset of the changed range within the page.
+   */
+  std::uint16_t offset;
+
+  /**
+   * Number of the file, as named by an earlier LOG_FILE record.
+   */
+  std::uint32_t fileNo;
+
+  /**
+   * Number of the changed page.
+   */
+  PageId pageNo;
+
+  /**
+   * Length of the payload.
+   */
+  std::uint32_t length;
+};
+
+/**
+ * Records whose changed ranges are separated by fewer equal bytes than this
+ * are merged, since a record header costs about as much.
+ */
+const std::size_t DIFF_MERGE_GAP = sizeof(LogRecordHeader);
+
+/**
+ * Number of changed pages recover() keeps in memory before writing them.
+ */
+const std::size_t REDO_BATCH_PAGES = 4096;
+
+/**
+ * FNV-1a over <length> bytes, continuing from <hash>.
+ */
+std::uint32_t checksum(const char* data, const std::size_t length,
+                       std::uint32_t hash = 2166136261u) {
+  for (std::size_t i = 0; i < length; ++i) {
+    hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Writes all of <data> at <offset>, retrying short writes.
+ */
+bool writeFully(int fd, const char* data, std::size_t length, off_t offset) {
+  while (length > 0) {
+    const ssize_t written = pwrite(fd, data, length, offset);
+    if (written < 0) {
+      return false;
+    }
+    data += written;
+    length -= written;
+    offset += written;
+  }
+  return true;
+}
+
+/**
+ * Appends the bytes of <value> to <out>.
+ */
+template <typename T>
+void put(std::vector<char>& out, const T& value) {
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+/**
+ * Reads a <T> from <in> at <pos> and advances <pos>, unless <in> is too short.
+ */
+template <typename T>
+bool get(const std::vector<char>& in, std::size_t& pos, T& value) {
+  if (pos + sizeof(value) > in.size()) {
+    return false;
+  }
+  std::memcpy(&value, &in[pos], sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+/**
+ * Writes the redone pages back to their files, in page order.
+ */
+std::uint64_t writeRedone(std::map<std::pair<File*, PageId>, Page>& pages) {
+  std::map<File*, std::vector<const Page*> > byFile;
+  for (std::map<std::pair<File*, PageId>, Page>::const_iterator it =
+           pages.begin();
+       it != pages.end(); ++it) {
+    byFile[it->first.first].push_back(&it->second);
+  }
+  for (std::map<File*, std::vector<const Page*> >::iterator it =
+           byFile.begin();
+       it != byFile.end(); ++it) {
+    it->first->writePages(it->second);
+  }
+  const std::uint64_t written = pages.size();
+  pages.clear();
+  return written;
+}
+
+}
+
+LogManager::LogManager(const std::string& path, const LogOptions& options)
+    : path_(path),
+      options_(options),
+      fd_(-1),
+      bufferLsn_(LOG_START),
+      flushedLsn_(LOG_START),
+      end_(LOG_START),
+      checkpointLsn_(0),
+      redoLsn_(LOG_START),
+      flushing_(false),
+      fileNames_(1) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) {
+    throw LogException(path, "open");
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    ::close(fd_);
+    throw LogException(path, "stat");
+  }
+  LogFileHeader header;
+  if (st.st_size == 0) {
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    if (!writeFully(fd_, reinterpret_cast<const char*>(&header),
+                    sizeof(header), 0) ||
+        (options_.sync && fdatasync(fd_) != 0)) {
+      ::close(fd_);
+      throw LogException(path, "create");
+    }
+    return;
+  }
+  if (pread(fd_, &header, sizeof(header), 0) != (ssize_t) sizeof(header) ||
+      std::memcmp(header.magic, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+    ::close(fd_);
+    throw LogException(path, "open (not a log file)");
+  }
+
+  // Everything up to the checkpoint was durable before the header pointed at
+  // it, so only the records after it need checking.
+  const Lsn fileEnd = st.st_size;
+  Lsn lsn = LOG_START;
+  std::vector<std::string> checkpointFiles;
+  if (header.checkpointLsn != 0 &&
+      readCheckpoint(header.checkpointLsn, fileEnd, redoLsn_,
+                     checkpointFiles)) {
+    checkpointLsn_ = header.checkpointLsn;
+    lsn = checkpointLsn_;
+  }
+  // Find the end of the intact records and cut off anything after it.
+  std::uint16_t type, offset;
+  std::uint32_t fileNo;
+  PageId pageNo;
+  std::vector<char> payload;
+  for (Lsn next; (next = readRecord(lsn, fileEnd, type, fileNo, pageNo, offset,
+                                    payload)) != 0;) {
+    lsn = next;
+  }
+  if (lsn < fileEnd && ftruncate(fd_, lsn) != 0) {
+    ::close(fd_);
+    throw LogException(path, "truncate");
+  }
+  bufferLsn_ = lsn;
+  flushedLsn_ = lsn;
+  end_ = lsn;
+}
+
+LogManager::~LogManager() {
+  try {
+    flush(endLsn() - 1);
+  } catch (LogException&) {
+  }
+  ::close(fd_);
+}
+
+Lsn LogManager::logUpdate(const File& file, Page& page,
+                          const std::size_t offset, const std::size_t length) {
+  std::lock_guard<std::mutex> guard(latch_);
+  const Lsn lsn = append(LOG_UPDATE, fileNumber(file), page.page_number(),
+                         (std::uint16_t) offset,
+                         reinterpret_cast<const char*>(&page) + offset, length);
+  page.set_lsn(lsn);
+  return lsn;
+}
+
+Lsn LogManager::logPageDiff(const File& file, const Page& before,
+                            Page& after) {
+  const char* old = reinterpret_cast<const char*>(&before);
+  const char* now = reinterpret_cast<const char*>(&after);
+  std::vector<std::pair<std::size_t, std::size_t> > ranges;
+  std::size_t i = 0;
+  while (i < Page::SIZE) {
+    // Skip equal bytes a word at a time where possible.
+    while (i + sizeof(std::uint64_t) <= Page::SIZE &&
+           std::memcmp(old + i, now + i, sizeof(std::uint64_t)) == 0) {
+      i += sizeof(std::uint64_t);
+    }
+    while (i < Page::SIZE && old[i] == now[i]) {
+      ++i;
+    }
+    if (i == Page::SIZE) {
+      break;
+    }
+    std::size_t end = i + 1;
+    std::size_t equal = 0;
+    while (end + equal < Page::SIZE && equal < DIFF_MERGE_GAP) {
+      if (old[end + equal] == now[end + equal]) {
+        ++equal;
+      } else {
+        end += equal + 1;
+        equal = 0;
+      }
+    }
+    ranges.push_back(std::make_pair(i, end - i));
+    i = end;
+  }
+  if (ranges.empty()) {
+    return after.lsn();
+  }
+
+  std::lock_guard<std::mutex> guard(latch_);
+  const std::uint32_t fileNo = fileNumber(file);
+  Lsn lsn = 0;
+  for (std::size_t r = 0; r < ranges.size(); ++r) {
+    lsn = append(LOG_UPDATE, fileNo, after.page_number(),
+                 (std::uint16_t) ranges[r].first, now + ranges[r].first,
+                 ranges[r].second);
+  }
+  after.set_lsn(lsn);
+  return lsn;
+}
+
+Lsn LogManager::commit() {
+  Lsn lsn;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    lsn = append(LOG_COMMIT, 0, 0, 0, NULL, 0);
+    stats_.commits++;
+  }
+  flush(lsn);
+  return lsn;
+}
+
+void LogManager::flush(const Lsn lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (lsn >= flushedLsn_ && lsn < bufferLsn_ + buffer_.size()) {
+    if (flushing_) {
+      // The write in progress may cover this record; if not, lead the next.
+      flushed_.wait(lock);
+      continue;
+    }
+    flushing_ = true;
+    if (options_.groupCommitMicros > 0) {
+      lock.unlock();
+      std::this_thread::sleep_for(
+          std::chrono::microseconds(options_.groupCommitMicros));
+      lock.lock();
+    }
+    std::vector<char> out;
+    out.swap(buffer_);
+    const Lsn start = bufferLsn_;
+    bufferLsn_ += out.size();
+    lock.unlock();
+
+    const bool ok = writeFully(fd_, &out[0], out.size(), start) &&
+                    (!options_.sync || fdatasync(fd_) == 0);
+
+    lock.lock();
+    flushing_ = false;
+    if (!ok) {
+      // Put the records back so that a later flush retries them.
+      out.insert(out.end(), buffer_.begin(), buffer_.end());
+      buffer_.swap(out);
+      bufferLsn_ = start;
+      flushed_.notify_all();
+      throw LogException(path_, "write");
+    }
+    flushedLsn_ = start + out.size();
+    stats_.flushes++;
+    flushed_.notify_all();
+  }
+}
+
+Lsn LogManager::flushedLsn() const {
+  std::lock_guard<std::mutex> guard(latch_);
+  return flushedLsn_;
+}
+
+Lsn LogManager::logCheckpoint(const Lsn beginLsn,
+                              const std::vector<DirtyPage>& dirtyPages) {
+  Lsn redo = beginLsn;
+  Lsn lsn;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    std::vector<std::uint32_t> numbers(dirtyPages.size());
+    for (std::size_t p = 0; p < dirtyPages.size(); ++p) {
+      numbers[p] = fileNumber(*dirtyPages[p].file);
+      redo = std::min(redo, dirtyPages[p].recLsn);
+    }
+    // Name every file numbered so far: changes after the redo LSN may refer
+    // to numbers whose LOG_FILE record precedes it.
+    std::vector<char> payload;
+    put(payload, beginLsn);
+    put(payload, redo);
+    put(payload, (std::uint32_t) fileNames_.size());
+    put(payload, (std::uint32_t) dirtyPages.size());
+    for (std::size_t f = 1; f < fileNames_.size(); ++f) {
+      put(payload, (std::uint32_t) fileNames_[f].size());
+      payload.insert(payload.end(), fileNames_[f].begin(),
+                     fileNames_[f].end());
+    }
+    for (std::size_t p = 0; p < dirtyPages.size(); ++p) {
+      put(payload, numbers[p]);
+      put(payload, dirtyPages[p].pageNo);
+      put(payload, dirtyPages[p].recLsn);
+    }
+    lsn = append(LOG_CHECKPOINT, 0, 0, 0, &payload[0], payload.size());
+  }
+  flush(lsn);
+
+  std::lock_guard<std::mutex> guard(latch_);
+  if (lsn > checkpointLsn_) {
+    if (!writeFully(fd_, reinterpret_cast<const char*>(&lsn), sizeof(lsn),
+                    offsetof(LogFileHeader, checkpointLsn)) ||
+        (options_.sync && fdatasync(fd_) != 0)) {
+      throw LogException(path_, "write checkpoint");
+    }
+    checkpointLsn_ = lsn;
+    redoLsn_ = redo;
+  }
+  return redoLsn_;
+}
+
+Lsn LogManager::redoLsn() const {
+  std::lock_guard<std::mutex> guard(latch_);
+  return redoLsn_;
+}
+
+RedoStats LogManager::recover(const std::vector<File*>& files) {
+  flush(endLsn() - 1);
+  const Lsn end = flushedLsn();
+  RedoStats redo;
+  std::uint16_t type, offset;
+  std::uint32_t fileNo;
+  PageId pageNo;
+  std::vector<char> payload;
+
+  std::map<std::string, File*> byName;
+  for (std::size_t f = 0; f < files.size(); ++f) {
+    byName[files[f]->filename()] = files[f];
+  }
+  std::vector<File*> fileOf;
+  Lsn checkpointLsn;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    checkpointLsn = checkpointLsn_;
+    redo.redoLsn = redoLsn_;
+  }
+  std::vector<std::string> checkpointFiles;
+  Lsn ignored;
+  if (checkpointLsn != 0 &&
+      readCheckpoint(checkpointLsn, end, ignored, checkpointFiles)) {
+    for (std::size_t f = 0; f < checkpointFiles.size(); ++f) {
+      std::map<std::string, File*>::const_iterator found =
+          byName.find(checkpointFiles[f]);
+      fileOf.push_back(found == byName.end() ? NULL : found->second);
+    }
+  }
+
+  // Changes after the last commit are not replayed.
+  Lsn lastCommit = 0;
+  for (Lsn lsn = redo.redoLsn, next;
+       (next = readRecord(lsn, end, type, fileNo, pageNo, offset, payload)) !=
+       0;
+       lsn = next) {
+    if (type == LOG_COMMIT) {
+      lastCommit = lsn;
+    }
+  }
+
+  std::map<std::pair<File*, PageId>, Page> pages;
+  for (Lsn lsn = redo.redoLsn, next;
+       (next = readRecord(lsn, end, type, fileNo, pageNo, offset, payload)) !=
+       0;
+       lsn = next) {
+    redo.recordsScanned++;
+    if (type == LOG_FILE) {
+      if (fileNo >= fileOf.size()) {
+        fileOf.resize(fileNo + 1, NULL);
+      }
+      std::map<std::string, File*>::const_iterator found =
+          byName.find(std::string(payload.begin(), payload.end()));
+      fileOf[fileNo] = found == byName.end() ? NULL : found->second;
+      continue;
+    }
+    if (type != LOG_UPDATE) {
+      continue;
+    }
+    if (lsn > lastCommit) {
+      redo.recordsUncommitted++;
+      continue;
+    }
+    File* file = fileNo < fileOf.size() ? fileOf[fileNo] : NULL;
+    if (file == NULL) {
+      redo.recordsSkipped++;
+      continue;
+    }
+    const std::pair<File*, PageId> key(file, pageNo);
+    std::map<std::pair<File*, PageId>, Page>::iterator page = pages.find(key);
+    if (page == pages.end()) {
+      Page onDisk;
+      try {
+        onDisk = file->readPage(pageNo);
+      } catch (InvalidPageException&) {
+        // The page was deleted after the change.
+        redo.recordsSkipped++;
+        continue;
+      }
+      if (onDisk.lsn() >= lsn) {
+        redo.recordsSkipped++;
+        continue;
+      }
+      if (pages.size() >= REDO_BATCH_PAGES) {
+        redo.pagesWritten += writeRedone(pages);
+      }
+      page = pages.insert(std::make_pair(key, onDisk)).first;
+    } else if (page->second.lsn() >= lsn) {
+      redo.recordsSkipped++;
+      continue;
+    }
+    std::memcpy(reinterpret_cast<char*>(&page->second) + offset, &payload[0],
+                payload.size());
+    page->second.set_lsn(lsn);
+    redo.recordsApplied++;
+  }
+  redo.pagesWritten += writeRedone(pages);
+  return redo;
+}
+
+LogStats LogManager::stats() const {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
+Lsn LogManager::append(const std::uint16_t type, const std::uint32_t fileNo,
+                       const PageId pageNo, const std::uint16_t offset,
+                       const char* data, const std::size_t length) {
+  LogRecordHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.size = (std::uint32_t) (sizeof(header) + length);
+  header.lsn = bufferLsn_ + buffer_.size();
+  header.type = type;
+  header.offset = offset;
+  header.fileNo = fileNo;
+  header.pageNo = pageNo;
+  header.length = (std::uint32_t) length;
+  header.checksum = checksum(data, length,
+                             checksum(reinterpret_cast<const char*>(&header),
+                                      sizeof(header)));
+
+  const char* bytes = reinterpret_cast<const char*>(&header);
+  buffer_.insert(buffer_.end(), bytes, bytes + sizeof(header));
+  buffer_.insert(buffer_.end(), data, data + length);
+  end_.store(bufferLsn_ + buffer_.size(), std::memory_order_release);
+  stats_.records++;
+  stats_.bytes += header.size;
+  return header.lsn;
+}
+
+std::uint32_t LogManager::fileNumber(const File& file) {
+  if (file.id() >= fileNumbers_.size()) {
+    fileNumbers_.resize(file.id() + 1, 0);
+  }
+  std::uint32_t& number = fileNumbers_[file.id()];
+  if (number == 0) {
+    number = (std::uint32_t) fileNames_.size();
+    fileNames_.push_back(file.filename());
+    append(LOG_FILE, number, 0, 0, file.filename().data(),
+           file.filename().size());
+  }
+  return number;
+}
+
+bool LogManager::readCheckpoint(const Lsn lsn, const Lsn end, Lsn& redo,
+                                std::vector<std::string>& fileOf) const {
+  std::uint16_t type, offset;
+  std::uint32_t fileNo;
+  PageId pageNo;
+  std::vector<char> payload;
+  if (readRecord(lsn, end, type, fileNo, pageNo, offset, payload) == 0 ||
+      type != LOG_CHECKPOINT) {
+    return false;
+  }
+  std::size_t pos = 0;
+  Lsn beginLsn;
+  std::uint32_t numFiles, numPages;
+  if (!get(payload, pos, beginLsn) || !get(payload, pos, redo) ||
+      !get(payload, pos, numFiles) || !get(payload, pos, numPages)) {
+    return false;
+  }
+  fileOf.assign(numFiles > 0 ? numFiles : 1, std::string());
+  for (std::uint32_t f = 1; f < numFiles; ++f) {
+    std::uint32_t length;
+    if (!get(payload, pos, length) || pos + length > payload.size()) {
+      return false;
+    }
+    fileOf[f].assign(&payload[pos], length);
+    pos += length;
+  }
+  return true;
+}
+
+Lsn LogManager::readRecord(const Lsn lsn, const Lsn end, std::uint16_t& type,
+                           std::uint32_t& fileNo, PageId& pageNo,
+                           std::uint16_t& offset,
+                           std::vector<char>& payload) const {
+  LogRecordHeader header;
+  if (lsn + sizeof(header) > end ||
+      pread(fd_, &header, sizeof(header), lsn) != (ssize_t) sizeof(header) ||
+      header.lsn != lsn || header.size != sizeof(header) + header.length ||
+      lsn + header.size > end) {
+    return 0;
+  }
+  if (header.type == LOG_UPDATE &&
+      (std::size_t) header.offset + header.length > Page::SIZE) {
+    return 0;
+  }
+  payload.resize(header.length);
+  if (header.length > 0 &&
+      pread(fd_, &payload[0], header.length, lsn + sizeof(header)) !=
+          (ssize_t) header.length) {
+    return 0;
+  }
+  const std::uint32_t expected = header.checksum;
+  header.checksum = 0;
+  if (checksum(payload.empty() ? NULL : &payload[0], payload.size(),
+               checksum(reinterpret_cast<const char*>(&header),
+                        sizeof(header))) != expected) {
+    return 0;
+  }
+  type = header.type;
+  fileNo = header.fileNo;
+  pageNo = header.pageNo;
+  offset = header.offset;
+  return lsn + header.size;
+}
+
+}
@@ -0,0 +1,419 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "file.h"
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Options controlling how a LogManager makes the log durable.
+ */
+struct LogOptions {
+  /**
+   * Call fdatasync() after every write of the log.  Only benchmarks and tests
+   * that do not care about surviving a power failure should turn this off.
+   */
+  bool sync;
+
+  /**
+   * How long the thread that flushes the log for a commit waits for other
+   * commits to join the same write, in microseconds.  0 still groups every
+   * commit that arrives while a previous flush is in progress.
+   */
+  std::uint32_t groupCommitMicros;
+
+  /**
+   * Constructs the default options: synced flushes, no added delay.
+   */
+  LogOptions() : sync(true), groupCommitMicros(0) {}
+};
+
+/**
+ * @brief Counters of a LogManager since it was opened.
+ */
+struct LogStats {
+  /**
+   * Number of records appended.
+   */
+  std::uint64_t records;
+
+  /**
+   * Number of bytes appended.
+   */
+  std::uint64_t bytes;
+
+  /**
+   * Number of commit records appended.
+   */
+  std::uint64_t commits;
+
+  /**
+   * Number of writes (and syncs) of the log; fewer than commits when commits
+   * were grouped.
+   */
+  std::uint64_t flushes;
+
+  /**
+   * Constructs zeroed counters.
+   */
+  LogStats() : records(0), bytes(0), commits(0), flushes(0) {}
+};
+
+/**
+ * @brief A page that may hold changes its file does not have yet, as recorded
+ *        by a checkpoint.
+ */
+struct DirtyPage {
+  /**
+   * File the page belongs to.
+   */
+  const File* file;
+
+  /**
+   * Number of the page.
+   */
+  PageId pageNo;
+
+  /**
+   * Recovery LSN: every change of the page that its file may not have is at
+   * or after this LSN.
+   */
+  Lsn recLsn;
+};
+
+/**
+ * @brief Outcome of LogManager::recover().
+ */
+struct RedoStats {
+  /**
+   * LSN redo started from: the lowest recovery LSN of the last checkpoint, or
+   * the start of the log if there was none.
+   */
+  Lsn redoLsn;
+
+  /**
+   * Number of log records read.
+   */
+  std::uint64_t recordsScanned;
+
+  /**
+   * Number of page changes applied to the files.
+   */
+  std::uint64_t recordsApplied;
+
+  /**
+   * Number of page changes not applied because the page on disk already had
+   * them, the page no longer exists, or its file was not given.
+   */
+  std::uint64_t recordsSkipped;
+
+  /**
+   * Number of page changes not applied because no commit followed them.
+   */
+  std::uint64_t recordsUncommitted;
+
+  /**
+   * Number of pages written back to the files.
+   */
+  std::uint64_t pagesWritten;
+
+  /**
+   * Constructs zeroed counters.
+   */
+  RedoStats()
+      : redoLsn(0),
+        recordsScanned(0),
+        recordsApplied(0),
+        recordsSkipped(0),
+        recordsUncommitted(0),
+        pagesWritten(0) {}
+};
+
+/**
+ * @brief Append-only write-ahead log of page changes, with group commit and
+ *        redo recovery.
+ *
+ * A change to a buffered page is logged (as the new contents of the byte
+ * ranges that changed) while the page is pinned, which stamps the page with
+ * the record's LSN; the page is then unpinned dirty as usual.  commit() makes
+ * every change logged so far durable with one sequential write and sync of the
+ * log, so the changed pages themselves can be written back whenever the buffer
+ * manager gets to them.  A BufMgr given the log in BufMgrOptions::log flushes
+ * the log up to a page's LSN before writing the page, so a page on disk never
+ * holds a change the log could lose.
+ *
+ * After a crash, recover() replays the changes of the log onto the files up to
+ * the last commit, starting from the redo LSN of the last checkpoint (see
+ * logCheckpoint()) so that its work is bounded by the log written since.  Recovery only redoes: a change that was logged but not
+ * committed may still have reached its file if the buffer manager wrote the
+ * page back (the log having been flushed for it), so callers that need commits
+ * to be atomic must keep such pages pinned until they commit.
+ *
+ * All methods may be called concurrently.
+ */
+class LogManager {
+ public:
+  /**
+   * Opens the log at <path>, creating it if it does not exist.  A torn record
+   * at the end of an existing log (from a crash in the middle of a write) is
+   * cut off.
+   *
+   * @param path     Path of the log file.
+   * @param options  Durability and group commit options.
+   * @throws  LogException  If the log cannot be opened or is not a log.
+   */
+  explicit LogManager(const std::string& path,
+                      const LogOptions& options = LogOptions());
+
+  /**
+   * Flushes whatever is left of the log and closes it.
+   */
+  ~LogManager();
+
+  /**
+   * Logs the new contents of a byte range of a page and stamps the page with
+   * the record's LSN.  The page must be pinned by the caller, which must then
+   * unpin it dirty.
+   *
+   * @param file    File the page belongs to.
+   * @param page    Changed page.
+   * @param offset  Offset of the range within the page, header included.
+   * @param length  Length of the range.
+   * @return  LSN of the record.
+   */
+  Lsn logUpdate(const File& file, Page& page, const std::size_t offset,
+                const std::size_t length);
+
+  /**
+   * Logs the byte ranges in which <after> differs from <before>, a copy of the
+   * page taken before it was changed, and stamps <after> with the LSN of the
+   * last record.  Ranges separated by only a few equal bytes are logged as
+   * one.
+   *
+   * @param file    File the page belongs to.
+   * @param before  Contents of the page before the change.
+   * @param after   Page after the change; must be pinned by the caller.
+   * @return  LSN of the last record, or the page's LSN if nothing changed.
+   */
+  Lsn logPageDiff(const File& file, const Page& before, Page& after);
+
+  /**
+   * Logs a commit and returns once it, and every record before it, is durable.
+   * Commits of concurrent callers are made durable by the same write.
+   *
+   * @return  LSN of the commit record.
+   */
+  Lsn commit();
+
+  /**
+   * Makes the record at <lsn>, and every record before it, durable.
+   *
+   * @param lsn  LSN of a record, such as a page's LSN; 0 does nothing.
+   */
+  void flush(const Lsn lsn);
+
+  /**
+   * Returns the offset up to which the log is durable; every record at an LSN
+   * below it is durable.
+   */
+  Lsn flushedLsn() const;
+
+  /**
+   * Returns the LSN the next record will get.  Does not take the latch.
+   */
+  Lsn endLsn() const { return end_.load(std::memory_order_acquire); }
+
+  /**
+   * Logs a fuzzy checkpoint: the pages that may hold changes their files do not
+   * have yet, with their recovery LSNs, taken while the pool kept running.
+   * Once the checkpoint is durable, the log header is pointed at it, and
+   * recovery starts from the lowest of <beginLsn> and those recovery LSNs
+   * instead of from the start of the log.  The table must cover every page
+   * changed under this log, so a log shared by several buffer pools must be
+   * checkpointed with all of their tables at once.
+   *
+   * @param beginLsn    endLsn() from before the table was collected.
+   * @param dirtyPages  Dirty (and pinned) pages of the buffer pool.
+   * @return  The new redo LSN.
+   */
+  Lsn logCheckpoint(const Lsn beginLsn,
+                    const std::vector<DirtyPage>& dirtyPages);
+
+  /**
+   * Returns the LSN recovery would start from: that of the last checkpoint,
+   * or the start of the log.
+   */
+  Lsn redoLsn() const;
+
+  /**
+   * Replays the committed changes of the log onto the files, skipping those a
+   * page already has.  Meant to run after a restart, before the files are used
+   * through a buffer manager.
+   *
+   * @param files  Open files whose pages may be changed, matched by name.
+   * @return  What was replayed.
+   */
+  RedoStats recover(const std::vector<File*>& files);
+
+  /**
+   * Returns the counters of this log since it was opened.
+   */
+  LogStats stats() const;
+
+  /**
+   * Returns the path of the log file.
+   */
+  const std::string& path() const { return path_; }
+
+ private:
+  LogManager(const LogManager&);
+  LogManager& operator=(const LogManager&);
+
+  /**
+   * Appends a record to the log buffer.  The latch must be held.
+   *
+   * @param type     Record type.
+   * @param fileNo   Number the log gave the file, or 0.
+   * @param pageNo   Page number, or 0.
+   * @param offset   Offset of the range within the page, or 0.
+   * @param data     Payload.
+   * @param length   Length of the payload.
+   * @return  LSN of the record.
+   */
+  Lsn append(const std::uint16_t type, const std::uint32_t fileNo,
+             const PageId pageNo, const std::uint16_t offset,
+             const char* data, const std::size_t length);
+
+  /**
+   * Returns the number this log gives the file, logging the file's name the
+   * first time.  The latch must be held.
+   *
+   * @param file  File object.
+   */
+  std::uint32_t fileNumber(const File& file);
+
+  /**
+   * Reads the checkpoint record at <lsn>.
+   *
+   * @param lsn      LSN of the checkpoint record.
+   * @param end      Offset of the end of the log.
+   * @param redo     Receives the redo LSN of the checkpoint.
+   * @param fileOf   Receives the file names the checkpoint lists, indexed by
+   *                 file number.
+   * @return  True if there is an intact checkpoint record at <lsn>.
+   */
+  bool readCheckpoint(const Lsn lsn, const Lsn end, Lsn& redo,
+                      std::vector<std::string>& fileOf) const;
+
+  /**
+   * Reads the record at <lsn>.
+   *
+   * @param lsn      LSN of the record.
+   * @param end      Offset of the end of the log.
+   * @param type     Receives the record type.
+   * @param fileNo   Receives the file number.
+   * @param pageNo   Receives the page number.
+   * @param offset   Receives the offset within the page.
+   * @param payload  Receives the payload.
+   * @return  LSN of the next record, or 0 if there is no complete, intact
+   *          record at <lsn>.
+   */
+  Lsn readRecord(const Lsn lsn, const Lsn end, std::uint16_t& type,
+                 std::uint32_t& fileNo, PageId& pageNo, std::uint16_t& offset,
+                 std::vector<char>& payload) const;
+
+  /**
+   * Path of the log file.
+   */
+  const std::string path_;
+
+  /**
+   * Durability and group commit options.
+   */
+  const LogOptions options_;
+
+  /**
+   * Descriptor of the log file.
+   */
+  int fd_;
+
+  /**
+   * Records appended but not yet handed to a flush.
+   */
+  std::vector<char> buffer_;
+
+  /**
+   * LSN of the first byte of buffer_.
+   */
+  Lsn bufferLsn_;
+
+  /**
+   * Offset up to which the log is durable.
+   */
+  Lsn flushedLsn_;
+
+  /**
+   * LSN the next record will get, readable without the latch.
+   */
+  std::atomic<Lsn> end_;
+
+  /**
+   * LSN of the last durable checkpoint record, or 0.
+   */
+  Lsn checkpointLsn_;
+
+  /**
+   * Redo LSN of that checkpoint, or the start of the log.
+   */
+  Lsn redoLsn_;
+
+  /**
+   * Whether a thread is writing the log right now.
+   */
+  bool flushing_;
+
+  /**
+   * Number this log gives each file, indexed by File::id(); 0 until the file's
+   * name has been logged.
+   */
+  std::vector<std::uint32_t> fileNumbers_;
+
+  /**
+   * Name of each file numbered by this LogManager, indexed by number; entry 0
+   * is unused.
+   */
+  std::vector<std::string> fileNames_;
+
+  /**
+   * Counters since the log was opened.
+   */
+  LogStats stats_;
+
+  /**
+   * Latch protecting everything above.
+   */
+  mutable std::mutex latch_;
+
+  /**
+   * Signalled whenever a flush finishes.
+   */
+  std::condition_variable flushed_;
+};
+
+}
@@ -0,0 +1,274 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "lz4.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace badgerdb {
+
+namespace {
+
+// Limits of the block format: every match is at least kMinMatch bytes, the
+// last kLastLiterals bytes are always literals, and no match starts in the
+// last kMatchLimit bytes.
+const std::size_t kMinMatch = 4;
+const std::size_t kLastLiterals = 5;
+const std::size_t kMatchLimit = 12;
+const std::size_t kMaxOffset = 65535;
+
+const int kHashLog = 12;
+
+typedef unsigned char Byte;
+
+std::uint32_t read32(const Byte* p) {
+  std::uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+std::uint64_t read64(const Byte* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+std::uint32_t hashOf(const std::uint32_t sequence) {
+  return (sequence * 2654435761U) >> (32 - kHashLog);
+}
+
+// Writes the 255-runs that extend a length field of 15 in a token.
+Byte* writeLength(Byte* op, std::size_t length) {
+  while (length >= 255) {
+    *op++ = 255;
+    length -= 255;
+  }
+  *op++ = (Byte) length;
+  return op;
+}
+
+// Appends one sequence: the literals from <anchor> up to <literals> bytes,
+// then (unless <matchLength> is 0, for the last sequence) a match of
+// <matchLength> bytes at <offset> back.  Returns NULL if it does not fit.
+Byte* writeSequence(Byte* op, const Byte* outEnd, const Byte* anchor,
+                    const std::size_t literals, const std::size_t offset,
+                    const std::size_t matchLength) {
+  const std::size_t extra = matchLength - (matchLength ? kMinMatch : 0);
+  if ((std::size_t) (outEnd - op) <
+      1 + literals / 255 + 1 + literals + 2 + extra / 255 + 1) {
+    return NULL;
+  }
+  Byte* token = op++;
+  *token = (Byte) ((literals < 15 ? literals : 15) << 4);
+  if (literals >= 15) {
+    op = writeLength(op, literals - 15);
+  }
+  std::memcpy(op, anchor, literals);
+  op += literals;
+  if (matchLength == 0) {
+    return op;
+  }
+  *op++ = (Byte) (offset & 0xFF);
+  *op++ = (Byte) (offset >> 8);
+  *token |= (Byte) (extra < 15 ? extra : 15);
+  if (extra >= 15) {
+    op = writeLength(op, extra - 15);
+  }
+  return op;
+}
+
+// Reads the 255-runs that extend a length field of 15; false if the input
+// ends first.
+bool readLength(const Byte*& ip, const Byte* inEnd, std::size_t& length) {
+  Byte b;
+  do {
+    if (ip >= inEnd) {
+      return false;
+    }
+    b = *ip++;
+    length += b;
+  } while (b == 255);
+  return true;
+}
+
+// Copies <length> bytes sixteen at a time, so it may read and write up to 15
+// bytes past the end; the caller makes sure both buffers have that room.
+// Bytes copied first may be read again by later chunks, which is what
+// matches at an offset of 16 or more need.
+void wildCopy(Byte* dest, const Byte* source, const std::size_t length) {
+  Byte* const end = dest + length;
+  do {
+    std::memcpy(dest, source, 16);
+    dest += 16;
+    source += 16;
+  } while (dest < end);
+}
+
+// Decodes a block into <capacity> bytes.  If <partial>, output beyond the
+// capacity is simply not produced and decoding stops once the output is full;
+// otherwise that makes the block malformed.
+std::size_t decode(const char* source, const std::size_t length, char* dest,
+                   const std::size_t capacity, const bool partial) {
+  const Byte* ip = reinterpret_cast<const Byte*>(source);
+  const Byte* const inEnd = ip + length;
+  Byte* const dst = reinterpret_cast<Byte*>(dest);
+  Byte* op = dst;
+  const Byte* const outEnd = dst + capacity;
+  while (ip < inEnd) {
+    const Byte token = *ip++;
+    std::size_t literals = token >> 4;
+    if (literals == 15 && !readLength(ip, inEnd, literals)) {
+      return partial ? op - dst : 0;
+    }
+    if (partial) {
+      literals = std::min(literals, (std::size_t) (outEnd - op));
+      literals = std::min(literals, (std::size_t) (inEnd - ip));
+    } else if (literals > (std::size_t) (inEnd - ip) ||
+               literals > (std::size_t) (outEnd - op)) {
+      return 0;
+    }
+    if (literals + 16 <= (std::size_t) (inEnd - ip) &&
+        literals + 16 <= (std::size_t) (outEnd - op)) {
+      wildCopy(op, ip, literals);
+    } else {
+      std::memcpy(op, ip, literals);
+    }
+    op += literals;
+    ip += literals;
+    if (ip == inEnd || (partial && op == outEnd)) {
+      break;
+    }
+    if (inEnd - ip < 2) {
+      return partial ? op - dst : 0;
+    }
+    const std::size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (std::size_t) (op - dst)) {
+      return partial ? op - dst : 0;
+    }
+    std::size_t matchLength = token & 15;
+    if (matchLength == 15 && !readLength(ip, inEnd, matchLength)) {
+      return partial ? op - dst : 0;
+    }
+    matchLength += kMinMatch;
+    if (partial) {
+      matchLength = std::min(matchLength, (std::size_t) (outEnd - op));
+    } else if (matchLength > (std::size_t) (outEnd - op)) {
+      return 0;
+    }
+    // The match may overlap the bytes it produces, repeating the last
+    // <offset> bytes; copy from as far back as a whole number of periods
+    // allows, so that the chunks double instead of going a byte at a time.
+    std::size_t done = 0;
+    if (offset >= 16 && matchLength + 16 <= (std::size_t) (outEnd - op)) {
+      wildCopy(op, op - offset, matchLength);
+      done = matchLength;
+    }
+    while (done < matchLength) {
+      const std::size_t distance = (done + offset) / offset * offset;
+      const std::size_t chunk = std::min(distance, matchLength - done);
+      std::memcpy(op + done, op + done - distance, chunk);
+      done += chunk;
+    }
+    op += matchLength;
+    if (partial && op == outEnd) {
+      break;
+    }
+  }
+  return op - dst;
+}
+
+}
+
+std::size_t lz4Compress(const char* source, const std::size_t length,
+                        char* dest, const std::size_t capacity) {
+  const Byte* const src = reinterpret_cast<const Byte*>(source);
+  const Byte* const inEnd = src + length;
+  const Byte* ip = src;
+  const Byte* anchor = src;
+  Byte* const dst = reinterpret_cast<Byte*>(dest);
+  const Byte* const outEnd = dst + capacity;
+  Byte* op = dst;
+
+  if (length >= kMatchLimit + 1) {
+    // Positions are kept relative to <src>; a stale or empty entry is caught
+    // by comparing the bytes.
+    std::uint32_t table[1 << kHashLog];
+    std::memset(table, 0, sizeof(table));
+    const Byte* const searchLimit = inEnd - kMatchLimit;
+    const Byte* const matchEnd = inEnd - kLastLiterals;
+    std::uint32_t misses = 0;
+    while (ip <= searchLimit) {
+      const std::uint32_t sequence = read32(ip);
+      const std::uint32_t h = hashOf(sequence);
+      const Byte* match = src + table[h];
+      table[h] = (std::uint32_t) (ip - src);
+      if (match >= ip || (std::size_t) (ip - match) > kMaxOffset ||
+          read32(match) != sequence) {
+        // Step further the longer nothing matches, so incompressible input
+        // is skipped quickly.
+        ip += 1 + (misses++ >> 6);
+        continue;
+      }
+      misses = 0;
+      while (ip > anchor && match > src && ip[-1] == match[-1]) {
+        --ip;
+        --match;
+      }
+      const Byte* end = ip + kMinMatch;
+      const Byte* ref = match + kMinMatch;
+      // Compare a word at a time; the first differing byte is the lowest set
+      // byte of the difference on a little-endian machine.
+      bool differs = false;
+      while (!differs && end + 8 <= matchEnd) {
+        const std::uint64_t diff = read64(end) ^ read64(ref);
+        if (diff != 0) {
+          end += __builtin_ctzll(diff) >> 3;
+          differs = true;
+        } else {
+          end += 8;
+          ref += 8;
+        }
+      }
+      if (!differs) {
+        while (end < matchEnd && *end == *ref) {
+          ++end;
+          ++ref;
+        }
+      }
+      op = writeSequence(op, outEnd, anchor, ip - anchor, ip - match,
+                         end - ip);
+      if (op == NULL) {
+        return 0;
+      }
+      ip = end;
+      anchor = ip;
+      if (ip - 2 >= src) {
+        table[hashOf(read32(ip - 2))] = (std::uint32_t) (ip - 2 - src);
+      }
+    }
+  }
+  op = writeSequence(op, outEnd, anchor, inEnd - anchor, 0, 0);
+  if (op == NULL) {
+    return 0;
+  }
+  return op - dst;
+}
+
+std::size_t lz4Decompress(const char* source, const std::size_t length,
+                          char* dest, const std::size_t capacity) {
+  return decode(source, length, dest, capacity, false);
+}
+
+std::size_t lz4DecompressPrefix(const char* source, const std::size_t length,
+                                char* dest, const std::size_t prefix) {
+  return decode(source, length, dest, prefix, true);
+}
+
+}
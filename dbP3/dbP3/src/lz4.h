@@ -0,0 +1,66 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace badgerdb {
+
+/**
+ * Returns the largest size lz4Compress() can produce for <length> bytes of
+ * input, for sizing its output buffer.
+ *
+ * @param length  Length of the input in bytes.
+ */
+inline std::size_t lz4CompressBound(const std::size_t length) {
+  return length + length / 255 + 16;
+}
+
+/**
+ * Compresses a buffer into the LZ4 block format (the format of the reference
+ * LZ4_compress_default(), without a frame around it), using a single pass
+ * with a 4 KB hash table; fast rather than thorough.
+ *
+ * @param source    Input.
+ * @param length    Length of the input in bytes.
+ * @param dest      Output buffer.
+ * @param capacity  Length of the output buffer in bytes.
+ * @return  Length of the compressed block, or 0 if it does not fit in
+ *          <capacity> bytes.
+ */
+std::size_t lz4Compress(const char* source, const std::size_t length,
+                        char* dest, const std::size_t capacity);
+
+/**
+ * Decompresses an LZ4 block.  Malformed input is detected rather than trusted:
+ * nothing is read or written outside the two buffers.
+ *
+ * @param source    Compressed block.
+ * @param length    Length of the block in bytes.
+ * @param dest      Output buffer.
+ * @param capacity  Length of the output buffer in bytes.
+ * @return  Length of the decompressed data, or 0 if the block is malformed or
+ *          does not fit in <capacity> bytes.
+ */
+std::size_t lz4Decompress(const char* source, const std::size_t length,
+                          char* dest, const std::size_t capacity);
+
+/**
+ * Decompresses only the first <prefix> bytes of an LZ4 block, which needs
+ * just as much of the block as encodes them.
+ *
+ * @param source    Compressed block, or a leading part of it.
+ * @param length    Length of the block (or part) in bytes.
+ * @param dest      Output buffer of <prefix> bytes.
+ * @param prefix    Number of bytes wanted.
+ * @return  <prefix>, or less if the block is malformed or shorter.
+ */
+std::size_t lz4DecompressPrefix(const char* source, const std::size_t length,
+                                char* dest, const std::size_t prefix);
+
+}
@@ -2,16 +2,39 @@
 #include <stdlib.h>
 //#include <stdio.h>
 #include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include "page.h"
 #include "buffer.h"
+#include "btree.h"
+#include "buffer_pools.h"
+#include "checkpointer.h"
+#include "compressed_tier.h"
+#include "crc32c.h"
+#include "log_manager.h"
+#include "lz4.h"
 #include "file_iterator.h"
+#include "file_tier.h"
+#include "hash_index.h"
+#include "heap_file.h"
 #include "page_iterator.h"
+#include "parallel_scan.h"
+#include "exceptions/checksum_mismatch_exception.h"
 #include "exceptions/file_not_found_exception.h"
+#include "exceptions/index_exception.h"
 #include "exceptions/invalid_page_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
 #include "exceptions/page_pinned_exception.h"
 #include "exceptions/buffer_exceeded_exception.h"
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_pool_exception.h"
+#include "exceptions/invalid_record_exception.h"
 
 #define PRINT_ERROR(str) \
 { \
@@ -37,6 +60,33 @@ void test4();
 void test5();
 void test6();
 void test7();
+void test8();
+void test9();
+void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
+void test18();
+void test19();
+void test20();
+void test21();
+void test22();
+void test23();
+void test24();
+void test25();
+void test26();
+void test27();
+void test28();
+void test29();
+void test30();
+void test31();
+void test32();
+void test33();
+void test34();
 void testBufMgr();
 
 int main() 
@@ -75,12 +125,14 @@ int main()
     for (FileIterator iter = new_file.begin();
          iter != new_file.end();
          ++iter) {
-      // Iterate through all records on the page.
-      for (PageIterator page_iter = (*iter).begin();
-           page_iter != (*iter).end();
+      // Iterate through all records on the page.  The iterator refers to the
+      // page it walks, so keep a copy alive for the duration of the loop.
+      Page current_page = *iter;
+      for (PageIterator page_iter = current_page.begin();
+           page_iter != current_page.end();
            ++page_iter) {
         std::cout << "Found record: " << *page_iter
-            << " on page " << (*iter).page_number() << "\n";
+            << " on page " << current_page.page_number() << "\n";
       }
     }
 
@@ -147,6 +199,37 @@ void testBufMgr()
 	test5();
 	test6();
     test7();
+	test8();
+	test9();
+	test10();
+	test11();
+	test12();
+	test13();
+	test14();
+	test15();
+	test16();
+	test17();
+	test18();
+	test19();
+	test20();
+	test21();
+	test22();
+	test23();
+	test24();
+	test25();
+	test26();
+	test27();
+	test28();
+	test29();
+	test30();
+	test31();
+	test32();
+	test33();
+	test34();
+
+	//Write back what is still buffered while the files are open
+	delete bufMgr;
+
 	//Close files before deleting them
 	file1.~File();
 	file2.~File();
@@ -161,8 +244,6 @@ void testBufMgr()
 	File::remove(filename4);
 	File::remove(filename5);
 
-	delete bufMgr;
-
 	std::cout << "\n" << "Passed all tests." << "\n";
 }
 
@@ -326,3 +407,2265 @@ void test7()
     std::cout << "Test 7 passed" << "\n";
 
 }
+
+void test8()
+{
+	//A pool backed by huge pages must behave exactly like a regular one
+	BufMgrOptions options;
+	options.hugePages = true;
+	BufMgr* hugeMgr = new BufMgr(num, options);
+
+	for (i = 1; i <= num; i++)
+	{
+		const RecordId firstRecord = {i, 1};
+		hugeMgr->readPage(file1ptr, i, page);
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", i, (float)i);
+		if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		hugeMgr->unPinPage(file1ptr, i, false);
+	}
+	hugeMgr->flushFile(file1ptr);
+	delete hugeMgr;
+
+	std::cout << "Test 8 passed" << "\n";
+}
+
+void test9()
+{
+	//Threads sharing a small NUMA-aware pool must all see the right page contents
+	BufMgrOptions options;
+	options.numaAware = true;
+	options.numaPlacement = PLACE_BY_HASH;
+	BufMgr* numaMgr = new BufMgr(num / 5, options);
+	std::atomic<bool> failed(false);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.push_back(std::thread([numaMgr, t, &failed]() {
+			char expected[100];
+			Page* threadPage;
+			for (PageId p = 1; p <= num; p++)
+			{
+				const PageId pageNo = 1 + (p + t * 25) % num;
+				const RecordId firstRecord = {pageNo, 1};
+				numaMgr->readPage(file1ptr, pageNo, threadPage);
+				sprintf(expected, "test.1 Page %d %7.1f", pageNo, (float)pageNo);
+				if(strncmp(threadPage->getRecord(firstRecord).c_str(), expected, strlen(expected)) != 0)
+				{
+					failed = true;
+				}
+				numaMgr->unPinPage(file1ptr, pageNo, false);
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	if (failed)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	delete numaMgr;
+
+	std::cout << "Test 9 passed" << "\n";
+}
+
+void test10()
+{
+	//With all but one frame pinned the clock has to find that frame every time
+	const std::uint32_t frames = 13;
+	BufMgr* smallMgr = new BufMgr(frames);
+	Page* pinned[frames - 1];
+	for (i = 1; i < frames; i++)
+		smallMgr->readPage(file1ptr, i, pinned[i - 1]);
+
+	for (PageId p = frames; p <= num; p++)
+	{
+		const RecordId firstRecord = {p, 1};
+		smallMgr->readPage(file1ptr, p, page);
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", p, (float)p);
+		if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		smallMgr->unPinPage(file1ptr, p, false);
+	}
+	for (i = 1; i < frames; i++)
+	{
+		if (pinned[i - 1]->page_number() != i)
+		{
+			PRINT_ERROR("ERROR :: Pinned page was evicted.");
+		}
+		smallMgr->unPinPage(file1ptr, i, false);
+	}
+	delete smallMgr;
+
+	std::cout << "Test 10 passed" << "\n";
+}
+
+void test11()
+{
+	//A batch mixing buffered pages, runs of missing pages and a repeated page
+	BufMgr* batchMgr = new BufMgr(num / 2);
+	for (i = 1; i <= 10; i++)
+	{
+		batchMgr->readPage(file1ptr, i, page);
+		batchMgr->unPinPage(file1ptr, i, false);
+	}
+
+	std::vector<PageId> pageNos;
+	for (i = 5; i <= 30; i++)
+		pageNos.push_back(i);
+	pageNos.push_back(50);
+	pageNos.push_back(20);
+	std::vector<Page*> pages;
+	batchMgr->readPages(file1ptr, pageNos, pages);
+	for (std::size_t p = 0; p < pageNos.size(); p++)
+	{
+		const RecordId firstRecord = {pageNos[p], 1};
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", pageNos[p], (float)pageNos[p]);
+		if(strncmp(pages[p]->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	batchMgr->unPinPages(file1ptr, pageNos, false);
+	try
+	{
+		batchMgr->unPinPage(file1ptr, 5, false);
+		PRINT_ERROR("ERROR :: Page is already unpinned. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(PageNotPinnedException e)
+	{
+	}
+
+	//a batch that cannot fit must leave nothing pinned behind
+	pageNos.clear();
+	for (i = 1; i <= num; i++)
+		pageNos.push_back(i);
+	try
+	{
+		batchMgr->readPages(file1ptr, pageNos, pages);
+		PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(BufferExceededException e)
+	{
+	}
+	pageNos.resize(num / 2);
+	batchMgr->readPages(file1ptr, pageNos, pages);
+	batchMgr->unPinPages(file1ptr, pageNos, false);
+	delete batchMgr;
+
+	std::cout << "Test 11 passed" << "\n";
+}
+
+void test12()
+{
+	BufMgr* optMgr = new BufMgr(num / 10);
+	PageVersion read;
+	const RecordId firstRecord = {1, 1};
+	sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", 1, 1.0);
+
+	//not buffered yet: no optimistic read possible
+	if (optMgr->tryReadOptimistic(file1ptr, 1, read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read of a page that is not buffered.");
+	}
+	optMgr->readPage(file1ptr, 1, page);
+	//pinned: a pinner may be modifying it
+	if (optMgr->tryReadOptimistic(file1ptr, 1, read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read of a pinned page.");
+	}
+	optMgr->unPinPage(file1ptr, 1, false);
+
+	if (!optMgr->tryReadOptimistic(file1ptr, 1, read) ||
+		strncmp(read.page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0 ||
+		!optMgr->validate(read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read of a buffered page failed.");
+	}
+
+	//a pin taken after the read started invalidates it
+	optMgr->readPage(file1ptr, 1, page);
+	optMgr->unPinPage(file1ptr, 1, false);
+	if (optMgr->validate(read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read survived a concurrent pin.");
+	}
+
+	//so does evicting the page
+	if (!optMgr->tryReadOptimistic(file1ptr, 1, read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read of a buffered page failed.");
+	}
+	for (i = 2; i <= num; i++)
+	{
+		optMgr->readPage(file1ptr, i, page);
+		optMgr->unPinPage(file1ptr, i, false);
+	}
+	if (optMgr->validate(read))
+	{
+		PRINT_ERROR("ERROR :: Optimistic read survived eviction.");
+	}
+
+	//the helper falls back to a pinned read for pages that are not buffered
+	std::string record;
+	optMgr->readOptimistic(file1ptr, 1, [&record, &firstRecord](const Page& p) {
+		record = p.getRecord(firstRecord);
+	});
+	if (strncmp(record.c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	delete optMgr;
+
+	std::cout << "Test 12 passed" << "\n";
+}
+
+void test13()
+{
+	//Page references remember their frame and must notice when the page leaves it
+	const std::uint32_t frames = num / 10;
+	BufMgr* refMgr = new BufMgr(frames);
+	std::vector<PageRef> refs;
+	for (i = 1; i <= frames; i++)
+		refs.push_back(PageRef(file1ptr, i));
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (std::size_t r = 0; r < refs.size(); r++)
+		{
+			const RecordId firstRecord = {refs[r].getPageNo(), 1};
+			refMgr->readPage(refs[r], page);
+			sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", refs[r].getPageNo(), (float)refs[r].getPageNo());
+			if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			if (!refs[r].isSwizzled())
+			{
+				PRINT_ERROR("ERROR :: Page reference was not swizzled.");
+			}
+			refMgr->unPinPage(refs[r], false);
+		}
+	}
+	try
+	{
+		refMgr->unPinPage(refs[0], false);
+		PRINT_ERROR("ERROR :: Page is already unpinned. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(PageNotPinnedException e)
+	{
+	}
+
+	//push every referenced page out; the references must find their pages again
+	for (i = frames + 1; i <= num; i++)
+	{
+		refMgr->readPage(file1ptr, i, page);
+		refMgr->unPinPage(file1ptr, i, false);
+	}
+	for (std::size_t r = 0; r < refs.size(); r++)
+	{
+		const RecordId firstRecord = {refs[r].getPageNo(), 1};
+		std::string record;
+		refMgr->readOptimistic(refs[r], [&record, &firstRecord](const Page& p) {
+			record = p.getRecord(firstRecord);
+		});
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", refs[r].getPageNo(), (float)refs[r].getPageNo());
+		if (strncmp(record.c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+	delete refMgr;
+
+	std::cout << "Test 13 passed" << "\n";
+}
+
+void test14()
+{
+	//Guards must give their pins back even when the caller bails out with an exception
+	BufMgr* guardMgr = new BufMgr(2);
+	try
+	{
+		WritePageGuard written = guardMgr->writePageGuard(file1ptr, 1);
+		ReadPageGuard read = guardMgr->readPageGuard(file1ptr, 2);
+		written->insertRecord(std::string(Page::DATA_SIZE, 'x'));
+		PRINT_ERROR("ERROR :: Record larger than the page was inserted. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(InsufficientSpaceException e)
+	{
+	}
+
+	//both frames are free again, and moving a guard hands over its pin exactly once
+	for (i = 3; i <= num; i++)
+	{
+		const RecordId firstRecord = {i, 1};
+		ReadPageGuard read = guardMgr->readPageGuard(file1ptr, i);
+		ReadPageGuard moved(std::move(read));
+		if (read.isValid() || !moved.isValid())
+		{
+			PRINT_ERROR("ERROR :: Moved guard still owns its pin.");
+		}
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", i, (float)i);
+		if(strncmp(moved->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+	}
+
+	//a write guard leaves its page dirty, so the change reaches the file
+	PageId newPageNo;
+	RecordId newRecord;
+	{
+		WritePageGuard allocated = guardMgr->allocPageGuard(file1ptr, newPageNo);
+		newRecord = allocated->insertRecord("test.1 guarded page");
+	}
+	guardMgr->flushFile(file1ptr);
+	if (file1ptr->readPage(newPageNo).getRecord(newRecord) != "test.1 guarded page")
+	{
+		PRINT_ERROR("ERROR :: Page written through a guard was not flushed.");
+	}
+	guardMgr->disposePage(file1ptr, newPageNo);
+	delete guardMgr;
+
+	std::cout << "Test 14 passed" << "\n";
+}
+
+void test15()
+{
+	//Diagnostics must name the holders of the pins that exhaust the pool
+	const std::uint32_t frames = 4;
+	BufMgr* diagMgr = new BufMgr(frames);
+	diagMgr->setPinDiagnostics(true);
+	BufMgr::setPinSite("test15");
+	for (i = 1; i < frames; i++)
+		diagMgr->readPage(file1ptr, i, page);
+	for (i = frames; i <= 2 * frames; i++)
+	{
+		diagMgr->readPage(file1ptr, i, page);
+		diagMgr->unPinPage(file1ptr, i, false);
+	}
+	if (diagMgr->getPinStats().pinnedSkips == 0)
+	{
+		PRINT_ERROR("ERROR :: Sweeps passing pinned frames were not counted.");
+	}
+
+	diagMgr->readPage(file1ptr, frames, page);
+	try
+	{
+		diagMgr->readPage(file1ptr, frames + 1, page);
+		PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(BufferExceededException e)
+	{
+	}
+	std::ostringstream report;
+	if (diagMgr->getPinStats().exceeded != 1 ||
+		diagMgr->dumpPinned(report) != frames ||
+		report.str().find("site:test15") == std::string::npos)
+	{
+		PRINT_ERROR("ERROR :: Pinned frames were not reported.");
+	}
+	if (diagMgr->dumpPinned(report, 3600) != 0)
+	{
+		PRINT_ERROR("ERROR :: Recent pins were reported as long-held.");
+	}
+	BufMgr::setPinSite(NULL);
+	for (i = 1; i <= frames; i++)
+		diagMgr->unPinPage(file1ptr, i, false);
+	delete diagMgr;
+
+	std::cout << "Test 15 passed" << "\n";
+}
+
+void test16()
+{
+	//Page faults on a fully pinned pool must wait for an unpin instead of failing
+	BufMgrOptions options;
+	options.evictionWaitMillis = 5000;
+	BufMgr* waitMgr = new BufMgr(2, options);
+	waitMgr->readPage(file1ptr, 1, page);
+	waitMgr->readPage(file1ptr, 2, page2);
+
+	//two threads want the same page; the second must find it loaded by the first
+	std::atomic<int> loaded(0);
+	std::atomic<bool> release(false), failed(false);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 2; t++)
+	{
+		threads.push_back(std::thread([waitMgr, &loaded, &release, &failed]() {
+			const RecordId firstRecord = {3, 1};
+			char expected[100];
+			Page* threadPage;
+			waitMgr->readPage(file1ptr, 3, threadPage);
+			sprintf(expected, "test.1 Page %d %7.1f", 3, 3.0);
+			if(strncmp(threadPage->getRecord(firstRecord).c_str(), expected, strlen(expected)) != 0)
+			{
+				failed = true;
+			}
+			loaded++;
+			while (!release)
+				std::this_thread::yield();
+			waitMgr->unPinPage(file1ptr, 3, false);
+		}));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	waitMgr->unPinPage(file1ptr, 1, false);
+	while (loaded < 1)
+		std::this_thread::yield();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	waitMgr->unPinPage(file1ptr, 2, false);
+	while (loaded < 2)
+		std::this_thread::yield();
+	release = true;
+	for (std::size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	if (failed)
+	{
+		PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+	}
+	if (waitMgr->getWaitStats().waits < 2 || waitMgr->getWaitStats().timeouts != 0)
+	{
+		PRINT_ERROR("ERROR :: Waits for a frame were not counted.");
+	}
+	delete waitMgr;
+
+	//a wait that runs out still ends in BufferExceededException
+	options.evictionWaitMillis = 20;
+	waitMgr = new BufMgr(2, options);
+	waitMgr->readPage(file1ptr, 1, page);
+	waitMgr->readPage(file1ptr, 2, page2);
+	try
+	{
+		waitMgr->readPage(file1ptr, 3, page3);
+		PRINT_ERROR("ERROR :: No more frames left for allocation. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(BufferExceededException e)
+	{
+	}
+	if (waitMgr->getWaitStats().timeouts != 1 || waitMgr->getWaitStats().maxWaitMicros < 20000)
+	{
+		PRINT_ERROR("ERROR :: Timed out wait was not counted.");
+	}
+	waitMgr->unPinPage(file1ptr, 1, false);
+	waitMgr->unPinPage(file1ptr, 2, false);
+	delete waitMgr;
+
+	std::cout << "Test 16 passed" << "\n";
+}
+
+void test17()
+{
+	//A scan of one file confined to the recycle pool must not push the other file out of the keep pool
+	BufPoolMgr* poolMgr = new BufPoolMgr(num / 10);
+	const PoolId keep = poolMgr->addKeepPool(num / 4);
+	const PoolId recycle = poolMgr->addRecyclePool(num / 20);
+	poolMgr->assign(file2ptr, keep);
+	poolMgr->assign(file1ptr, recycle);
+	if (poolMgr->findPool("recycle") != recycle || poolMgr->poolOf(file3ptr) != BufPoolMgr::DEFAULT_POOL)
+	{
+		PRINT_ERROR("ERROR :: Files were routed to the wrong pool.");
+	}
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (i = 1; i <= num / 4; i++)
+		{
+			poolMgr->readPage(file2ptr, i, page);
+			poolMgr->unPinPage(file2ptr, i, false);
+		}
+		for (i = 1; i <= num; i++)
+		{
+			const RecordId firstRecord = {i, 1};
+			poolMgr->readPage(file1ptr, i, page);
+			sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", i, (float)i);
+			if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			poolMgr->unPinPage(file1ptr, i, false);
+		}
+	}
+	const PoolStats keepStats = poolMgr->getPoolStats(keep);
+	const PoolStats recycleStats = poolMgr->getPoolStats(recycle);
+	if (keepStats.bufStats.diskreads != (int) (num / 4) || keepStats.files != 1 ||
+		recycleStats.bufStats.diskreads != (int) (2 * num) || recycleStats.replacement != REPLACE_FIFO ||
+		poolMgr->getPoolStats(BufPoolMgr::DEFAULT_POOL).bufStats.accesses != 0)
+	{
+		PRINT_ERROR("ERROR :: Pool statistics are wrong.");
+	}
+
+	//moving a file drops its pages from the old pool
+	poolMgr->assign(file2ptr, BufPoolMgr::DEFAULT_POOL);
+	poolMgr->readPage(file2ptr, 1, page);
+	poolMgr->unPinPage(file2ptr, 1, false);
+	if (poolMgr->getPoolStats(BufPoolMgr::DEFAULT_POOL).bufStats.diskreads != 1)
+	{
+		PRINT_ERROR("ERROR :: Reassigned file was not read into its new pool.");
+	}
+	try
+	{
+		poolMgr->assign(file3ptr, 7);
+		PRINT_ERROR("ERROR :: Pool does not exist. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(InvalidPoolException e)
+	{
+	}
+	delete poolMgr;
+
+	std::cout << "Test 17 passed" << "\n";
+}
+
+void test18()
+{
+	//Growing keeps buffered pages where they are, shrinking evicts only the frames removed
+	BufMgrOptions options;
+	options.maxFrames = num / 2;
+	BufMgr* resizeMgr = new BufMgr(num / 10, options);
+	Page* held;
+	resizeMgr->readPage(file1ptr, 1, held);
+	for (i = 2; i <= num / 10; i++)
+	{
+		resizeMgr->readPage(file1ptr, i, page);
+		resizeMgr->unPinPage(file1ptr, i, false);
+	}
+	resizeMgr->resize(num / 2);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (i = 2; i <= num / 2; i++)
+		{
+			const RecordId firstRecord = {i, 1};
+			resizeMgr->readPage(file1ptr, i, page);
+			sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", i, (float)i);
+			if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+			{
+				PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+			}
+			resizeMgr->unPinPage(file1ptr, i, false);
+		}
+	}
+	if (resizeMgr->getBufStats().diskreads != (int) (num / 2))
+	{
+		PRINT_ERROR("ERROR :: Grown pool did not keep its pages.");
+	}
+
+	//pin a page in the upper half, which must block shrinking
+	Page* upper;
+	resizeMgr->readPage(file1ptr, num / 2, upper);
+	const std::string modified = "test.1 resized page";
+	const RecordId modifiedRecord = upper->insertRecord(modified);
+	try
+	{
+		resizeMgr->resize(num / 20);
+		PRINT_ERROR("ERROR :: Frame being removed is pinned. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(PagePinnedException e)
+	{
+	}
+	resizeMgr->unPinPage(file1ptr, num / 2, true);
+	resizeMgr->resize(num / 20);
+	if (file1ptr->readPage(num / 2).getRecord(modifiedRecord) != modified)
+	{
+		PRINT_ERROR("ERROR :: Dirty page was not written back when its frame was removed.");
+	}
+	const RecordId firstRecord = {1, 1};
+	sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", 1, 1.0);
+	if(strncmp(held->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+	{
+		PRINT_ERROR("ERROR :: Pinned page moved during resize.");
+	}
+	resizeMgr->unPinPage(file1ptr, 1, false);
+	for (i = 1; i <= num; i++)
+	{
+		resizeMgr->readPage(file1ptr, i, page);
+		resizeMgr->unPinPage(file1ptr, i, false);
+	}
+	try
+	{
+		resizeMgr->resize(num / 2 + 1);
+		PRINT_ERROR("ERROR :: Pool cannot grow past its maximum. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(BufferExceededException e)
+	{
+	}
+	delete resizeMgr;
+
+	std::cout << "Test 18 passed" << "\n";
+}
+
+void test19()
+{
+	//A pool warmed up from a dumped resident set must serve that set without reading the files
+	BufMgr* coldMgr = new BufMgr(num / 4);
+	for (i = num / 2; i < num / 2 + num / 4; i++)
+	{
+		coldMgr->readPage(file1ptr, i, page);
+		coldMgr->unPinPage(file1ptr, i, false);
+	}
+	for (i = 1; i <= num / 10; i++)
+	{
+		coldMgr->readPage(file2ptr, i, page);
+		coldMgr->unPinPage(file2ptr, i, false);
+	}
+	if (coldMgr->dumpResidentSet("test.resident") != num / 4)
+	{
+		PRINT_ERROR("ERROR :: Resident set was not dumped.");
+	}
+	delete coldMgr;
+
+	//file2 is not offered to the new pool, so only file1's pages come back
+	BufMgr* warmMgr = new BufMgr(num / 4);
+	std::vector<File*> files;
+	files.push_back(file1ptr);
+	const std::uint32_t expected = num / 4 - num / 10;
+	if (warmMgr->warmUp("test.resident", files, 8) != expected ||
+		warmMgr->warmUp("test.resident", files) != 0)
+	{
+		PRINT_ERROR("ERROR :: Resident set was not loaded.");
+	}
+	warmMgr->clearBufStats();
+	for (i = num / 2 + num / 10; i < num / 2 + num / 4; i++)
+	{
+		const RecordId firstRecord = {i, 1};
+		warmMgr->readPage(file1ptr, i, page);
+		sprintf((char*)tmpbuf, "test.1 Page %d %7.1f", i, (float)i);
+		if(strncmp(page->getRecord(firstRecord).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+		{
+			PRINT_ERROR("ERROR :: CONTENTS DID NOT MATCH");
+		}
+		warmMgr->unPinPage(file1ptr, i, false);
+	}
+	if (warmMgr->getBufStats().diskreads != 0)
+	{
+		PRINT_ERROR("ERROR :: Warmed up pages were read again.");
+	}
+	if (warmMgr->warmUp("test.missing", files) != 0)
+	{
+		PRINT_ERROR("ERROR :: Missing resident set loaded pages.");
+	}
+	delete warmMgr;
+	std::remove("test.resident");
+
+	std::cout << "Test 19 passed" << "\n";
+}
+
+void test20()
+{
+	//Per-file bookkeeping must follow pages in and out of the pool, whichever File object is used
+	BufMgr* fileMgr = new BufMgr(num);
+	for (i = 1; i <= num / 4; i++)
+	{
+		fileMgr->readPage(file1ptr, i, page);
+		fileMgr->unPinPage(file1ptr, i, i % 2 == 0);
+		fileMgr->readPage(file2ptr, i, page);
+		fileMgr->unPinPage(file2ptr, i, false);
+	}
+	fileMgr->readPage(file2ptr, 1, page);
+	FileStats stats = fileMgr->getFileStats(file1ptr);
+	if (stats.residentPages != num / 4 || stats.dirtyPages != num / 8 || stats.pinnedPages != 0 ||
+		fileMgr->getFileStats(file2ptr).pinnedPages != 1)
+	{
+		PRINT_ERROR("ERROR :: File statistics are wrong.");
+	}
+	try
+	{
+		fileMgr->dropFile(file2ptr);
+		PRINT_ERROR("ERROR :: Pages pinned for file being dropped. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(PagePinnedException e)
+	{
+	}
+	fileMgr->unPinPage(file2ptr, 1, false);
+	fileMgr->dropFile(file2ptr);
+
+	//another File object for the same file reaches the same pages
+	File file1copy = File::open(file1ptr->filename());
+	fileMgr->flushFile(&file1copy);
+	if (fileMgr->getFileStats(file1ptr).residentPages != 0 || fileMgr->getFileStats(file2ptr).residentPages != 0)
+	{
+		PRINT_ERROR("ERROR :: Pages were left behind by flushFile or dropFile.");
+	}
+	fileMgr->readPage(file1ptr, 1, page);
+	fileMgr->unPinPage(file1ptr, 1, false);
+	if (fileMgr->getFileStats(file1ptr).residentPages != 1)
+	{
+		PRINT_ERROR("ERROR :: File statistics are wrong.");
+	}
+	delete fileMgr;
+
+	std::cout << "Test 20 passed" << "\n";
+}
+
+void test21()
+{
+	//Pages are cached per file, not per File object: every copy must share the same frames
+	BufMgr* idMgr = new BufMgr(num / 10);
+	File file1copy = File::open(file1ptr->filename());
+	if (file1copy.id() != file1ptr->id() || file1copy.id() == file2ptr->id())
+	{
+		PRINT_ERROR("ERROR :: File ids are not shared by copies or not distinct between files.");
+	}
+	idMgr->readPage(file1ptr, 1, page);
+	idMgr->readPage(&file1copy, 1, page2);
+	if (page != page2 || idMgr->getBufStats().diskreads != 1)
+	{
+		PRINT_ERROR("ERROR :: File copies did not share the buffered page.");
+	}
+	idMgr->unPinPage(&file1copy, 1, false);
+	idMgr->unPinPage(file1ptr, 1, false);
+	try
+	{
+		idMgr->unPinPage(&file1copy, 1, false);
+		PRINT_ERROR("ERROR :: Page is already unpinned. Exception should have been thrown before execution reaches this point.");
+	}
+	catch(PageNotPinnedException e)
+	{
+	}
+
+	//same page number in different files must not collide
+	idMgr->readPage(file2ptr, 1, page2);
+	if (page == page2 || page2->page_number() != 1)
+	{
+		PRINT_ERROR("ERROR :: Pages of different files share a frame.");
+	}
+	idMgr->unPinPage(file2ptr, 1, false);
+	idMgr->flushFile(file1ptr);
+	delete idMgr;
+
+	std::cout << "Test 21 passed" << "\n";
+}
+
+void test22()
+{
+	//Asynchronous flush: pinned pages are retried, the rest is written without blocking the caller
+	BufMgr* asyncMgr = new BufMgr(num);
+	for (i = 1; i <= 20; i++)
+	{
+		asyncMgr->readPage(file1ptr, i, page);
+		sprintf((char*)tmpbuf, "async test.1 Page %d %7.1f", i, (float)i);
+		page->insertRecord(tmpbuf);
+		asyncMgr->unPinPage(file1ptr, i, true);
+	}
+	asyncMgr->readPage(file1ptr, 5, page);
+	FlushHandle flush = asyncMgr->flushFileAsync(file1ptr, 8, 8);
+	if (flush.bytesTotal() != 20 * Page::SIZE)
+	{
+		PRINT_ERROR("ERROR :: Async flush did not snapshot every dirty page.");
+	}
+	//page 5 is pinned until the first round is over
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	asyncMgr->unPinPage(file1ptr, 5, false);
+	flush.wait();
+	if (!flush.done() || flush.bytesWritten() != 20 * Page::SIZE || flush.pagesSkipped() != 0)
+	{
+		PRINT_ERROR("ERROR :: Async flush did not write every page.");
+	}
+	if (asyncMgr->getFileStats(file1ptr).dirtyPages != 0 || asyncMgr->getFileStats(file1ptr).residentPages != 20)
+	{
+		PRINT_ERROR("ERROR :: Async flush should leave the pages buffered and clean.");
+	}
+	for (i = 1; i <= 20; i++)
+	{
+		sprintf((char*)tmpbuf, "async test.1 Page %d %7.1f", i, (float)i);
+		Page onDisk = file1ptr->readPage(i);
+		bool found = false;
+		for (PageIterator it = onDisk.begin(); it != onDisk.end(); ++it)
+		{
+			if (strncmp((*it).c_str(), tmpbuf, strlen(tmpbuf)) == 0)
+				found = true;
+		}
+		if (!found)
+		{
+			PRINT_ERROR("ERROR :: Async flush did not write the page contents to the file.");
+		}
+	}
+
+	//a page that stays pinned is skipped, not waited for
+	asyncMgr->readPage(file1ptr, 3, page);
+	asyncMgr->unPinPage(file1ptr, 3, true);
+	asyncMgr->readPage(file1ptr, 3, page);
+	asyncMgr->readPage(file1ptr, 4, page);
+	asyncMgr->unPinPage(file1ptr, 4, true);
+	flush = asyncMgr->flushFileAsync(file1ptr, 64, 2);
+	flush.wait();
+	if (flush.pagesSkipped() != 1 || flush.bytesWritten() != Page::SIZE || asyncMgr->getFileStats(file1ptr).dirtyPages != 1)
+	{
+		PRINT_ERROR("ERROR :: Async flush should skip the page that stays pinned.");
+	}
+	asyncMgr->unPinPage(file1ptr, 3, false);
+
+	//a cancelled flush still finishes, leaving the unwritten pages dirty
+	flush = asyncMgr->flushFileAsync(file1ptr);
+	flush.cancel();
+	if (!flush.waitFor(std::chrono::milliseconds(1000)))
+	{
+		PRINT_ERROR("ERROR :: Cancelled async flush did not finish.");
+	}
+	asyncMgr->flushFile(file1ptr);
+	delete asyncMgr;
+
+	std::cout << "Test 22 passed" << "\n";
+}
+
+void test23()
+{
+	//Write-ahead log: committed changes survive losing the dirty pages, uncommitted ones do not
+	const std::string walFilename = "test.wal";
+	const std::string logFilename = "test.wal.log";
+	try
+	{
+		File::remove(walFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	std::remove(logFilename.c_str());
+	{
+		File walFile = File::create(walFilename);
+		for (i = 1; i <= 4; i++)
+		{
+			Page newPage = walFile.allocatePage();
+			walFile.writePage(newPage);
+		}
+
+		{
+			LogManager log(logFilename);
+			BufMgrOptions options;
+			options.log = &log;
+			BufMgr* walMgr = new BufMgr(num / 10, options);
+			for (i = 1; i <= 4; i++)
+			{
+				walMgr->readPage(&walFile, i, page);
+				const Page before = *page;
+				sprintf((char*)tmpbuf, "wal test Page %d %7.1f", i, (float)i);
+				page->insertRecord(tmpbuf);
+				log.logPageDiff(walFile, before, *page);
+				walMgr->unPinPage(&walFile, i, true);
+			}
+			const Lsn committed = log.commit();
+			if (log.flushedLsn() <= committed || log.stats().commits != 1 || log.stats().flushes != 1)
+			{
+				PRINT_ERROR("ERROR :: Commit did not make the log durable with one flush.");
+			}
+			//logged after the commit: must not be redone
+			walMgr->readPage(&walFile, 1, page);
+			const Page before = *page;
+			page->insertRecord("wal test uncommitted");
+			const Lsn uncommitted = log.logPageDiff(walFile, before, *page);
+			walMgr->unPinPage(&walFile, 1, true);
+			if (uncommitted <= committed || page->lsn() != uncommitted)
+			{
+				PRINT_ERROR("ERROR :: Page was not stamped with the LSN of its change.");
+			}
+			//crash: the dirty pages are lost
+			walMgr->dropFile(&walFile);
+			delete walMgr;
+		}
+		for (i = 1; i <= 4; i++)
+		{
+			Page onDisk = walFile.readPage(i);
+			if (onDisk.begin() != onDisk.end())
+			{
+				PRINT_ERROR("ERROR :: Dropped pages reached the file.");
+			}
+		}
+
+		{
+			LogManager log(logFilename);
+			std::vector<File*> files(1, &walFile);
+			RedoStats redo = log.recover(files);
+			if (redo.recordsApplied == 0 || redo.recordsUncommitted == 0 || redo.pagesWritten != 4)
+			{
+				PRINT_ERROR("ERROR :: Recovery did not redo the committed changes only.");
+			}
+			for (i = 1; i <= 4; i++)
+			{
+				sprintf((char*)tmpbuf, "wal test Page %d %7.1f", i, (float)i);
+				Page onDisk = walFile.readPage(i);
+				int records = 0;
+				for (PageIterator it = onDisk.begin(); it != onDisk.end(); ++it)
+				{
+					if (strncmp((*it).c_str(), tmpbuf, strlen(tmpbuf)) != 0)
+					{
+						PRINT_ERROR("ERROR :: Recovery wrote a record that was not committed.");
+					}
+					records++;
+				}
+				if (records != 1 || onDisk.lsn() == 0)
+				{
+					PRINT_ERROR("ERROR :: Recovery did not restore the committed record.");
+				}
+			}
+			//redo is idempotent
+			redo = log.recover(files);
+			if (redo.recordsApplied != 0 || redo.pagesWritten != 0)
+			{
+				PRINT_ERROR("ERROR :: Second recovery applied changes again.");
+			}
+		}
+
+		//a torn record at the end of the log is cut off when it is opened
+		Lsn end;
+		{
+			LogManager log(logFilename);
+			end = log.endLsn();
+		}
+		{
+			std::ofstream torn(logFilename.c_str(), std::ios::app | std::ios::binary);
+			torn << "torn record";
+		}
+		{
+			LogOptions logOptions;
+			logOptions.sync = false;
+			LogManager log(logFilename, logOptions);
+			if (log.endLsn() != end)
+			{
+				PRINT_ERROR("ERROR :: Torn log record was not cut off.");
+			}
+
+			//a dirty page is not written back before the log holds its change
+			BufMgrOptions options;
+			options.log = &log;
+			BufMgr* walMgr = new BufMgr(1, options);
+			walMgr->readPage(&walFile, 2, page);
+			const Page before = *page;
+			page->insertRecord("wal test evicted");
+			const Lsn lsn = log.logPageDiff(walFile, before, *page);
+			walMgr->unPinPage(&walFile, 2, true);
+			walMgr->readPage(&walFile, 3, page);
+			if (log.flushedLsn() <= lsn || walMgr->getBufStats().diskwrites != 1)
+			{
+				PRINT_ERROR("ERROR :: Page was evicted before the log was flushed up to its LSN.");
+			}
+			walMgr->unPinPage(&walFile, 3, false);
+			delete walMgr;
+		}
+	}
+	File::remove(walFilename);
+	std::remove(logFilename.c_str());
+
+	std::cout << "Test 23 passed" << "\n";
+}
+
+void test24()
+{
+	//Fuzzy checkpoints: recovery starts from the oldest recovery LSN instead of the start of the log
+	const std::string ckptFilename = "test.ckpt";
+	const std::string logFilename = "test.ckpt.log";
+	try
+	{
+		File::remove(ckptFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	std::remove(logFilename.c_str());
+	{
+		File ckptFile = File::create(ckptFilename);
+		for (i = 1; i <= 8; i++)
+		{
+			Page newPage = ckptFile.allocatePage();
+			ckptFile.writePage(newPage);
+		}
+		LogOptions logOptions;
+		logOptions.sync = false;
+		{
+			LogManager log(logFilename, logOptions);
+			BufMgrOptions options;
+			options.log = &log;
+			BufMgr* ckptMgr = new BufMgr(num / 10, options);
+			const Lsn start = log.endLsn();
+			for (i = 1; i <= 8; i++)
+			{
+				ckptMgr->readPage(&ckptFile, i, page);
+				const Page before = *page;
+				sprintf((char*)tmpbuf, "ckpt test Page %d %7.1f", i, (float)i);
+				page->insertRecord(tmpbuf);
+				log.logPageDiff(ckptFile, before, *page);
+				ckptMgr->unPinPage(&ckptFile, i, true);
+			}
+			log.commit();
+			if (ckptMgr->checkpoint() > start || log.redoLsn() > start)
+			{
+				PRINT_ERROR("ERROR :: Checkpoint redo LSN is past the oldest dirty page.");
+			}
+			if (ckptMgr->flushOldestDirty(100) != 8 || ckptMgr->getFileStats(&ckptFile).dirtyPages != 0)
+			{
+				PRINT_ERROR("ERROR :: flushOldestDirty did not write every dirty page.");
+			}
+			const Lsn clean = log.endLsn();
+			if (ckptMgr->checkpoint() < clean)
+			{
+				PRINT_ERROR("ERROR :: Checkpoint of a clean pool did not move the redo LSN to the end of the log.");
+			}
+
+			//page 3 is dirty at the checkpoint; page 5 is pinned and being changed
+			ckptMgr->readPage(&ckptFile, 3, page);
+			Page before = *page;
+			page->insertRecord("ckpt test second 3");
+			log.logPageDiff(ckptFile, before, *page);
+			ckptMgr->unPinPage(&ckptFile, 3, true);
+			ckptMgr->readPage(&ckptFile, 5, page);
+			before = *page;
+			page->insertRecord("ckpt test second 5");
+			log.logPageDiff(ckptFile, before, *page);
+			ckptMgr->checkpoint();
+			ckptMgr->unPinPage(&ckptFile, 5, true);
+			log.commit();
+			//crash
+			ckptMgr->dropFile(&ckptFile);
+			delete ckptMgr;
+		}
+		{
+			LogManager log(logFilename, logOptions);
+			std::vector<File*> files(1, &ckptFile);
+			const RedoStats redo = log.recover(files);
+			if (redo.recordsApplied == 0 || redo.pagesWritten != 2)
+			{
+				PRINT_ERROR("ERROR :: Recovery from the checkpoint did not redo the two pages changed since.");
+			}
+			for (i = 3; i <= 5; i += 2)
+			{
+				sprintf((char*)tmpbuf, "ckpt test second %d", i);
+				Page onDisk = ckptFile.readPage(i);
+				int records = 0;
+				for (PageIterator it = onDisk.begin(); it != onDisk.end(); ++it)
+				{
+					records++;
+					if (records == 2 && *it != tmpbuf)
+					{
+						PRINT_ERROR("ERROR :: Recovery lost a change made around the checkpoint.");
+					}
+				}
+				if (records != 2)
+				{
+					PRINT_ERROR("ERROR :: Recovery lost a change made around the checkpoint.");
+				}
+			}
+		}
+
+		//background checkpointer writes dirty pages within its budget and advances the redo LSN
+		{
+			LogManager log(logFilename, logOptions);
+			BufMgrOptions options;
+			options.log = &log;
+			BufMgr* ckptMgr = new BufMgr(num / 10, options);
+			for (i = 1; i <= 8; i++)
+			{
+				ckptMgr->readPage(&ckptFile, i, page);
+				const Page before = *page;
+				page->insertRecord("ckpt test background");
+				log.logPageDiff(ckptFile, before, *page);
+				ckptMgr->unPinPage(&ckptFile, i, true);
+			}
+			log.commit();
+			const Lsn end = log.endLsn();
+			CheckpointOptions checkpointOptions;
+			checkpointOptions.intervalMillis = 5;
+			checkpointOptions.tickMillis = 1;
+			Checkpointer* checkpointer = new Checkpointer(*ckptMgr, checkpointOptions);
+			for (int wait = 0; wait < 1000 && (checkpointer->getStats().pagesWritten < 8 ||
+				checkpointer->getStats().redoLsn < end); wait++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			}
+			const CheckpointStats stats = checkpointer->getStats();
+			checkpointer->stop();
+			delete checkpointer;
+			if (stats.pagesWritten < 8 || stats.checkpoints == 0 || stats.redoLsn < end ||
+				ckptMgr->getFileStats(&ckptFile).dirtyPages != 0)
+			{
+				PRINT_ERROR("ERROR :: Checkpointer did not write the dirty pages and advance the redo LSN.");
+			}
+			delete ckptMgr;
+		}
+	}
+	File::remove(ckptFilename);
+	std::remove(logFilename.c_str());
+
+	std::cout << "Test 24 passed" << "\n";
+}
+
+void test25()
+{
+	//Page checksums: a page damaged on disk is caught when the buffer manager reads it
+	if (crc32c("123456789", 9) != 0xE3069283 || crc32cPortable("123456789", 9) != 0xE3069283 ||
+		crc32c("56789", 5, crc32c("1234", 4)) != 0xE3069283)
+	{
+		PRINT_ERROR("ERROR :: CRC-32C of the check string is wrong.");
+	}
+	const std::string crcFilename = "test.crc";
+	try
+	{
+		File::remove(crcFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File crcFile = File::create(crcFilename);
+		for (i = 1; i <= 4; i++)
+		{
+			Page newPage = crcFile.allocatePage();
+			sprintf((char*)tmpbuf, "crc test Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			crcFile.writePage(newPage);
+		}
+
+		//flip one byte of page 2 behind the file's back
+		{
+			std::fstream raw(crcFilename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			const std::streamoff offset = sizeof(FileHeader) + Page::SIZE + Page::SIZE / 2;
+			char byte;
+			raw.seekg(offset);
+			raw.read(&byte, 1);
+			byte ^= 0x40;
+			raw.seekp(offset);
+			raw.write(&byte, 1);
+		}
+
+		BufMgr* crcMgr = new BufMgr(3);
+		crcMgr->readPage(&crcFile, 1, page);
+		crcMgr->unPinPage(&crcFile, 1, false);
+		try
+		{
+			crcMgr->readPage(&crcFile, 2, page);
+			PRINT_ERROR("ERROR :: Damaged page was read without a checksum mismatch.");
+		}
+		catch(ChecksumMismatchException& e)
+		{
+			if (e.page_number() != 2)
+			{
+				PRINT_ERROR("ERROR :: Checksum mismatch reported for the wrong page.");
+			}
+		}
+		std::vector<PageId> pageNos;
+		std::vector<Page*> pages;
+		for (i = 2; i <= 4; i++)
+		{
+			pageNos.push_back(i);
+		}
+		try
+		{
+			crcMgr->readPages(&crcFile, pageNos, pages);
+			PRINT_ERROR("ERROR :: Damaged page was read in a batch without a checksum mismatch.");
+		}
+		catch(ChecksumMismatchException&)
+		{
+		}
+		//the failed reads left every frame unpinned
+		pageNos[0] = 1;
+		crcMgr->readPages(&crcFile, pageNos, pages);
+		for (i = 1; i <= 4; i++)
+		{
+			if (i != 2)
+			{
+				crcMgr->unPinPage(&crcFile, i, false);
+			}
+		}
+
+		//with checksums off the page is read as it is, and written back without one
+		crcFile.setChecksums(false);
+		crcMgr->readPage(&crcFile, 2, page);
+		crcMgr->unPinPage(&crcFile, 2, true);
+		crcMgr->flushFile(&crcFile);
+		crcFile.setChecksums(true);
+		Page unsummed = crcFile.readPage(2);
+		if (!unsummed.verifyChecksum())
+		{
+			PRINT_ERROR("ERROR :: Page written without a checksum failed verification.");
+		}
+		crcMgr->readPage(&crcFile, 2, page);
+		crcMgr->unPinPage(&crcFile, 2, true);
+		crcMgr->flushFile(&crcFile);
+		delete crcMgr;
+
+		//written back with checksums on, the page is stamped again
+		{
+			std::fstream raw(crcFilename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			const std::streamoff offset = sizeof(FileHeader) + Page::SIZE + Page::SIZE - 1;
+			raw.seekp(offset);
+			raw.write("x", 1);
+		}
+		if (crcFile.readPage(2).verifyChecksum())
+		{
+			PRINT_ERROR("ERROR :: Page written back with checksums on was not stamped.");
+		}
+	}
+	File::remove(crcFilename);
+
+	std::cout << "Test 25 passed" << "\n";
+}
+
+void test26()
+{
+	//Compressed files: pages round-trip through LZ4 extents and the map is rebuilt on open
+	{
+		std::vector<char> input(3 * Page::SIZE);
+		unsigned int seed = 26;
+		for (std::size_t b = 0; b < input.size(); b++)
+		{
+			//random bytes, then a repeating pattern, then zeros
+			input[b] = b < Page::SIZE ? (char) rand_r(&seed) : b < 2 * Page::SIZE ? (char) (b % 7) : 0;
+		}
+		std::vector<char> compressed(lz4CompressBound(input.size()));
+		std::vector<char> output(input.size());
+		for (std::size_t length = 0; length <= input.size(); length += length < 64 ? 1 : 4093)
+		{
+			const std::size_t packed = lz4Compress(&input[0], length, &compressed[0], compressed.size());
+			if ((length > 0 && packed == 0) ||
+				lz4Decompress(&compressed[0], packed, &output[0], output.size()) != length ||
+				std::memcmp(&input[0], &output[0], length) != 0)
+			{
+				PRINT_ERROR("ERROR :: LZ4 round trip changed the data.");
+			}
+		}
+		const std::size_t packed = lz4Compress(&input[0], input.size(), &compressed[0], compressed.size());
+		if (packed > input.size() / 2 || lz4Decompress(&compressed[0], packed, &output[0], input.size() - 1) != 0)
+		{
+			PRINT_ERROR("ERROR :: LZ4 did not compress, or wrote past the end of its output.");
+		}
+	}
+
+	const std::string lz4Filename = "test.lz4";
+	try
+	{
+		File::remove(lz4Filename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File lz4File = File::createCompressed(lz4Filename);
+		for (i = 1; i <= 20; i++)
+		{
+			Page newPage = lz4File.allocatePage();
+			sprintf((char*)tmpbuf, "lz4 test Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			lz4File.writePage(newPage);
+		}
+		const CompressionStats stats = lz4File.compressionStats();
+		if (!lz4File.compressed() || stats.pages != 20 || stats.fileBytes > 20 * Page::SIZE / 8)
+		{
+			PRINT_ERROR("ERROR :: Compressed file did not shrink its pages.");
+		}
+	}
+	{
+		File lz4File = File::open(lz4Filename);
+		if (!lz4File.compressed() || lz4File.compressionStats().pages != 20)
+		{
+			PRINT_ERROR("ERROR :: Compressed file was not recognized when opened again.");
+		}
+		//grow every other page through the buffer manager so that its extent has to move
+		BufMgr* lz4Mgr = new BufMgr(num / 10);
+		for (i = 2; i <= 20; i += 2)
+		{
+			lz4Mgr->readPage(&lz4File, i, page);
+			for (int r = 0; r < 40; r++)
+			{
+				sprintf((char*)tmpbuf, "lz4 test grown %d %d", i, r * 7919);
+				page->insertRecord(tmpbuf);
+			}
+			lz4Mgr->unPinPage(&lz4File, i, true);
+		}
+		lz4Mgr->flushFile(&lz4File);
+		delete lz4Mgr;
+		if (lz4File.compressionStats().relocations == 0)
+		{
+			PRINT_ERROR("ERROR :: Grown pages were not moved to new extents.");
+		}
+		lz4File.deletePage(5);
+	}
+	{
+		//a torn extent at the end of the file is ignored
+		std::ofstream tail(lz4Filename.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+		std::string torn("BDPX");
+		torn.append(28, (char) 0x7f);
+		tail.write(torn.data(), torn.size());
+	}
+	{
+		File lz4File = File::open(lz4Filename);
+		int pages = 0;
+		for (FileIterator it = lz4File.begin(); it != lz4File.end(); ++it)
+		{
+			Page onDisk = *it;
+			int records = 0;
+			for (PageIterator pit = onDisk.begin(); pit != onDisk.end(); ++pit)
+			{
+				records++;
+			}
+			sprintf((char*)tmpbuf, "lz4 test Page %d %7.1f", onDisk.page_number(), (float)onDisk.page_number());
+			if (*onDisk.begin() != tmpbuf || records != (onDisk.page_number() % 2 == 0 ? 41 : 1))
+			{
+				PRINT_ERROR("ERROR :: Compressed page did not read back as written.");
+			}
+			pages++;
+		}
+		if (pages != 19)
+		{
+			PRINT_ERROR("ERROR :: Compressed file lost or kept a page.");
+		}
+		Page reused = lz4File.allocatePage();
+		if (reused.page_number() != 5)
+		{
+			PRINT_ERROR("ERROR :: Deleted page of a compressed file was not reused.");
+		}
+	}
+	File::remove(lz4Filename);
+
+	std::cout << "Test 26 passed" << "\n";
+}
+
+void test27()
+{
+	//Second-level cache: evicted pages are found in the tier instead of the file
+	const std::string tierFilename = "test.tier";
+	try
+	{
+		File::remove(tierFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File tierFile = File::create(tierFilename);
+		for (i = 1; i <= 30; i++)
+		{
+			Page newPage = tierFile.allocatePage();
+			sprintf((char*)tmpbuf, "tier test Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			tierFile.writePage(newPage);
+		}
+		CompressedTier tier(1024 * 1024);
+		BufMgrOptions options;
+		options.tier = &tier;
+		BufMgr* tierMgr = new BufMgr(5, options);
+		for (i = 1; i <= 30; i++)
+		{
+			tierMgr->readPage(&tierFile, i, page);
+			if (i == 2)
+			{
+				page->insertRecord("tier test dirty");
+			}
+			tierMgr->unPinPage(&tierFile, i, i == 2);
+		}
+		if (tier.getStats().pages != 25 || tier.getStats().bytes > 25 * Page::SIZE / 4)
+		{
+			PRINT_ERROR("ERROR :: Evicted pages were not kept compressed in the tier.");
+		}
+		tierMgr->clearBufStats();
+		for (i = 1; i <= 20; i++)
+		{
+			tierMgr->readPage(&tierFile, i, page);
+			if (i == 2 && std::string(page->getRecord({2, 2})) != "tier test dirty")
+			{
+				PRINT_ERROR("ERROR :: Tier returned a stale copy of a page written back.");
+			}
+			tierMgr->unPinPage(&tierFile, i, false);
+		}
+		std::vector<PageId> pageNos;
+		std::vector<Page*> pages;
+		for (i = 1; i <= 5; i++)
+		{
+			pageNos.push_back(i);
+		}
+		tierMgr->readPages(&tierFile, pageNos, pages);
+		for (i = 1; i <= 5; i++)
+		{
+			sprintf((char*)tmpbuf, "tier test Page %d %7.1f", i, (float)i);
+			if (std::string(pages[i - 1]->getRecord({i, 1})) != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: Batch read from the tier returned the wrong page.");
+			}
+			tierMgr->unPinPage(&tierFile, i, false);
+		}
+		if (tierMgr->getBufStats().diskreads != 0 || tier.getStats().hits != 25)
+		{
+			PRINT_ERROR("ERROR :: Misses were not served from the tier.");
+		}
+		tierMgr->flushFile(&tierFile);
+		if (tier.getStats().pages != 0)
+		{
+			PRINT_ERROR("ERROR :: flushFile left the file's pages in the tier.");
+		}
+		delete tierMgr;
+
+		//a tier with room for two pages drops the oldest
+		CompressedTier small(2 * Page::SIZE + 2 * CompressedTier::ENTRY_OVERHEAD, false);
+		options.tier = &small;
+		tierMgr = new BufMgr(5, options);
+		for (i = 1; i <= 10; i++)
+		{
+			tierMgr->readPage(&tierFile, i, page);
+			tierMgr->unPinPage(&tierFile, i, false);
+		}
+		if (small.getStats().pages != 2 || small.getStats().evictions != 3)
+		{
+			PRINT_ERROR("ERROR :: Full tier did not drop its oldest pages.");
+		}
+		tierMgr->flushFile(&tierFile);
+		delete tierMgr;
+	}
+	File::remove(tierFilename);
+
+	std::cout << "Test 27 passed" << "\n";
+}
+
+void test28()
+{
+	//Victim cache file: evicted pages are read back from the cache file instead of their file
+	const std::string victimFilename = "test.victim";
+	const std::string cacheFilename = "test.victim.cache";
+	try
+	{
+		File::remove(victimFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File victimFile = File::create(victimFilename);
+		for (i = 1; i <= 20; i++)
+		{
+			Page newPage = victimFile.allocatePage();
+			sprintf((char*)tmpbuf, "victim test Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			victimFile.writePage(newPage);
+		}
+		FileTier* tier = new FileTier(cacheFilename, 8);
+		BufMgrOptions options;
+		options.tier = tier;
+		BufMgr* victimMgr = new BufMgr(5, options);
+		for (i = 1; i <= 20; i++)
+		{
+			victimMgr->readPage(&victimFile, i, page);
+			victimMgr->unPinPage(&victimFile, i, false);
+		}
+		//pages 1-15 were evicted; the cache file kept the last 8 of them
+		if (tier->getStats().pages != 8 || tier->getStats().evictions != 7)
+		{
+			PRINT_ERROR("ERROR :: Cache file did not keep the most recently evicted pages.");
+		}
+
+		//damage the cached copy of page 9, in the first slot; it must come from the file instead
+		{
+			std::fstream raw(cacheFilename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			raw.seekp(Page::SIZE - 1);
+			raw.write("x", 1);
+		}
+		//read back newest first: each read evicts a page into the cache file, which must not
+		//push out the ones still wanted
+		victimMgr->clearBufStats();
+		for (i = 15; i >= 9; i--)
+		{
+			victimMgr->readPage(&victimFile, i, page);
+			sprintf((char*)tmpbuf, "victim test Page %d %7.1f", i, (float)i);
+			if (std::string(page->getRecord({i, 1})) != tmpbuf)
+			{
+				PRINT_ERROR("ERROR :: Page read through the cache file is wrong.");
+			}
+			victimMgr->unPinPage(&victimFile, i, false);
+		}
+		if (tier->getStats().hits != 6 || victimMgr->getBufStats().diskreads != 1)
+		{
+			PRINT_ERROR("ERROR :: Misses were not served from the cache file, or a damaged copy was used.");
+		}
+		victimMgr->flushFile(&victimFile);
+		if (tier->getStats().pages != 0)
+		{
+			PRINT_ERROR("ERROR :: flushFile left the file's pages in the cache file.");
+		}
+		delete victimMgr;
+		delete tier;
+		if (File::exists(cacheFilename))
+		{
+			PRINT_ERROR("ERROR :: Cache file was not removed with its tier.");
+		}
+	}
+	File::remove(victimFilename);
+
+	std::cout << "Test 28 passed" << "\n";
+}
+
+void test29()
+{
+	//Heap file: inserts fill the pages the free-space map points at, and reuse deleted space
+	const std::string heapFilename = "test.heap";
+	try
+	{
+		File::remove(heapFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	std::vector<RecordId> rids;
+	{
+		File heapFile = File::create(heapFilename);
+		BufMgr* heapMgr = new BufMgr(8);
+		{
+			HeapFile heap(*heapMgr, heapFile);
+			for (i = 0; i < 2000; i++)
+			{
+				sprintf((char*)tmpbuf, "heap record %d %0*d", i, 20 + i % 60, i);
+				rids.push_back(heap.insertRecord(tmpbuf));
+			}
+			//about 70 bytes a record, so 2000 of them fill 18 or so pages
+			const std::uint32_t fullPages = heap.getNumDataPages();
+			if (fullPages > 20 || HeapFile::isFsmPage(rids.front().page_number) ||
+				heap.getFreeSpaceClass(rids.front().page_number) > 4)
+			{
+				PRINT_ERROR("ERROR :: Records were not packed onto the heap's pages.");
+			}
+			for (i = 0; i < 2000; i += 2)
+			{
+				heap.deleteRecord(rids[i]);
+			}
+			for (i = 0; i < 2000; i += 2)
+			{
+				sprintf((char*)tmpbuf, "heap record %d %0*d", i, 20 + i % 60, i);
+				rids[i] = heap.insertRecord(tmpbuf);
+			}
+			if (heap.getNumDataPages() != fullPages)
+			{
+				PRINT_ERROR("ERROR :: Inserts did not reuse the space of deleted records.");
+			}
+			heap.updateRecord(rids[7], "updated");
+			try
+			{
+				heap.getRecord({1, 1});
+				PRINT_ERROR("ERROR :: A free-space map page was read as a record.");
+			}
+			catch(InvalidRecordException e)
+			{
+			}
+		}
+		heapMgr->flushFile(&heapFile);
+
+		//a heap opened again reads its map back
+		HeapFile heap(*heapMgr, heapFile);
+		for (i = 0; i < 2000; i++)
+		{
+			sprintf((char*)tmpbuf, "heap record %d %0*d", i, 20 + i % 60, i);
+			if (heap.getRecord(rids[i]) != (i == 7 ? std::string("updated") : std::string(tmpbuf)))
+			{
+				PRINT_ERROR("ERROR :: Heap record read back is wrong.");
+			}
+		}
+		const std::uint32_t pages = heap.getNumDataPages();
+		heap.insertRecord("one more");
+		if (heap.getNumDataPages() != pages)
+		{
+			PRINT_ERROR("ERROR :: Reopened heap did not find the free space it has.");
+		}
+		heapMgr->flushFile(&heapFile);
+		delete heapMgr;
+	}
+	File::remove(heapFilename);
+
+	std::cout << "Test 29 passed" << "\n";
+}
+
+void test30()
+{
+	//B+tree: inserts in any order, duplicates, byte keys, bulk loading and a reader alongside a writer
+	const std::string treeFilename = "test.btree";
+	const std::string bytesFilename = "test.bytes";
+	const std::string bulkFilename = "test.bulk";
+	try
+	{
+		File::remove(treeFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	try
+	{
+		File::remove(bytesFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	try
+	{
+		File::remove(bulkFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File treeFile = File::create(treeFilename);
+		BufMgr* treeMgr = new BufMgr(16);
+		{
+			BTreeIndex tree(*treeMgr, treeFile, BTreeIndex::INTEGER_KEYS);
+			for (i = 0; i < 20000; i++)
+			{
+				const int key = (i * 7919) % 20000 - 10000;
+				tree.insert(key, {(PageId)(key + 10001), 1});
+			}
+			if (tree.getHeight() < 2)
+			{
+				PRINT_ERROR("ERROR :: Root of the B+tree never split.");
+			}
+			RecordId rid;
+			for (i = -10000; i < 10000; i += 37)
+			{
+				if (!tree.lookup(i, rid) || rid.page_number != (PageId)(i + 10001))
+				{
+					PRINT_ERROR("ERROR :: B+tree lookup did not find an inserted key.");
+				}
+			}
+			if (tree.lookup(10000, rid) || tree.lookup((std::int64_t) -10001, rid))
+			{
+				PRINT_ERROR("ERROR :: B+tree lookup found a key that was never inserted.");
+			}
+			std::vector<RecordId> rids;
+			if (tree.scan(-50, 49, rids) != 100)
+			{
+				PRINT_ERROR("ERROR :: B+tree range scan found the wrong number of entries.");
+			}
+			for (i = 0; i < 100; i++)
+			{
+				if (rids[i].page_number != (PageId)(i + 9951))
+				{
+					PRINT_ERROR("ERROR :: B+tree range scan is out of order.");
+				}
+			}
+			//a key inserted many times spans leaves
+			for (i = 0; i < 1000; i++)
+			{
+				tree.insert(5, {(PageId)(i + 1), 2});
+			}
+			rids.clear();
+			if (tree.scan(5, 5, rids) != 1001 || rids[1].page_number != 1 || rids[1000].page_number != 1000)
+			{
+				PRINT_ERROR("ERROR :: B+tree did not keep duplicate keys in insertion order.");
+			}
+			try
+			{
+				tree.insert(std::string("bytes"), {1, 1});
+				PRINT_ERROR("ERROR :: B+tree of integer keys took a byte key.");
+			}
+			catch(IndexException e)
+			{
+			}
+
+			//a reader sees every entry that was there before a writer started splitting nodes
+			std::atomic<bool> missing(false);
+			std::thread reader([&tree, &missing]()
+			{
+				RecordId found;
+				for (int round = 0; round < 5; round++)
+				{
+					for (int key = -10000; key < 10000; key += 3)
+					{
+						if (!tree.lookup(key, found))
+						{
+							missing = true;
+						}
+					}
+				}
+			});
+			for (i = 10000; i < 30000; i++)
+			{
+				tree.insert(i, {(PageId)(i + 10001), 1});
+			}
+			reader.join();
+			rids.clear();
+			if (missing || tree.scan(-10000, 29999, rids) != 41000)
+			{
+				PRINT_ERROR("ERROR :: B+tree lost entries while read and written at once.");
+			}
+		}
+
+		//byte keys, some long enough that only a few fit in a node
+		{
+			BufMgr* bytesMgr = new BufMgr(16);
+			File bytesFile = File::create(bytesFilename);
+			{
+				//the keys of a letter are every 26th, the 'b' ones from 15 on
+				BTreeIndex tree(*bytesMgr, bytesFile, BTreeIndex::BYTE_KEYS);
+				for (i = 0; i < 3000; i++)
+				{
+					std::string key(i % 10 == 0 ? 900 : 10, (char)('a' + (i * 7) % 26));
+					sprintf((char*)tmpbuf, "%05d", i);
+					tree.insert(key + tmpbuf, {(PageId)(i + 1), 3});
+				}
+				RecordId rid;
+				for (i = 0; i < 3000; i += 7)
+				{
+					std::string key(i % 10 == 0 ? 900 : 10, (char)('a' + (i * 7) % 26));
+					sprintf((char*)tmpbuf, "%05d", i);
+					if (!tree.lookup(key + tmpbuf, rid) || rid.page_number != (PageId)(i + 1))
+					{
+						PRINT_ERROR("ERROR :: B+tree lookup did not find a byte key.");
+					}
+				}
+				std::vector<RecordId> rids;
+				if (tree.scan(std::string("b"), std::string("c"), rids) != 3000 / 26)
+				{
+					PRINT_ERROR("ERROR :: B+tree scan of byte keys found the wrong number of entries.");
+				}
+				try
+				{
+					tree.insert(std::string(BTreeIndex::MAX_KEY_LENGTH + 1, 'x'), {1, 1});
+					PRINT_ERROR("ERROR :: B+tree took a key longer than MAX_KEY_LENGTH.");
+				}
+				catch(IndexException e)
+				{
+				}
+			}
+			delete bytesMgr;
+		}
+		delete treeMgr;
+	}
+	File::remove(treeFilename);
+	File::remove(bytesFilename);
+
+	{
+		File bulkFile = File::create(bulkFilename);
+		BufMgr* bulkMgr = new BufMgr(16);
+		std::vector<std::pair<std::int64_t, RecordId> > entries;
+		for (i = 0; i < 50000; i++)
+		{
+			entries.push_back(std::make_pair((std::int64_t) i * 2, RecordId{(PageId)(i + 1), 1}));
+		}
+		{
+			BTreeIndex tree(*bulkMgr, bulkFile, BTreeIndex::INTEGER_KEYS);
+			std::vector<std::pair<std::int64_t, RecordId> > unsorted(entries.rbegin(), entries.rend());
+			try
+			{
+				tree.bulkLoad(unsorted);
+				PRINT_ERROR("ERROR :: B+tree bulk loaded unsorted entries.");
+			}
+			catch(IndexException e)
+			{
+			}
+			tree.bulkLoad(entries, 0.7);
+			//room was left for entries between the loaded ones
+			for (i = 1; i < 2000; i += 2)
+			{
+				tree.insert(i, {(PageId)(i + 1), 2});
+			}
+		}
+		bulkMgr->flushFile(&bulkFile);
+
+		//an index opened again finds its root on page 1
+		BTreeIndex tree(*bulkMgr, bulkFile, BTreeIndex::INTEGER_KEYS);
+		std::vector<RecordId> rids;
+		if (tree.getHeight() < 2 || tree.scan(0, 99999, rids) != 51000)
+		{
+			PRINT_ERROR("ERROR :: Bulk loaded B+tree lost entries.");
+		}
+		RecordId rid;
+		if (!tree.lookup(77776, rid) || rid.page_number != 38889 || !tree.lookup(1001, rid) ||
+			rid.page_number != 1002)
+		{
+			PRINT_ERROR("ERROR :: Bulk loaded B+tree lookup failed.");
+		}
+		try
+		{
+			BTreeIndex bytes(*bulkMgr, bulkFile, BTreeIndex::BYTE_KEYS);
+			PRINT_ERROR("ERROR :: B+tree of integer keys was opened for byte keys.");
+		}
+		catch(IndexException e)
+		{
+		}
+		bulkMgr->flushFile(&bulkFile);
+		delete bulkMgr;
+	}
+	File::remove(bulkFilename);
+
+	std::cout << "Test 30 passed" << "\n";
+}
+
+void test31()
+{
+	//Hash index: buckets split as they fill, duplicates chain overflow pages, and the directory is rebuilt on opening
+	const std::string hashFilename = "test.hash";
+	const std::string bytesFilename = "test.hashbytes";
+	try
+	{
+		File::remove(hashFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	try
+	{
+		File::remove(bytesFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File hashFile = File::create(hashFilename);
+		BufMgr* hashMgr = new BufMgr(8);
+		{
+			HashIndex hash(*hashMgr, hashFile, HashIndex::INTEGER_KEYS);
+			for (i = 0; i < 20000; i++)
+			{
+				hash.insert((std::int64_t) i * 3, {(PageId)(i + 1), 1});
+			}
+			//about 400 integer keys fit in a bucket
+			if (hash.getNumBuckets() < 50 || hash.getGlobalDepth() < 6)
+			{
+				PRINT_ERROR("ERROR :: Hash index buckets did not split.");
+			}
+			RecordId rid;
+			for (i = 0; i < 20000; i += 7)
+			{
+				if (!hash.lookup((std::int64_t) i * 3, rid) || rid.page_number != (PageId)(i + 1))
+				{
+					PRINT_ERROR("ERROR :: Hash index lookup did not find an inserted key.");
+				}
+			}
+			if (hash.lookup(1, rid) || hash.lookup(60000, rid))
+			{
+				PRINT_ERROR("ERROR :: Hash index lookup found a key that was never inserted.");
+			}
+			//more entries of one key than a bucket holds
+			for (i = 0; i < 1000; i++)
+			{
+				hash.insert(7, {(PageId)(i + 1), 2});
+			}
+			std::vector<RecordId> rids;
+			if (hash.lookupAll(7, rids) != 1000 || rids[0].page_number != 1 || rids[999].page_number != 1000 ||
+				hash.getGlobalDepth() > 16)
+			{
+				PRINT_ERROR("ERROR :: Hash index did not chain the duplicates of a key.");
+			}
+			try
+			{
+				hash.insert(std::string("bytes"), {1, 1});
+				PRINT_ERROR("ERROR :: Hash index of integer keys took a byte key.");
+			}
+			catch(IndexException e)
+			{
+			}
+		}
+		hashMgr->flushFile(&hashFile);
+
+		//an index opened again rebuilds the directory from its buckets
+		{
+			HashIndex hash(*hashMgr, hashFile, HashIndex::INTEGER_KEYS);
+			RecordId rid;
+			for (i = 0; i < 20000; i += 13)
+			{
+				if (!hash.lookup((std::int64_t) i * 3, rid) || rid.page_number != (PageId)(i + 1))
+				{
+					PRINT_ERROR("ERROR :: Reopened hash index lost a key.");
+				}
+			}
+			hash.insert(1, {1, 3});
+			if (!hash.lookup(1, rid) || rid.slot_number != 3)
+			{
+				PRINT_ERROR("ERROR :: Reopened hash index did not take an insert.");
+			}
+		}
+		try
+		{
+			HashIndex bytes(*hashMgr, hashFile, HashIndex::BYTE_KEYS);
+			PRINT_ERROR("ERROR :: Hash index of integer keys was opened for byte keys.");
+		}
+		catch(IndexException e)
+		{
+		}
+		hashMgr->flushFile(&hashFile);
+
+		//byte keys, some long enough that only a few fit in a bucket
+		File bytesFile = File::create(bytesFilename);
+		{
+			HashIndex hash(*hashMgr, bytesFile, HashIndex::BYTE_KEYS);
+			for (i = 0; i < 3000; i++)
+			{
+				sprintf((char*)tmpbuf, "%05d", i);
+				hash.insert(std::string(i % 10 == 0 ? 900 : 10, 'k') + tmpbuf, {(PageId)(i + 1), 4});
+			}
+			RecordId rid;
+			for (i = 0; i < 3000; i += 3)
+			{
+				sprintf((char*)tmpbuf, "%05d", i);
+				if (!hash.lookup(std::string(i % 10 == 0 ? 900 : 10, 'k') + tmpbuf, rid) ||
+					rid.page_number != (PageId)(i + 1))
+				{
+					PRINT_ERROR("ERROR :: Hash index lookup did not find a byte key.");
+				}
+			}
+			if (hash.lookup(std::string("kkkkkkkkkk00010"), rid))
+			{
+				PRINT_ERROR("ERROR :: Hash index matched a key of another length.");
+			}
+		}
+		hashMgr->flushFile(&bytesFile);
+		delete hashMgr;
+	}
+	File::remove(hashFilename);
+	File::remove(bytesFilename);
+
+	std::cout << "Test 31 passed" << "\n";
+}
+
+void test32()
+{
+	//Parallel scan: every record of every used page is seen once, whichever worker gets it
+	const std::string scanFilename = "test.scan";
+	try
+	{
+		File::remove(scanFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File scanFile = File::create(scanFilename);
+		std::uint64_t expected = 0;
+		for (i = 0; i < 300; i++)
+		{
+			Page page = scanFile.allocatePage();
+			for (int r = 0; r < (int) (1 + i % 20); r++)
+			{
+				sprintf((char*)tmpbuf, "scan %d %d", i, r);
+				page.insertRecord(tmpbuf);
+			}
+			scanFile.writePage(page);
+		}
+		//a free page in the middle of a morsel is skipped
+		scanFile.deletePage(101);
+		for (i = 0; i < 300; i++)
+		{
+			expected += (i == 100) ? 0 : 1 + i % 20;
+		}
+
+		BufMgr* scanMgr = new BufMgr(64);
+		{
+			ParallelScan scan(*scanMgr, 4, 8);
+			std::vector<std::uint64_t> perWorker(scan.getNumWorkers(), 0);
+			std::vector<std::atomic<int> > seen(301 * 20);
+			for (std::size_t s = 0; s < seen.size(); s++)
+			{
+				seen[s] = 0;
+			}
+			const std::uint64_t records = scan.forEach(scanFile, [&perWorker, &seen](const std::uint32_t worker,
+				const RecordId& rid, const std::string& record)
+			{
+				perWorker[worker]++;
+				seen[rid.page_number * 20 + rid.slot_number - 1]++;
+				int pageNo, slot;
+				if (sscanf(record.c_str(), "scan %d %d", &pageNo, &slot) != 2 || pageNo + 1 != (int) rid.page_number)
+				{
+					seen[0] = 2;
+				}
+			});
+			std::uint64_t total = 0;
+			for (std::size_t w = 0; w < perWorker.size(); w++)
+			{
+				total += perWorker[w];
+			}
+			if (records != expected || total != expected)
+			{
+				PRINT_ERROR("ERROR :: Parallel scan did not see every record.");
+			}
+			for (std::size_t s = 0; s < seen.size(); s++)
+			{
+				if (seen[s] > 1)
+				{
+					PRINT_ERROR("ERROR :: Parallel scan saw a record twice, or a wrong one.");
+				}
+			}
+
+			//the records of the pages with 20 of them
+			const std::uint64_t matches = scan.count(scanFile, [](const RecordId& rid, const std::string& record)
+			{
+				return rid.slot_number == 20;
+			});
+			if (matches != 15)
+			{
+				PRINT_ERROR("ERROR :: Parallel scan count found the wrong number of records.");
+			}
+
+			//an exception in the callback ends the scan and is passed on, with nothing left pinned
+			try
+			{
+				scan.forEach(scanFile, [](const std::uint32_t worker, const RecordId& rid, const std::string& record)
+				{
+					if (rid.page_number == 250)
+					{
+						throw InvalidRecordException(rid, rid.page_number);
+					}
+				});
+				PRINT_ERROR("ERROR :: Parallel scan lost the exception of a callback.");
+			}
+			catch(InvalidRecordException e)
+			{
+			}
+			if (scan.forEach(scanFile, [](const std::uint32_t, const RecordId&, const std::string&) {}) != expected)
+			{
+				PRINT_ERROR("ERROR :: Parallel scan after a failed one did not see every record.");
+			}
+		}
+		scanMgr->flushFile(&scanFile);
+		delete scanMgr;
+	}
+	File::remove(scanFilename);
+
+	std::cout << "Test 32 passed" << "\n";
+}
+
+void test33()
+{
+	//Compressed files: a damaged extent in the middle of the file is reported, not taken for a free page
+	const std::string lz4Filename = "test.lz4bad";
+	try
+	{
+		File::remove(lz4Filename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File lz4File = File::createCompressed(lz4Filename);
+		for (i = 1; i <= 20; i++)
+		{
+			Page newPage = lz4File.allocatePage();
+			sprintf((char*)tmpbuf, "lz4 damaged Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			lz4File.writePage(newPage);
+		}
+	}
+	{
+		File lz4File = File::open(lz4Filename);
+		const Page beforeDamage = lz4File.readPage(10);
+		{
+			//overwrite the magic number of page 10's extent
+			std::fstream raw(lz4Filename.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+			std::stringstream contents;
+			contents << raw.rdbuf();
+			const std::string bytes = contents.str();
+			std::size_t offset = bytes.find("BDPX");
+			while (offset != std::string::npos)
+			{
+				PageId pageNo;
+				std::memcpy(&pageNo, bytes.data() + offset + 4, sizeof(pageNo));
+				if (pageNo == 10)
+				{
+					break;
+				}
+				offset = bytes.find("BDPX", offset + 1);
+			}
+			if (offset == std::string::npos || offset + Page::SIZE / 8 > bytes.size())
+			{
+				PRINT_ERROR("ERROR :: Extent of page 10 is not in the middle of the file.");
+			}
+			raw.clear();
+			raw.seekp(offset, std::ios::beg);
+			raw.write("XXXX", 4);
+		}
+
+		Page onDisk = lz4File.readPage(9);
+		onDisk = lz4File.readPage(11);
+		try
+		{
+			lz4File.readPage(10);
+			PRINT_ERROR("ERROR :: Damaged extent was read as a page.");
+		}
+		catch(ChecksumMismatchException& e)
+		{
+			if (e.page_number() != 10 || e.filename() != lz4Filename)
+			{
+				PRINT_ERROR("ERROR :: Damaged extent reported for the wrong page.");
+			}
+		}
+		try
+		{
+			lz4File.writePage(beforeDamage);
+			PRINT_ERROR("ERROR :: Page with a damaged extent was taken for a deleted one.");
+		}
+		catch(ChecksumMismatchException&)
+		{
+		}
+
+		//a batch read fails rather than leave the old contents of the vector in place
+		std::vector<PageId> pageNos;
+		std::vector<Page> pages(5);
+		for (i = 8; i <= 12; i++)
+		{
+			pageNos.push_back(i);
+		}
+		try
+		{
+			lz4File.readPages(pageNos, pages);
+			PRINT_ERROR("ERROR :: Damaged extent was read in a batch.");
+		}
+		catch(ChecksumMismatchException&)
+		{
+		}
+
+		BufMgr* lz4Mgr = new BufMgr(num / 10);
+		try
+		{
+			lz4Mgr->readPage(&lz4File, 10, page);
+			PRINT_ERROR("ERROR :: Damaged extent was read through the buffer pool.");
+		}
+		catch(ChecksumMismatchException&)
+		{
+		}
+		lz4Mgr->readPage(&lz4File, 9, page);
+		lz4Mgr->unPinPage(&lz4File, 9, false);
+		delete lz4Mgr;
+
+		int pagesSeen = 0;
+		try
+		{
+			for (FileIterator it = lz4File.begin(); it != lz4File.end(); ++it)
+			{
+				onDisk = *it;
+				pagesSeen++;
+			}
+			PRINT_ERROR("ERROR :: File scan ended quietly at a damaged extent.");
+		}
+		catch(ChecksumMismatchException&)
+		{
+			if (pagesSeen != 9)
+			{
+				PRINT_ERROR("ERROR :: File scan did not stop at the damaged extent.");
+			}
+		}
+	}
+	for (int round = 0; round < 2; round++)
+	{
+		//opened again, only the damaged page is lost; the extents after it are found past the damage
+		File lz4File = File::open(lz4Filename);
+		for (i = 1; i <= 20; i++)
+		{
+			if (i == 10)
+			{
+				try
+				{
+					lz4File.readPage(10);
+					PRINT_ERROR("ERROR :: Damaged extent was read as a page after opening again.");
+				}
+				catch(ChecksumMismatchException&)
+				{
+				}
+				continue;
+			}
+			Page onDisk = lz4File.readPage(i);
+			int records = 0;
+			for (PageIterator pit = onDisk.begin(); pit != onDisk.end(); ++pit)
+			{
+				records++;
+			}
+			sprintf((char*)tmpbuf, "lz4 damaged Page %d %7.1f", i, (float)i);
+			if (*onDisk.begin() != tmpbuf || records != (round == 1 && i == 15 ? 41 : 1))
+			{
+				PRINT_ERROR("ERROR :: Page after a damaged extent did not read back as written.");
+			}
+		}
+		if (round == 0)
+		{
+			//grow a page so that its extent moves to the end of the file, past the ones kept
+			Page grown = lz4File.readPage(15);
+			for (int r = 0; r < 40; r++)
+			{
+				sprintf((char*)tmpbuf, "lz4 damaged grown %d", r * 7919);
+				grown.insertRecord(tmpbuf);
+			}
+			lz4File.writePage(grown);
+			if (lz4File.compressionStats().relocations != 1)
+			{
+				PRINT_ERROR("ERROR :: Grown page was not moved to a new extent.");
+			}
+		}
+	}
+	File::remove(lz4Filename);
+
+	std::cout << "Test 33 passed" << "\n";
+}
+
+void test34()
+{
+	//A page read before a wait for a frame must not be installed over a newer copy written during the wait
+	const std::string staleFilename = "test.stale";
+	try
+	{
+		File::remove(staleFilename);
+	}
+	catch(FileNotFoundException e)
+	{
+	}
+	{
+		File staleFile = File::create(staleFilename);
+		for (i = 1; i <= 3; i++)
+		{
+			Page newPage = staleFile.allocatePage();
+			sprintf((char*)tmpbuf, "stale test Page %d %7.1f", i, (float)i);
+			newPage.insertRecord(tmpbuf);
+			staleFile.writePage(newPage);
+		}
+		{
+			BufMgr* dumpMgr = new BufMgr(3);
+			dumpMgr->readPage(&staleFile, 3, page);
+			dumpMgr->unPinPage(&staleFile, 3, false);
+			dumpMgr->dumpResidentSet("test.resident");
+			delete dumpMgr;
+		}
+
+		BufMgrOptions options;
+		options.evictionWaitMillis = 5000;
+		for (int warm = 0; warm < 2; warm++)
+		{
+			BufMgr* staleMgr = new BufMgr(2, options);
+			staleMgr->readPage(&staleFile, 1, page);
+			staleMgr->readPage(&staleFile, 2, page2);
+
+			//the reader reads page 3 and then waits for a frame
+			std::uint32_t warmed = 0;
+			std::thread reader([staleMgr, &staleFile, warm, &warmed]() {
+				if (warm)
+				{
+					std::vector<File*> files(1, &staleFile);
+					warmed = staleMgr->warmUp("test.resident", files);
+					return;
+				}
+				std::vector<Page*> pages;
+				staleMgr->readPages(&staleFile, std::vector<PageId>(1, 3), pages);
+				staleMgr->unPinPages(&staleFile, std::vector<PageId>(1, 3), false);
+			});
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+			//meanwhile page 3 gains a record on disk, as if another thread had changed and evicted it
+			Page changed = staleFile.readPage(3);
+			sprintf((char*)tmpbuf, "stale test changed %d", warm);
+			changed.insertRecord(tmpbuf);
+			staleFile.writePage(changed);
+			staleMgr->unPinPage(&staleFile, 1, false);
+			reader.join();
+			if (warm && warmed != 0)
+			{
+				PRINT_ERROR("ERROR :: Warm-up loaded a page it read before waiting for a frame.");
+			}
+
+			staleMgr->readPage(&staleFile, 3, page3);
+			int records = 0;
+			for (PageIterator pit = page3->begin(); pit != page3->end(); ++pit)
+			{
+				records++;
+			}
+			if (records != 2 + warm)
+			{
+				PRINT_ERROR("ERROR :: Page read before a wait for a frame hid a newer copy.");
+			}
+			staleMgr->unPinPage(&staleFile, 3, false);
+			staleMgr->unPinPage(&staleFile, 2, false);
+			delete staleMgr;
+		}
+	}
+	std::remove("test.resident");
+	File::remove(staleFilename);
+
+	std::cout << "Test 34 passed" << "\n";
+}
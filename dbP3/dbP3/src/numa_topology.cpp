@@ -0,0 +1,139 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "numa_topology.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace badgerdb {
+
+namespace {
+
+// From <numaif.h>; spelled out so that libnuma headers are not required.
+const int kMpolPreferred = 1;
+const unsigned kMpolMfMove = 1 << 1;
+
+const char* const kNodeDir = "/sys/devices/system/node/";
+
+}
+
+NumaTopology::NumaTopology()
+    : cpus_(1),
+      kernelNode_(1, 0) {
+}
+
+NumaTopology NumaTopology::detect() {
+  NumaTopology topology;
+  std::ifstream online((std::string(kNodeDir) + "online").c_str());
+  std::string nodeList;
+  if (!(online >> nodeList)) {
+    return topology;
+  }
+
+  std::vector<std::vector<int> > cpus;
+  std::vector<int> kernelNode;
+  const std::vector<int> nodes = parseList(nodeList);
+  for (std::size_t i = 0; i < nodes.size(); i++) {
+    std::ostringstream path;
+    path << kNodeDir << "node" << nodes[i] << "/cpulist";
+    std::ifstream cpulist(path.str().c_str());
+    std::string cpuList;
+    if (!(cpulist >> cpuList)) {
+      // Memory-only node; no thread can be local to it.
+      continue;
+    }
+    cpus.push_back(parseList(cpuList));
+    kernelNode.push_back(nodes[i]);
+  }
+  if (cpus.empty()) {
+    return topology;
+  }
+
+  topology.cpus_ = cpus;
+  topology.kernelNode_ = kernelNode;
+  for (std::uint32_t node = 0; node < cpus.size(); node++) {
+    for (std::size_t c = 0; c < cpus[node].size(); c++) {
+      const std::size_t cpu = cpus[node][c];
+      if (topology.nodeOfCpu_.size() <= cpu) {
+        topology.nodeOfCpu_.resize(cpu + 1, 0);
+      }
+      topology.nodeOfCpu_[cpu] = node;
+    }
+  }
+  return topology;
+}
+
+std::uint32_t NumaTopology::currentNode() const {
+  if (numNodes() == 1) {
+    return 0;
+  }
+  const int cpu = sched_getcpu();
+  if (cpu < 0 || (std::size_t) cpu >= nodeOfCpu_.size()) {
+    return 0;
+  }
+  return nodeOfCpu_[cpu];
+}
+
+bool NumaTopology::bindThread(const std::uint32_t node) const {
+  const std::vector<int>& cpus = cpus_[node];
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (std::size_t c = 0; c < cpus.size(); c++) {
+    CPU_SET(cpus[c], &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+void NumaTopology::bindMemory(void* addr, const std::size_t length,
+                              const std::uint32_t node) const {
+  if (numNodes() == 1) {
+    return;
+  }
+  const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+  const std::size_t begin = ((std::size_t) addr + pageSize - 1) / pageSize * pageSize;
+  const std::size_t end = ((std::size_t) addr + length) / pageSize * pageSize;
+  if (end <= begin) {
+    return;
+  }
+  const int kernelNode = kernelNode_[node];
+  const std::size_t bitsPerWord = 8 * sizeof(unsigned long);
+  std::vector<unsigned long> mask(kernelNode / bitsPerWord + 1, 0);
+  mask[kernelNode / bitsPerWord] |= 1UL << (kernelNode % bitsPerWord);
+  // Placement is only a hint: a failure leaves the memory where it is.
+  syscall(SYS_mbind, begin, end - begin, kMpolPreferred, &mask[0],
+          mask.size() * bitsPerWord + 1, kMpolMfMove);
+}
+
+std::vector<int> NumaTopology::parseList(const std::string& list) {
+  std::vector<int> numbers;
+  std::istringstream in(list);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    const std::size_t dash = range.find('-');
+    const int first = std::atoi(range.substr(0, dash).c_str());
+    const int last = dash == std::string::npos
+        ? first : std::atoi(range.substr(dash + 1).c_str());
+    for (int n = first; n <= last; n++) {
+      numbers.push_back(n);
+    }
+  }
+  return numbers;
+}
+
+}
@@ -0,0 +1,102 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace badgerdb {
+
+/**
+ * @brief NUMA nodes of the machine and the CPUs belonging to each.
+ *
+ * Nodes are numbered densely from 0 in the order the kernel lists them, which
+ * need not match the kernel's own node numbers.  On machines without NUMA
+ * information in /sys the topology degrades to a single node that covers
+ * every CPU, and all binding calls become no-ops.
+ */
+class NumaTopology {
+ public:
+  /**
+   * Constructs a single-node topology without consulting the system.
+   */
+  NumaTopology();
+
+  /**
+   * Reads the topology from /sys/devices/system/node.
+   *
+   * @return  Detected topology; a single node if none could be read.
+   */
+  static NumaTopology detect();
+
+  /**
+   * Returns the number of nodes that have CPUs.
+   */
+  std::uint32_t numNodes() const { return (std::uint32_t) cpus_.size(); }
+
+  /**
+   * Returns the CPUs of the given node.  Empty for the single fallback node.
+   *
+   * @param node  Dense node number.
+   */
+  const std::vector<int>& cpusOfNode(const std::uint32_t node) const {
+    return cpus_[node];
+  }
+
+  /**
+   * Returns the node the calling thread is currently running on.
+   */
+  std::uint32_t currentNode() const;
+
+  /**
+   * Restricts the calling thread to the CPUs of the given node.
+   *
+   * @param node  Dense node number.
+   * @return  True if the affinity was changed.
+   */
+  bool bindThread(const std::uint32_t node) const;
+
+  /**
+   * Asks the kernel to place (and migrate) the pages spanned by the given
+   * range on the given node.  Only whole pages inside the range are bound.
+   *
+   * @param addr    Start of the range.
+   * @param length  Length of the range in bytes.
+   * @param node    Dense node number.
+   */
+  void bindMemory(void* addr, const std::size_t length,
+                  const std::uint32_t node) const;
+
+ private:
+  /**
+   * Parses a kernel CPU or node list such as "0-3,8-11".
+   *
+   * @param list  List to parse.
+   * @return  Numbers in the list.
+   */
+  static std::vector<int> parseList(const std::string& list);
+
+  /**
+   * CPUs of each node.
+   */
+  std::vector<std::vector<int> > cpus_;
+
+  /**
+   * Kernel node number of each node.
+   */
+  std::vector<int> kernelNode_;
+
+  /**
+   * Node of each CPU, indexed by CPU number.
+   */
+  std::vector<std::uint32_t> nodeOfCpu_;
+};
+
+}
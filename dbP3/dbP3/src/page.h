@@ -57,6 +57,23 @@ struct PageHeader {
    */
   PageId next_page_number;
 
+  /**
+   * Log sequence number of the last logged change to the page, or 0.  Redo
+   * only applies log records newer than this.
+   */
+  Lsn page_lsn;
+
+  /**
+   * CRC-32C of the page as written to disk, computed with this field set to 0.
+   * Only meaningful if page_flags has Page::CHECKSUMMED set.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * Flags describing how the page is stored on disk.
+   */
+  std::uint32_t page_flags;
+
   /**
    * Returns true if this page header is equal to the other.
    *
@@ -117,6 +134,11 @@ class Page {
    */
   static const std::size_t DATA_SIZE = SIZE - sizeof(PageHeader);
 
+  /**
+   * Flag set in the page header when the page on disk carries a checksum.
+   */
+  static const std::uint32_t CHECKSUMMED = 1;
+
   /**
    * Number of page indicating that it's invalid.
    */
@@ -199,6 +221,41 @@ class Page {
    */
   PageId next_page_number() const { return header_.next_page_number; }
 
+  /**
+   * Returns the log sequence number of the last logged change to this page.
+   *
+   * @return  LSN of the page, or 0 if it was never logged.
+   */
+  Lsn lsn() const { return header_.page_lsn; }
+
+  /**
+   * Sets the log sequence number of the last logged change to this page.
+   *
+   * @param new_lsn   LSN of the change.
+   */
+  void set_lsn(const Lsn new_lsn) { header_.page_lsn = new_lsn; }
+
+  /**
+   * Returns true unless the page carries a checksum that does not match its
+   * contents.  Only meaningful for a page just read from disk; the checksum
+   * is not updated as the page is changed in memory.
+   *
+   * @return  Whether the page is intact (or has no checksum).
+   */
+  bool verifyChecksum() const;
+
+  /**
+   * Returns the DATA_SIZE bytes after the page header, for pages laid out by
+   * their owner (such as index nodes) rather than as records.  The record
+   * methods must not be used on such a page.
+   */
+  char* data() { return data_; }
+
+  /**
+   * Returns the DATA_SIZE bytes after the page header.
+   */
+  const char* data() const { return data_; }
+
   /**
    * Returns an iterator at the first record in the page.
    *
@@ -238,6 +295,17 @@ class Page {
     header_.next_page_number = new_next_page_number;
   }
 
+  /**
+   * Computes the checksum of a page with the given header and data, taking
+   * the header's checksum field as 0.
+   *
+   * @param header  Page header.
+   * @param data    Page data, DATA_SIZE bytes.
+   * @return  CRC-32C of the page.
+   */
+  static std::uint32_t computeChecksum(const PageHeader& header,
+                                       const char* data);
+
   /**
    * Deletes the record with the given ID.  Page is compacted upon delete to
    * ensure that data of all records is contiguous.  Slot array is compacted if
@@ -327,10 +395,10 @@ class Page {
 
   /**
    * Data stored on the page.  Includes bookkeeping information about slots as
-   * well as actual content.
+   * well as actual content.  Held inline so that a Page is exactly SIZE bytes
+   * and an array of Pages is one contiguous region.
    */
-
-  std::string data_;
+  char data_[DATA_SIZE];
 
   friend class File;
   friend class PageIterator;
@@ -342,5 +410,7 @@ static_assert(Page::SIZE > sizeof(PageHeader),
               "Page size must be large enough to hold header and data.");
 static_assert(Page::DATA_SIZE > 0,
               "Page must have some space to hold data.");
+static_assert(sizeof(Page) == Page::SIZE,
+              "Page must be exactly SIZE bytes so frames pack contiguously.");
 
 }
@@ -91,6 +91,13 @@ class PageIterator {
         (current_record_ != rhs.current_record_);
   }
 
+  /**
+   * Returns the ID of the record the iterator is at.
+   *
+   * @return  ID of current record.
+   */
+  const RecordId& record_id() const { return current_record_; }
+
   /**
    * Dereferences the iterator, returning a copy of the current record in the
    * page.
@@ -0,0 +1,223 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include <algorithm>
+#include "parallel_scan.h"
+#include "page_iterator.h"
+#include "exceptions/invalid_page_exception.h"
+
+namespace badgerdb {
+
+    /**
+     * Constructor of ParallelScan class; starts the workers
+     */
+    ParallelScan::ParallelScan(BufMgr& bufMgr, const std::uint32_t numWorkers, const std::uint32_t morselPages)
+    : bufMgr(bufMgr), numWorkers(std::max<std::uint32_t>(1, numWorkers)),
+      morselPages(std::max<std::uint32_t>(1, morselPages)), scanFile(NULL), scanCallback(NULL), scanPages(0),
+      numMorsels(0), nextMorsel(0), generation(0), busy(0), records(0), stopping(false)
+    {
+        for (std::uint32_t worker = 0; worker < this->numWorkers; worker++)
+        {
+            workers.push_back(std::thread(&ParallelScan::run, this, worker));
+        }
+    }
+
+    /**
+     * Destructor of ParallelScan class; stops the workers
+     */
+    ParallelScan::~ParallelScan()
+    {
+        {
+            std::lock_guard<std::mutex> guard(latch);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::size_t worker = 0; worker < workers.size(); worker++)
+        {
+            workers[worker].join();
+        }
+    }
+
+    std::uint64_t ParallelScan::forEach(File& file, const RecordCallback& callback)
+    {
+        std::lock_guard<std::mutex> scanGuard(scanLatch);
+        const PageId pages = file.numPages();
+        {
+            std::lock_guard<std::mutex> guard(latch);
+            scanFile = &file;
+            scanCallback = &callback;
+            scanPages = pages;
+            numMorsels = (pages + morselPages - 1) / morselPages;
+            nextMorsel = 0;
+            busy = numWorkers;
+            records = 0;
+            error = std::exception_ptr();
+            generation++;
+        }
+        wake.notify_all();
+
+        std::unique_lock<std::mutex> lock(latch);
+        done.wait(lock, [this]() { return busy == 0; });
+        scanFile = NULL;
+        scanCallback = NULL;
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        return records;
+    }
+
+    std::uint64_t ParallelScan::count(File& file, const RecordPredicate& predicate)
+    {
+        //a counter per worker, a cache line apart so that the workers do not share one
+        const std::size_t stride = 64 / sizeof(std::uint64_t);
+        std::vector<std::uint64_t> matches(numWorkers * stride, 0);
+        forEach(file, [&predicate, &matches, stride](const std::uint32_t worker, const RecordId& rid,
+                                                     const std::string& record)
+        {
+            if (predicate(rid, record))
+            {
+                matches[worker * stride]++;
+            }
+        });
+        std::uint64_t total = 0;
+        for (std::uint32_t worker = 0; worker < numWorkers; worker++)
+        {
+            total += matches[worker * stride];
+        }
+        return total;
+    }
+
+    /**
+     * Body of a worker thread
+     */
+    void ParallelScan::run(const std::uint32_t worker)
+    {
+        std::uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(latch);
+        for (;;)
+        {
+            wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            lock.unlock();
+
+            std::uint64_t scanned = 0;
+            std::exception_ptr failure;
+            try
+            {
+                for (;;)
+                {
+                    const std::uint32_t morsel = nextMorsel.fetch_add(1);
+                    if (morsel >= numMorsels)
+                    {
+                        break;
+                    }
+                    const PageId first = 1 + morsel * morselPages;
+                    const PageId last = std::min<PageId>(first + morselPages - 1, scanPages);
+                    scanned += scanMorsel(worker, first, last);
+                }
+            }
+            catch (...)
+            {
+                //leave no morsel for the others to start
+                nextMorsel = numMorsels;
+                failure = std::current_exception();
+            }
+
+            lock.lock();
+            records += scanned;
+            if (failure && !error)
+            {
+                error = failure;
+            }
+            if (--busy == 0)
+            {
+                done.notify_all();
+            }
+        }
+    }
+
+    /**
+     * Pass the records of pages first to last to the callback
+     */
+    std::uint64_t ParallelScan::scanMorsel(const std::uint32_t worker, const PageId first, const PageId last)
+    {
+        std::vector<PageId> pageNos;
+        for (PageId pageNo = first; pageNo <= last; pageNo++)
+        {
+            pageNos.push_back(pageNo);
+        }
+        std::vector<Page*> pages;
+        try
+        {
+            bufMgr.readPages(scanFile, pageNos, pages);
+        }
+        catch (InvalidPageException&)
+        {
+            //some pages of the morsel are free; pin the others one at a time
+            std::uint64_t scanned = 0;
+            for (PageId pageNo = first; pageNo <= last; pageNo++)
+            {
+                Page* page;
+                try
+                {
+                    bufMgr.readPage(scanFile, pageNo, page);
+                }
+                catch (InvalidPageException&)
+                {
+                    continue;
+                }
+                try
+                {
+                    scanned += scanPage(worker, page);
+                }
+                catch (...)
+                {
+                    bufMgr.unPinPage(scanFile, pageNo, false);
+                    throw;
+                }
+                bufMgr.unPinPage(scanFile, pageNo, false);
+            }
+            return scanned;
+        }
+
+        std::uint64_t scanned = 0;
+        try
+        {
+            for (std::size_t p = 0; p < pages.size(); p++)
+            {
+                scanned += scanPage(worker, pages[p]);
+            }
+        }
+        catch (...)
+        {
+            bufMgr.unPinPages(scanFile, pageNos, false);
+            throw;
+        }
+        bufMgr.unPinPages(scanFile, pageNos, false);
+        return scanned;
+    }
+
+    /**
+     * Pass the records of a pinned page to the callback
+     */
+    std::uint64_t ParallelScan::scanPage(const std::uint32_t worker, Page* page)
+    {
+        std::uint64_t scanned = 0;
+        for (PageIterator record = page->begin(); record != page->end(); ++record)
+        {
+            (*scanCallback)(worker, record.record_id(), *record);
+            scanned++;
+        }
+        return scanned;
+    }
+
+}
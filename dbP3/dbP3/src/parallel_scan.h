@@ -0,0 +1,223 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "buffer.h"
+#include "file.h"
+#include "types.h"
+
+namespace badgerdb {
+
+    /**
+     * @brief Full scan of the records of a file by a pool of worker threads
+     *
+     * The pages of the file, 1 to File::numPages(), are cut into morsels of consecutive
+     * pages, which the workers take in turn from a shared counter until none is left, so
+     * a worker that is held up takes fewer of them rather than holding up the scan.  A
+     * worker pins a whole morsel through the buffer pool with BufMgr::readPages(), so the
+     * pages of a morsel that are not buffered are read from the file in one read, and then
+     * passes every record of its pages to the callback.  Free pages are skipped.
+     *
+     * Unlike FileIterator, which reads the pages of the used list one after the other and
+     * straight from the file, a scan goes through the pool and does not follow the list, so
+     * pages are visited in no particular order; within a page, records come in slot order.
+     * Every page of the file must be a page of records (an index file cannot be scanned).
+     *
+     * The pool needs numWorkers * morselPages frames for the pinned morsels, besides
+     * whatever else is pinned.  Scans through one ParallelScan run one at a time.
+     */
+    class ParallelScan
+    {
+    public:
+        /**
+         * Called for every record: the number of the worker calling, below getNumWorkers(),
+         * the record's identifier and its contents.  Calls from different workers come at
+         * once; those from one worker one after the other.
+         */
+        typedef std::function<void(const std::uint32_t worker, const RecordId& rid, const std::string& record)>
+            RecordCallback;
+
+        /**
+         * Tells whether a record matches
+         */
+        typedef std::function<bool(const RecordId& rid, const std::string& record)> RecordPredicate;
+
+        /**
+         * Constructor of ParallelScan class; starts the workers
+         *
+         * @param bufMgr		Pool the pages are read through; must outlive the scan
+         * @param numWorkers		Number of worker threads, at least 1
+         * @param morselPages		Number of pages in a morsel, at least 1
+         */
+        ParallelScan(BufMgr& bufMgr, const std::uint32_t numWorkers, const std::uint32_t morselPages = 32);
+
+        /**
+         * Destructor of ParallelScan class; stops the workers
+         */
+        ~ParallelScan();
+
+        /**
+         * Pass every record of a file to a callback
+         *
+         * @param file		File to scan
+         * @param callback		Called for every record
+         * @return 		Number of records scanned
+         * @throws  The first exception a worker met, from the pool or the callback; the
+         * 			other workers stop at the end of their morsel
+         */
+        std::uint64_t forEach(File& file, const RecordCallback& callback);
+
+        /**
+         * Count the records of a file that match a predicate
+         *
+         * @param file		File to scan
+         * @param predicate		Called for every record, from several workers at once
+         * @return 		Number of matching records
+         */
+        std::uint64_t count(File& file, const RecordPredicate& predicate);
+
+        /**
+         * Number of worker threads
+         */
+        std::uint32_t getNumWorkers() const
+        {
+            return numWorkers;
+        }
+
+        /**
+         * Number of pages in a morsel
+         */
+        std::uint32_t getMorselPages() const
+        {
+            return morselPages;
+        }
+
+    private:
+        ParallelScan(const ParallelScan&);
+        ParallelScan& operator=(const ParallelScan&);
+
+        /**
+         * Body of a worker thread
+         */
+        void run(const std::uint32_t worker);
+
+        /**
+         * Pass the records of pages first to last to the callback
+         *
+         * @return 		Number of records
+         */
+        std::uint64_t scanMorsel(const std::uint32_t worker, const PageId first, const PageId last);
+
+        /**
+         * Pass the records of a pinned page to the callback
+         *
+         * @return 		Number of records
+         */
+        std::uint64_t scanPage(const std::uint32_t worker, Page* page);
+
+        /**
+         * Pool the pages are read through
+         */
+        BufMgr& bufMgr;
+
+        /**
+         * Number of worker threads
+         */
+        const std::uint32_t numWorkers;
+
+        /**
+         * Number of pages in a morsel
+         */
+        const std::uint32_t morselPages;
+
+        /**
+         * File of the current scan, set under latch before the workers are woken
+         */
+        File* scanFile;
+
+        /**
+         * Callback of the current scan, set with scanFile
+         */
+        const RecordCallback* scanCallback;
+
+        /**
+         * Number of pages of the file being scanned, set with scanFile
+         */
+        PageId scanPages;
+
+        /**
+         * Number of morsels of the current scan, set with scanFile
+         */
+        std::uint32_t numMorsels;
+
+        /**
+         * Next morsel to take
+         */
+        std::atomic<std::uint32_t> nextMorsel;
+
+        /**
+         * Number of the current scan; a worker that has not seen it yet has work
+         */
+        std::uint64_t generation;
+
+        /**
+         * Number of workers still in the current scan, guarded by latch
+         */
+        std::uint32_t busy;
+
+        /**
+         * Records scanned in the current scan, guarded by latch
+         */
+        std::uint64_t records;
+
+        /**
+         * First exception of the current scan, guarded by latch
+         */
+        std::exception_ptr error;
+
+        /**
+         * Set to ask the workers to stop, guarded by latch
+         */
+        bool stopping;
+
+        /**
+         * Latch protecting the state of the current scan
+         */
+        std::mutex latch;
+
+        /**
+         * Serializes scans
+         */
+        std::mutex scanLatch;
+
+        /**
+         * Signalled when a scan starts or the workers are asked to stop
+         */
+        std::condition_variable wake;
+
+        /**
+         * Signalled when the last worker finishes a scan
+         */
+        std::condition_variable done;
+
+        /**
+         * The worker threads
+         */
+        std::vector<std::thread> workers;
+    };
+
+}
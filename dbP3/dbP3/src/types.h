@@ -24,6 +24,39 @@ typedef std::uint16_t SlotId;
  */
 typedef std::uint32_t FrameId;
 
+/**
+ * @brief Identifier for a database file, dense and stable for the life of the
+ *        process.
+ */
+typedef std::uint32_t FileId;
+
+/**
+ * @brief A page of a file as one word: file identifier in the upper 32 bits,
+ *        page number in the lower 32 bits.
+ */
+typedef std::uint64_t PageKey;
+
+/**
+ * Packs a file identifier and page number into a PageKey.
+ */
+inline PageKey makePageKey(const FileId file_id, const PageId page_number) {
+  return ((PageKey) file_id << 32) | page_number;
+}
+
+/**
+ * Multiplicative hash of a PageKey; spreads consecutive pages and small file
+ * identifiers alike over the upper 32 bits of the product.
+ */
+inline std::uint32_t hashPageKey(const PageKey key) {
+  return (std::uint32_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/**
+ * @brief Log sequence number: the offset in the write-ahead log at which a log
+ *        record starts.  0 means no record.
+ */
+typedef std::uint64_t Lsn;
+
 /**
  * @brief Identifier for a record in a page.
  */